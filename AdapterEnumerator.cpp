@@ -0,0 +1,21 @@
+// adapterenumerator.cpp
+
+#include "AdapterEnumerator.h"
+#include <algorithm>
+
+void finishAdapters(std::vector<AdapterInfo>& adapters, size_t count) {
+    std::sort(adapters.begin(), adapters.begin() + count, [](const AdapterInfo& a, const AdapterInfo& b) {
+        int order = a.name.compare(b.name);
+        return order != 0 ? order < 0 : a.luid < b.luid;
+    });
+    adapters.resize(count);
+}
+
+void assignAdapters(const std::vector<AdapterInfo>& adapters,
+    std::vector<std::pair<std::string, std::string>>& out, bool byDescription) {
+    out.resize(adapters.size());
+    for (size_t i = 0; i < adapters.size(); i++) {
+        out[i].first.assign(byDescription ? adapters[i].description : adapters[i].name);
+        out[i].second.assign(adapters[i].mac);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef ADAPTER_ENUMERATOR_H
+#define ADAPTER_ENUMERATOR_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+// One network interface with a 6-byte hardware address
+struct AdapterInfo {
+    uint64_t luid;           // NET_LUID on Windows, the interface index on Linux
+    uint32_t index;          // interface index
+    std::string name;        // friendly name on Windows, interface name on Linux
+    std::string description; // driver description, Windows only
+    std::string mac;         // formatMac, already normalized
+
+    AdapterInfo() : luid(0), index(0) {}
+};
+
+// Lists the adapters in one OS call per refresh: WinAdapterEnumerator
+// (GetAdaptersAddresses) or NetlinkAdapterEnumerator (RTM_GETLINK dump).
+// Adapters are keyed by LUID, so two with the same name are both kept.
+// Implementations reuse their buffers and the strings already in the output
+// vector, so a steady-state refresh doesn't allocate. Not thread-safe.
+class AdapterEnumerator {
+public:
+    virtual ~AdapterEnumerator() {}
+
+    // Replaces adapters, sorted by name then LUID. Loopback and tunnel
+    // interfaces (no 6-byte address, or an all-zero one) are skipped. On
+    // failure adapters is left empty.
+    virtual bool enumerate(std::vector<AdapterInfo>& adapters) = 0;
+};
+
+// Shared by the implementations, which fill adapters[0, count) in place:
+// drops the rest and orders the result
+void finishAdapters(std::vector<AdapterInfo>& adapters, size_t count);
+
+// Replaces out with SystemSerials::networkAdapters pairs, overwriting the
+// strings already there. Named by description instead of name when
+// byDescription is set (what GetAdaptersInfo used to report).
+void assignAdapters(const std::vector<AdapterInfo>& adapters,
+    std::vector<std::pair<std::string, std::string>>& out, bool byDescription = false);
+
+#endif // ADAPTER_ENUMERATOR_H
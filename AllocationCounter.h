@@ -0,0 +1,44 @@
+#pragma once
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Counts every allocation made through the global operator new. Linking
+// AllocationCounter.cpp replaces operator new/delete for the whole program
+// with malloc/free plus two relaxed atomic increments. Only the benches
+// (collect_bench, serial_bench) link it; it isn't part of the app project,
+// so BanSniffer.exe keeps the runtime's allocator. Allocations the OS or C runtime make on their own (COM
+// strings, opendir, the CRT's locale tables) don't pass through here.
+//
+// Used to hold the collection path to zero allocations per steady-state
+// refresh:
+//
+//   AllocationScope scope;
+//   collector.collect(WatchAll, serials, deadline);
+//   assert(scope.allocations() == 0);
+namespace AllocationCounter {
+    // Process-wide totals since startup, across all threads
+    uint64_t allocations();
+    uint64_t bytes();
+}
+
+// Allocations made (by any thread) since construction
+class AllocationScope {
+public:
+    AllocationScope() : startCount(AllocationCounter::allocations()), startBytes(AllocationCounter::bytes()) {}
+
+    uint64_t allocations() const { return AllocationCounter::allocations() - startCount; }
+    uint64_t bytes() const { return AllocationCounter::bytes() - startBytes; }
+
+    void reset() {
+        startCount = AllocationCounter::allocations();
+        startBytes = AllocationCounter::bytes();
+    }
+
+private:
+    uint64_t startCount;
+    uint64_t startBytes;
+};
+
+#endif // ALLOCATION_COUNTER_H
@@ -0,0 +1,343 @@
+// baselinestore.cpp
+
+#include "BaselineStore.h"
+#include "BinaryIO.h"
+#include <filesystem>
+#include <cstring>
+
+static const char RecordMagic[4] = { 'B', 'R', 'E', 'C' };
+static const char IndexMagic[4] = { 'B', 'I', 'D', 'X' };
+static const uint32_t IndexVersion = 1;
+static const size_t RecordHeaderSize = 12;
+static const size_t IndexHeaderSize = 32;
+static const size_t MinCapacity = 1024;
+
+BaselineStore::BaselineStore() : dataSize(0), flushedSize(0), count(0), indexDirty(false) {
+}
+
+BaselineStore::~BaselineStore() {
+    close();
+}
+
+uint64_t BaselineStore::hashKey(std::string_view key) {
+    // FNV-1a, then a final mix so nearby hostnames spread across the table
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::string BaselineStore::makeRecord(std::string_view machineId, std::string_view snapshot) {
+    std::string record(RecordHeaderSize + machineId.size() + snapshot.size(), '\0');
+    memcpy(&record[0], RecordMagic, 4);
+    putU32(&record[4], (uint32_t)record.size());
+    putU32(&record[8], (uint32_t)machineId.size());
+    memcpy(&record[RecordHeaderSize], machineId.data(), machineId.size());
+    memcpy(&record[RecordHeaderSize + machineId.size()], snapshot.data(), snapshot.size());
+    return record;
+}
+
+bool BaselineStore::open(const std::string& path) {
+    close();
+    dataPath = path + ".data";
+    indexPath = path + ".index";
+
+    std::error_code ec;
+    uint64_t existing = std::filesystem::exists(dataPath, ec) ? std::filesystem::file_size(dataPath, ec) : 0;
+    if (ec) return false;
+
+    // Index first; anything appended after its committed size is replayed
+    dataSize = existing;
+    uint64_t committed = 0;
+    if (loadIndex()) {
+        committed = dataSize;
+    }
+    else {
+        slots.assign(MinCapacity, Slot{ 0, 0 });
+        count = 0;
+    }
+    dataSize = existing;
+    flushedSize = existing;
+
+    if (committed < existing && !replay(committed)) return false;
+
+    dataOut.open(dataPath, std::ios::binary | std::ios::app);
+    return dataOut.is_open();
+}
+
+void BaselineStore::close() {
+    if (dataOut.is_open()) {
+        flush();
+        dataOut.close();
+    }
+    mapped.close();
+    slots.clear();
+    count = 0;
+    dataSize = 0;
+    flushedSize = 0;
+    indexDirty = false;
+}
+
+bool BaselineStore::loadIndex() {
+    MappedFile index;
+    if (!index.open(indexPath)) return false;
+
+    const char* p = index.data();
+    if (index.size() < IndexHeaderSize || memcmp(p, IndexMagic, 4) != 0) return false;
+    if (getU32(p + 4) != IndexVersion) return false;
+
+    uint64_t capacity = getU64(p + 8);
+    uint64_t entries = getU64(p + 16);
+    uint64_t committed = getU64(p + 24);
+
+    // Capacity must be a power of two and the table must be complete
+    if (capacity < MinCapacity || (capacity & (capacity - 1)) != 0) return false;
+    if (index.size() != IndexHeaderSize + capacity * 16) return false;
+    if (committed > dataSize) return false; // data file was truncated behind our back
+
+    slots.resize((size_t)capacity);
+    const char* table = p + IndexHeaderSize;
+    for (size_t i = 0; i < slots.size(); i++) {
+        slots[i].hash = getU64(table + i * 16);
+        slots[i].offset = getU64(table + i * 16 + 8);
+    }
+    count = (size_t)entries;
+    dataSize = committed;
+    return true;
+}
+
+bool BaselineStore::writeIndex() {
+    std::string buffer(IndexHeaderSize + slots.size() * 16, '\0');
+    char* p = &buffer[0];
+    memcpy(p, IndexMagic, 4);
+    putU32(p + 4, IndexVersion);
+    putU64(p + 8, slots.size());
+    putU64(p + 16, count);
+    putU64(p + 24, dataSize);
+    char* table = p + IndexHeaderSize;
+    for (size_t i = 0; i < slots.size(); i++) {
+        putU64(table + i * 16, slots[i].hash);
+        putU64(table + i * 16 + 8, slots[i].offset);
+    }
+
+    // Write beside the old index and swap it in, a crash leaves one or the other
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(buffer.data(), (std::streamsize)buffer.size());
+        if (!out.good()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, indexPath, ec);
+    return !ec;
+}
+
+bool BaselineStore::replay(uint64_t from) {
+    mapped.close();
+    if (!mapped.open(dataPath)) return false;
+
+    uint64_t pos = from;
+    uint64_t end = mapped.size();
+    const char* base = mapped.data();
+    while (pos + RecordHeaderSize <= end) {
+        const char* rec = base + pos;
+        uint32_t size = getU32(rec + 4);
+        uint32_t keyLen = getU32(rec + 8);
+        if (memcmp(rec, RecordMagic, 4) != 0 || size < RecordHeaderSize + keyLen || pos + size > end)
+            break;
+
+        std::string_view key(rec + RecordHeaderSize, keyLen);
+        reserve(count + 1);
+        insert(hashKey(key), pos, key);
+        pos += size;
+    }
+
+    // Drop a torn tail so the next append starts on a record boundary
+    if (pos < end) {
+        mapped.close();
+        std::error_code ec;
+        std::filesystem::resize_file(dataPath, pos, ec);
+        if (ec) return false;
+    }
+
+    dataSize = pos;
+    flushedSize = pos;
+    indexDirty = true;
+    return true;
+}
+
+void BaselineStore::reserve(size_t entries) {
+    // Keep load factor under 0.7 so probe sequences stay short
+    size_t capacity = slots.size();
+    while (entries * 10 > capacity * 7) capacity *= 2;
+    if (capacity == slots.size()) return;
+
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.assign(capacity, Slot{ 0, 0 });
+    size_t mask = capacity - 1;
+    for (const auto& slot : old) {
+        if (!slot.offset) continue;
+        size_t i = (size_t)slot.hash & mask;
+        while (slots[i].offset) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+void BaselineStore::insert(uint64_t hash, uint64_t offset, std::string_view machineId) {
+    size_t mask = slots.size() - 1;
+    size_t i = (size_t)hash & mask;
+    while (slots[i].offset) {
+        if (slots[i].hash == hash) {
+            std::string_view key;
+            if (recordKey(slots[i].offset - 1, key, nullptr) && key == machineId) {
+                slots[i].offset = offset + 1; // newer record wins
+                indexDirty = true;
+                return;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+    slots[i].hash = hash;
+    slots[i].offset = offset + 1;
+    count++;
+    indexDirty = true;
+}
+
+bool BaselineStore::ensureMapped(uint64_t end) {
+    if (mapped.isOpen() && end <= mapped.size()) return true;
+    if (end > dataSize) return false;
+    if (flushedSize < end) {
+        dataOut.flush();
+        flushedSize = dataSize;
+    }
+    mapped.close();
+    return mapped.open(dataPath) && end <= mapped.size();
+}
+
+bool BaselineStore::recordKey(uint64_t offset, std::string_view& key, SnapshotView* snapshot) {
+    if (!ensureMapped(offset + RecordHeaderSize)) return false;
+    const char* rec = mapped.data() + offset;
+    uint32_t size = getU32(rec + 4);
+    uint32_t keyLen = getU32(rec + 8);
+    if (memcmp(rec, RecordMagic, 4) != 0 || size < RecordHeaderSize + keyLen) return false;
+    if (!ensureMapped(offset + size)) return false;
+
+    rec = mapped.data() + offset; // may have been remapped
+    key = std::string_view(rec + RecordHeaderSize, keyLen);
+    if (snapshot) {
+        size_t headerAndKey = RecordHeaderSize + keyLen;
+        return snapshot->attach(rec + headerAndKey, size - headerAndKey);
+    }
+    return true;
+}
+
+bool BaselineStore::upsert(std::string_view machineId, const SystemSerials& serials) {
+    return upsertEncoded(machineId, SerialSnapshot::encode(serials));
+}
+
+bool BaselineStore::upsertEncoded(std::string_view machineId, std::string_view snapshot) {
+    if (!dataOut.is_open()) return false;
+
+    std::string record = makeRecord(machineId, snapshot);
+    dataOut.write(record.data(), (std::streamsize)record.size());
+    if (!dataOut.good()) return false;
+
+    uint64_t offset = dataSize;
+    dataSize += record.size();
+    reserve(count + 1);
+    insert(hashKey(machineId), offset, machineId);
+    return true;
+}
+
+size_t BaselineStore::bulkLoad(const std::vector<std::pair<std::string, SystemSerials>>& entries) {
+    if (!dataOut.is_open()) return 0;
+
+    // Records go out in large chunks rather than one write per machine
+    const size_t chunkSize = 4 << 20;
+    std::string buffer;
+    std::vector<uint64_t> offsets;
+    offsets.reserve(entries.size());
+    for (const auto& entry : entries) {
+        offsets.push_back(dataSize);
+        std::string record = makeRecord(entry.first, SerialSnapshot::encode(entry.second));
+        dataSize += record.size();
+        buffer += record;
+        if (buffer.size() >= chunkSize) {
+            dataOut.write(buffer.data(), (std::streamsize)buffer.size());
+            buffer.clear();
+        }
+    }
+    dataOut.write(buffer.data(), (std::streamsize)buffer.size());
+    if (!dataOut.good()) return 0;
+
+    reserve(count + entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+        insert(hashKey(entries[i].first), offsets[i], entries[i].first);
+    return entries.size();
+}
+
+bool BaselineStore::lookup(std::string_view machineId, SnapshotView& baseline) {
+    if (slots.empty()) return false;
+
+    uint64_t hash = hashKey(machineId);
+    size_t mask = slots.size() - 1;
+    for (size_t i = (size_t)hash & mask; slots[i].offset; i = (i + 1) & mask) {
+        if (slots[i].hash != hash) continue;
+        std::string_view key;
+        if (recordKey(slots[i].offset - 1, key, &baseline) && key == machineId)
+            return true;
+    }
+    return false;
+}
+
+size_t BaselineStore::forEach(const std::function<void(std::string_view machineId, const SnapshotView& snapshot)>& visit) {
+    size_t visited = 0;
+    for (const Slot& slot : slots) {
+        if (!slot.offset) continue;
+        std::string_view key;
+        SnapshotView snapshot;
+        if (!recordKey(slot.offset - 1, key, &snapshot)) continue;
+        visit(key, snapshot);
+        visited++;
+    }
+    return visited;
+}
+
+bool BaselineStore::compare(std::string_view machineId, const SnapshotView& current, SnapshotChanges& changes) {
+    SnapshotView baseline;
+    if (!lookup(machineId, baseline)) return false;
+    changes = compareSnapshots(current, baseline);
+    return true;
+}
+
+bool BaselineStore::compare(std::string_view machineId, const SystemSerials& current, SnapshotChanges& changes) {
+    std::string encoded = SerialSnapshot::encode(current);
+    SnapshotView view;
+    view.attach(encoded.data(), encoded.size());
+    return compare(machineId, view, changes);
+}
+
+bool BaselineStore::flush() {
+    if (!dataOut.is_open()) return false;
+    dataOut.flush();
+    if (!dataOut.good()) return false;
+    flushedSize = dataSize;
+    if (!indexDirty) return true;
+    indexDirty = !writeIndex();
+    return !indexDirty;
+}
+
+bool BaselineStore::flushRecords() {
+    if (!dataOut.is_open()) return false;
+    dataOut.flush();
+    if (!dataOut.good()) return false;
+    flushedSize = dataSize;
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef BASELINE_STORE_H
+#define BASELINE_STORE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+#include "system_serials.hpp"
+#include "SerialSnapshot.h"
+#include "MappedFile.h"
+
+// On-disk baselines for a whole fleet, keyed by machine identity.
+//
+//   <path>.data   append-only records: u32 magic "BREC", u32 record size,
+//                 u32 key length, key bytes, then an encoded SerialSnapshot
+//   <path>.index  open-addressing hash table of (key hash, record offset),
+//                 loaded into memory on open and rewritten on flush()
+//
+// An upsert appends a new record and repoints the slot, so lookups stay one
+// probe sequence regardless of fleet size or history. Records past the
+// index's committed size (e.g. after a crash) are replayed on open.
+class BaselineStore {
+public:
+    BaselineStore();
+    ~BaselineStore();
+
+    BaselineStore(const BaselineStore&) = delete;
+    BaselineStore& operator=(const BaselineStore&) = delete;
+
+    // Creates the files if they don't exist
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return dataOut.is_open(); }
+
+    bool upsert(std::string_view machineId, const SystemSerials& serials);
+    bool upsertEncoded(std::string_view machineId, std::string_view snapshot);
+
+    // Appends every entry with one write and grows the index once
+    size_t bulkLoad(const std::vector<std::pair<std::string, SystemSerials>>& entries);
+
+    // The view points into the mapped data file and stays valid until the
+    // next lookup that has to remap after new appends
+    bool lookup(std::string_view machineId, SnapshotView& baseline);
+
+    // Every machine's latest record, in no particular order. Views are only
+    // valid during the call. Returns the number visited.
+    size_t forEach(const std::function<void(std::string_view machineId, const SnapshotView& snapshot)>& visit);
+
+    // compareSerials against the stored record without decoding it
+    bool compare(std::string_view machineId, const SystemSerials& current, SnapshotChanges& changes);
+    bool compare(std::string_view machineId, const SnapshotView& current, SnapshotChanges& changes);
+
+    // Persists appended records and the index
+    bool flush();
+
+    // Hands appended records to the OS without rewriting the index, for
+    // callers that commit often; records past the index are replayed on open
+    bool flushRecords();
+
+    size_t size() const { return count; }
+
+private:
+    struct Slot {
+        uint64_t hash;
+        uint64_t offset; // record offset + 1, 0 = empty
+    };
+
+    std::string dataPath;
+    std::string indexPath;
+    std::ofstream dataOut;
+    uint64_t dataSize;     // bytes appended so far
+    uint64_t flushedSize;  // bytes known to be on disk
+    MappedFile mapped;
+    std::vector<Slot> slots;
+    size_t count;
+    bool indexDirty;
+
+    static uint64_t hashKey(std::string_view key);
+    static std::string makeRecord(std::string_view machineId, std::string_view snapshot);
+
+    bool loadIndex();
+    bool replay(uint64_t from);
+    bool writeIndex();
+    void reserve(size_t entries);
+    void insert(uint64_t hash, uint64_t offset, std::string_view machineId);
+    bool recordKey(uint64_t offset, std::string_view& key, SnapshotView* snapshot);
+    bool ensureMapped(uint64_t end);
+};
+
+#endif // BASELINE_STORE_H
@@ -0,0 +1,524 @@
+// batchmode.cpp
+
+#include "BatchMode.h"
+#include "NdjsonWriter.h"
+#include "SerialSnapshot.h"
+#include "SerialDiff.h"
+#include "SnapshotJournal.h"
+#include "IngestProtocol.h"
+#include "IngestServer.h"
+#include "BulkCompare.h"
+#include "SerialIndex.h"
+#include "SmbiosReader.h"
+#include "Trace.h"
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#include <climits>
+#endif
+
+static const char* DefaultSerialsFile = "system_serials.dat";
+static const char* DefaultJournalFile = "system_serials.journal";
+static const char* DefaultIngestAddress = "127.0.0.1:7870";
+static const char* DefaultStorePath = "fleet";
+static const size_t SharedNameLimit = 1000; // machine names per "shared" record
+
+static void printUsage(FILE* out) {
+    fputs("usage: BanSniffer <collect|save|compare|history> [--file <path>] [--journal <path>]\n"
+        "                  [--timeout <ms>] [--trace <path>]\n"
+        "       BanSniffer serve [--listen <addr>] [--store <path>] [--threads <n>]\n"
+        "       BanSniffer push [--to <addr>] [--machine <id>] [--timeout <ms>]\n"
+        "       BanSniffer bulk --dir <path> --baselines <path> [--threads <n>]\n"
+        "       BanSniffer shared [--store <path>] [--min <n>] [--component <name> --value <v>]\n"
+        "       BanSniffer smbios [--table <path>] [--dump <path>]\n"
+        "  collect   print the current serials as one NDJSON record\n"
+        "  save      collect and store them as the baseline\n"
+        "  compare   diff against the baseline; exit 0 unchanged, 1 changed, 2 error\n"
+        "  history   print one record per journaled change (default system_serials.journal)\n"
+        "  serve     accept pushed snapshots, store them and print a diff per changed machine\n"
+        "  push      collect and send to a server; exit 0 unchanged, 1 changed or new, 2 error\n"
+        "  bulk      diff every snapshot under --dir against the same path under --baselines\n"
+        "  shared    list values reported by several machines in a store; exit 1 if any\n"
+        "  smbios    print the decoded firmware table (BIOS, system, board, chassis, memory)\n"
+        "  --file    baseline path (default system_serials.dat)\n"
+        "  --journal also append the collection to this history journal\n"
+        "  --timeout give up on slow sources after <ms> (default 30000, 0 = wait)\n"
+        "  --trace   write a Chrome trace of every query and IOCTL to <path>\n"
+        "  --listen, --to  host:port or unix:/path (default 127.0.0.1:7870)\n"
+        "  --store   fleet baseline store path (default fleet)\n"
+        "  --threads serve/bulk worker threads (default one per core)\n"
+        "  --min     shared: machines a value needs to be listed (default 2)\n"
+        "  --component, --value  shared: look up one value (cpu, motherboard, bios, disk, adapter)\n"
+        "  --machine id the server files the snapshot under (default the host name)\n"
+        "  --table   smbios: decode a saved raw table instead of this machine's\n"
+        "  --dump    smbios: also write the raw table to <path> for use with --table\n", out);
+}
+
+static std::string hostName() {
+#ifdef _WIN32
+    char name[MAX_COMPUTERNAME_LENGTH + 1];
+    DWORD size = sizeof(name);
+    if (GetComputerNameA(name, &size)) return std::string(name, size);
+#else
+    char name[HOST_NAME_MAX + 1] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0) return name;
+#endif
+    return std::string();
+}
+
+static void writeSerials(NdjsonWriter& out, const SystemSerials& serials) {
+    out.field("timestamp", serials.timestamp);
+    out.field("cpuId", serials.cpuId);
+    out.field("motherboardSerial", serials.motherboardSerial);
+    out.field("biosSerial", serials.biosSerial);
+    out.key("disks");
+    out.beginArray();
+    for (const auto& disk : serials.diskSerials) out.value(disk);
+    out.endArray();
+    out.key("adapters");
+    out.beginArray();
+    for (const auto& adapter : serials.networkAdapters) {
+        out.beginObject();
+        out.field("name", adapter.first);
+        out.field("mac", adapter.second);
+        out.endObject();
+    }
+    out.endArray();
+}
+
+static int writeError(NdjsonWriter& out, const std::string& host, const char* verb, const std::string& message) {
+    out.beginRecord();
+    out.field("type", "error");
+    out.field("host", host);
+    out.field("verb", verb);
+    out.field("message", message);
+    out.endRecord();
+    return BatchError;
+}
+
+static void writeComponents(NdjsonWriter& out, const char* key, unsigned components) {
+    static const SerialComponent all[] = { SerialComponent::CpuId, SerialComponent::MotherboardSerial,
+        SerialComponent::BiosSerial, SerialComponent::Disk, SerialComponent::NetworkAdapter };
+    out.key(key);
+    out.beginArray();
+    for (SerialComponent component : all) {
+        if (components & componentBit(component)) out.value(componentName(component));
+    }
+    out.endArray();
+}
+
+static int writeHistory(NdjsonWriter& out, const std::string& host, const std::string& path) {
+    bool ok = SnapshotJournal::replay(path, [&](const JournalEntry& entry) {
+        out.beginRecord();
+        out.field("type", "history");
+        out.field("host", host);
+        out.field("checkpoint", entry.checkpoint);
+        writeComponents(out, "changed", entry.changed);
+        writeSerials(out, entry.serials);
+        out.endRecord();
+    });
+    if (!ok) return writeError(out, host, "history", "no readable journal at " + path);
+    return out.flush() ? BatchUnchanged : BatchError;
+}
+
+static int serve(NdjsonWriter& out, const std::string& host, const std::string& address,
+    const std::string& storePath, unsigned threads) {
+    IngestOptions options;
+    options.listen = address;
+    options.storePath = storePath;
+    options.workers = threads;
+
+    IngestServer server;
+    std::string error;
+    if (!server.start(options, error)) return writeError(out, host, "serve", error);
+    fprintf(stderr, "serving on %s, store %s\n", address.c_str(), storePath.c_str());
+
+    // Runs until killed; records are flushed per batch and replayed into
+    // the index on the next open
+    server.wait();
+    return BatchUnchanged;
+}
+
+static int push(NdjsonWriter& out, const std::string& host, const std::string& address,
+    const std::string& machineId, const SystemSerials& current) {
+    if (current.incomplete)
+        return writeError(out, host, "push", "collection timed out, snapshot not sent");
+
+    std::string frame;
+    if (!IngestProtocol::appendFrame(frame, machineId, SerialSnapshot::encode(current)))
+        return writeError(out, host, "push", "machine id empty or too long, or snapshot too large");
+
+    std::string error;
+    if (!IngestSocket::startup()) return writeError(out, host, "push", "socket startup failed");
+    IngestSocket::Handle socket = IngestSocket::connectTo(address, error);
+    if (socket == IngestSocket::Invalid) return writeError(out, host, "push", error);
+
+    char status = 0;
+    bool acked = IngestSocket::sendAll(socket, frame.data(), frame.size()) &&
+        IngestSocket::receive(socket, &status, 1) == 1;
+    IngestSocket::close(socket);
+    if (!acked) return writeError(out, host, "push", "no reply from " + address);
+
+    IngestStatus result = (IngestStatus)status;
+    out.beginRecord();
+    out.field("type", "push");
+    out.field("host", host);
+    out.field("machine", machineId);
+    out.field("server", address);
+    out.field("status", ingestStatusName(result));
+    out.endRecord();
+    if (!out.flush()) return BatchError;
+    if (result == IngestUnchanged) return BatchUnchanged;
+    if (result == IngestChanged || result == IngestNew) return BatchChanged;
+    return BatchError;
+}
+
+static int bulk(NdjsonWriter& out, const std::string& host, const std::string& dir,
+    const std::string& baselineDir, unsigned threads) {
+    if (dir.empty() || baselineDir.empty())
+        return writeError(out, host, "bulk", "bulk needs --dir and --baselines");
+
+    BulkCompareOptions options;
+    options.currentDir = dir;
+    options.baselineDir = baselineDir;
+    options.threads = threads;
+    BulkCompareStats stats = bulkCompare(options);
+
+    out.beginRecord();
+    out.field("type", "summary");
+    out.field("host", host);
+    out.field("files", (long long)stats.files);
+    out.field("changed", (long long)stats.changed);
+    out.field("unchanged", (long long)stats.unchanged);
+    out.field("errors", (long long)stats.errors);
+    out.field("threads", (long long)stats.threads);
+    out.field("milliseconds", (long long)(stats.seconds * 1000.0));
+    out.endRecord();
+    if (!out.flush()) return BatchError;
+    if (stats.changed) return BatchChanged;
+    return stats.errors ? BatchError : BatchUnchanged;
+}
+
+static bool parseComponent(const std::string& name, SerialComponent& component) {
+    static const SerialComponent all[] = { SerialComponent::CpuId, SerialComponent::MotherboardSerial,
+        SerialComponent::BiosSerial, SerialComponent::Disk, SerialComponent::NetworkAdapter };
+    for (SerialComponent candidate : all) {
+        if (name == componentName(candidate)) {
+            component = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void writeShared(NdjsonWriter& out, const std::string& host, const SerialIndex& index,
+    SerialComponent component, std::string_view value, std::vector<SerialIndex::MachineId>& machines) {
+    out.beginRecord();
+    out.field("type", "shared");
+    out.field("host", host);
+    out.field("component", componentName(component));
+    out.field("value", value);
+    out.field("machines", (long long)machines.size());
+    out.key("names");
+    out.beginArray();
+    for (size_t i = 0; i < machines.size() && i < SharedNameLimit; i++) out.value(index.machineName(machines[i]));
+    out.endArray();
+    out.endRecord();
+}
+
+static int shared(NdjsonWriter& out, const std::string& host, const std::string& storePath, unsigned minMachines,
+    const std::string& componentArg, const std::string& value) {
+    SerialComponent component = SerialComponent::Disk;
+    if (!componentArg.empty() && !parseComponent(componentArg, component))
+        return writeError(out, host, "shared", "unknown component " + componentArg);
+    if (componentArg.empty() != value.empty())
+        return writeError(out, host, "shared", "--component and --value go together");
+    // Opening creates a store; a query shouldn't
+    if (!std::ifstream(storePath + ".data").good())
+        return writeError(out, host, "shared", "no store at " + storePath);
+
+    BaselineStore store;
+    if (!store.open(storePath)) return writeError(out, host, "shared", "cannot open store " + storePath);
+    SerialIndex index;
+    store.forEach([&](std::string_view machineId, const SnapshotView& snapshot) {
+        index.update(machineId, snapshot);
+    });
+
+    std::vector<SerialIndex::MachineId> machines;
+    size_t found = 0;
+    if (!value.empty()) {
+        if (index.machinesWith(component, value, machines) >= minMachines) found++;
+        writeShared(out, host, index, component, value, machines);
+    }
+    else {
+        index.forEachShared(minMachines, [&](SerialComponent c, std::string_view v, size_t) {
+            index.machinesWith(c, v, machines);
+            writeShared(out, host, index, c, v, machines);
+            found++;
+        });
+    }
+    if (!out.flush()) return BatchError;
+    return found ? BatchChanged : BatchUnchanged;
+}
+
+static int smbios(NdjsonWriter& out, const std::string& host, const std::string& tablePath,
+    const std::string& dumpPath) {
+    std::unique_ptr<SmbiosReader> reader;
+    if (tablePath.empty()) {
+        reader = createSmbiosReader();
+    }
+    else {
+        std::unique_ptr<FixtureSmbiosReader> fixture(new FixtureSmbiosReader());
+        if (!fixture->loadFile(tablePath)) return writeError(out, host, "smbios", "cannot read " + tablePath);
+        reader = std::move(fixture);
+    }
+
+    std::vector<unsigned char> raw;
+    SmbiosInfo info;
+    if (!reader->fetch(raw)) return writeError(out, host, "smbios", "no SMBIOS table available");
+    if (!parseRawSmbiosData(raw.data(), raw.size(), info))
+        return writeError(out, host, "smbios", "malformed SMBIOS table");
+    if (!dumpPath.empty()) {
+        std::ofstream dump(dumpPath, std::ios::binary | std::ios::trunc);
+        if (!dump.write((const char*)raw.data(), (std::streamsize)raw.size()))
+            return writeError(out, host, "smbios", "cannot write " + dumpPath);
+    }
+
+    out.beginRecord();
+    out.field("type", "smbios");
+    out.field("host", host);
+    out.field("version", std::to_string(info.majorVersion) + "." + std::to_string(info.minorVersion));
+    out.key("bios");
+    out.beginObject();
+    out.field("vendor", info.biosVendor);
+    out.field("version", info.biosVersion);
+    out.field("releaseDate", info.biosReleaseDate);
+    out.endObject();
+    out.key("system");
+    out.beginObject();
+    out.field("manufacturer", info.systemManufacturer);
+    out.field("product", info.systemProduct);
+    out.field("serial", info.systemSerial);
+    out.field("uuid", info.systemUuid);
+    out.endObject();
+    out.key("board");
+    out.beginObject();
+    out.field("manufacturer", info.boardManufacturer);
+    out.field("product", info.boardProduct);
+    out.field("serial", info.boardSerial);
+    out.endObject();
+    out.key("chassis");
+    out.beginObject();
+    out.field("manufacturer", info.chassisManufacturer);
+    out.field("type", (long long)info.chassisType);
+    out.field("serial", info.chassisSerial);
+    out.field("assetTag", info.chassisAssetTag);
+    out.endObject();
+    out.key("memory");
+    out.beginArray();
+    for (const auto& module : info.memoryModules) {
+        out.beginObject();
+        out.field("locator", module.locator);
+        out.field("bank", module.bankLocator);
+        out.field("manufacturer", module.manufacturer);
+        out.field("serial", module.serial);
+        out.field("partNumber", module.partNumber);
+        out.field("sizeMb", (long long)module.sizeMb);
+        out.field("speedMts", (long long)module.speedMts);
+        out.endObject();
+    }
+    out.endArray();
+    out.endRecord();
+    return out.flush() ? BatchUnchanged : BatchError;
+}
+
+static bool parseUnsigned(const char* text, unsigned& result) {
+    if (!*text) return false;
+    unsigned long long value = 0;
+    for (const char* c = text; *c; c++) {
+        if (*c < '0' || *c > '9') return false;
+        value = value * 10 + (unsigned)(*c - '0');
+        if (value > 0xFFFFFFFFull) return false;
+    }
+    result = (unsigned)value;
+    return true;
+}
+
+bool isBatchInvocation(int argc, char** argv) {
+    return argc > 1 && argv[1] && argv[1][0] != '\0';
+}
+
+int runBatch(int argc, char** argv, const std::function<SystemSerials(unsigned timeoutMs)>& collect) {
+    if (argc < 2) {
+        printUsage(stderr);
+        return BatchUsage;
+    }
+
+    std::string verb = argv[1];
+    std::string file = DefaultSerialsFile;
+    std::string tracePath;
+    std::string journalPath;
+    unsigned timeoutMs = DefaultBatchTimeoutMs;
+    std::string address = DefaultIngestAddress;
+    std::string storePath = DefaultStorePath;
+    std::string machineId;
+    std::string bulkDir;
+    std::string baselineDir;
+    unsigned threads = 0;
+    unsigned minMachines = 2;
+    std::string component;
+    std::string value;
+    std::string tablePath;
+    std::string dumpPath;
+    for (int i = 2; i < argc; i++) {
+        if ((strcmp(argv[i], "--file") == 0 || strcmp(argv[i], "-f") == 0) && i + 1 < argc) {
+            file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            journalPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc && parseUnsigned(argv[i + 1], timeoutMs)) {
+            i++;
+        }
+        else if ((strcmp(argv[i], "--listen") == 0 || strcmp(argv[i], "--to") == 0) && i + 1 < argc) {
+            address = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            bulkDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baselines") == 0 && i + 1 < argc) {
+            baselineDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            storePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--machine") == 0 && i + 1 < argc && argv[i + 1][0] != '\0') {
+            machineId = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && parseUnsigned(argv[i + 1], threads)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "--min") == 0 && i + 1 < argc && parseUnsigned(argv[i + 1], minMachines)) {
+            i++;
+        }
+        else if (strcmp(argv[i], "--component") == 0 && i + 1 < argc) {
+            component = argv[++i];
+        }
+        else if (strcmp(argv[i], "--value") == 0 && i + 1 < argc) {
+            value = argv[++i];
+        }
+        else if (strcmp(argv[i], "--table") == 0 && i + 1 < argc) {
+            tablePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpPath = argv[++i];
+        }
+        else {
+            printUsage(stderr);
+            return BatchUsage;
+        }
+    }
+    if (verb == "help" || verb == "--help" || verb == "-h") {
+        printUsage(stdout);
+        return BatchUnchanged;
+    }
+    if (verb != "collect" && verb != "save" && verb != "compare" && verb != "history" &&
+        verb != "serve" && verb != "push" && verb != "bulk" && verb != "shared" && verb != "smbios") {
+        printUsage(stderr);
+        return BatchUsage;
+    }
+
+#ifdef _WIN32
+    // Records end in \n, not \r\n
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    NdjsonWriter out(stdout);
+    std::string host = hostName();
+    if (verb == "history")
+        return writeHistory(out, host, journalPath.empty() ? DefaultJournalFile : journalPath);
+    if (verb == "serve")
+        return serve(out, host, address, storePath, threads);
+    if (verb == "bulk")
+        return bulk(out, host, bulkDir, baselineDir, threads);
+    if (verb == "shared")
+        return shared(out, host, storePath, minMachines, component, value);
+    if (verb == "smbios")
+        return smbios(out, host, tablePath, dumpPath);
+
+    // Read the baseline before collecting so a missing file fails fast
+    SystemSerials saved;
+    if (verb == "compare" && !loadSerialsFile(file, saved))
+        return writeError(out, host, "compare", "no readable baseline at " + file);
+
+    if (!tracePath.empty()) Trace::enable();
+    SystemSerials current = collect(timeoutMs);
+    if (!tracePath.empty() && !Trace::writeChromeJson(tracePath))
+        fprintf(stderr, "failed to write trace to %s\n", tracePath.c_str());
+
+    // History is best effort: a journal problem never changes the exit code
+    if (!journalPath.empty() && !current.incomplete) {
+        SnapshotJournal journal;
+        if (!journal.open(journalPath) || journal.append(current) == SnapshotJournal::AppendResult::Failed)
+            fprintf(stderr, "failed to append to journal %s\n", journalPath.c_str());
+    }
+
+    if (verb == "compare") {
+        SerialDiff diff = diffSerials(current, saved);
+        bool changed = diff.hasChanges();
+
+        out.beginRecord();
+        out.field("type", "diff");
+        out.field("host", host);
+        out.field("timestamp", current.timestamp);
+        out.field("baselineTimestamp", saved.timestamp);
+        out.field("changed", changed);
+        writeComponents(out, "incomplete", current.incomplete);
+        out.key("changes");
+        out.beginArray();
+        for (const auto& change : diff.changes) {
+            if (change.kind == ChangeKind::Unchanged || change.kind == ChangeKind::Stale) continue;
+            out.beginObject();
+            out.field("component", componentName(change.component));
+            out.field("kind", changeKindName(change.kind));
+            out.field("label", change.label);
+            out.field("old", change.oldValue);
+            out.field("new", change.newValue);
+            out.endObject();
+        }
+        out.endArray();
+        out.endRecord();
+        if (!out.flush()) return BatchError;
+        // A real change is reported even if other components timed out
+        if (changed) return BatchChanged;
+        return current.incomplete ? BatchError : BatchUnchanged;
+    }
+
+    if (verb == "push")
+        return push(out, host, address, machineId.empty() ? host : machineId, current);
+
+    if (verb == "save" && current.incomplete)
+        return writeError(out, host, "save", "collection timed out, baseline not written");
+    if (verb == "save" && !SerialSnapshot::writeFile(current, file))
+        return writeError(out, host, "save", "failed to write " + file);
+
+    out.beginRecord();
+    out.field("type", "snapshot");
+    out.field("host", host);
+    writeSerials(out, current);
+    writeComponents(out, "incomplete", current.incomplete);
+    if (verb == "save") out.field("savedTo", file);
+    out.endRecord();
+    return out.flush() ? BatchUnchanged : BatchError;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef BATCH_MODE_H
+#define BATCH_MODE_H
+
+#include <functional>
+#include "system_serials.hpp"
+
+// Non-interactive entry point for schedulers:
+//
+//   BanSniffer collect [--file <path>]   print the current snapshot
+//   BanSniffer save    [--file <path>]   collect and store as the baseline
+//   BanSniffer compare [--file <path>]   diff against the stored baseline
+//   BanSniffer history [--journal <path>] print every journaled change
+//   BanSniffer serve [--listen <addr>] [--store <path>] [--threads <n>]
+//                                        ingest pushed snapshots (IngestServer)
+//   BanSniffer push [--to <addr>] [--machine <id>]
+//                                        collect and send to a serve instance
+//   BanSniffer bulk --dir <path> --baselines <path> [--threads <n>]
+//                                        diff a tree of snapshots (BulkCompare)
+//   BanSniffer shared [--store <path>] [--min <n>] [--component <c> --value <v>]
+//                                        values several machines report (SerialIndex)
+//   BanSniffer smbios [--table <path>] [--dump <path>]
+//                                        decode the firmware table (SmbiosReader)
+//
+// --journal <path> on collect/save/compare also appends the collection to
+// a SnapshotJournal (only if something changed since its last record).
+//
+// Output is NDJSON on stdout (one record per snapshot or diff), nothing
+// touches the console API and nothing waits on input. --timeout bounds the
+// collection; components that miss it are listed as "incomplete", never
+// saved, and a compare that is otherwise unchanged exits BatchError.
+enum BatchExitCode {
+    BatchUnchanged = 0, // also success for collect/save
+    BatchChanged = 1,
+    BatchError = 2,
+    BatchUsage = 3
+};
+
+// True when the command line asks for batch mode rather than the menu
+bool isBatchInvocation(int argc, char** argv);
+
+// collect supplies the serials within timeoutMs (0 = no limit), normally
+// the native getSystemSerials(Deadline) on every platform
+static const unsigned DefaultBatchTimeoutMs = 30000;
+int runBatch(int argc, char** argv, const std::function<SystemSerials(unsigned timeoutMs)>& collect);
+
+#endif // BATCH_MODE_H
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Little-endian field helpers shared by the on-disk formats. Byte-wise so
+// they work on unaligned pointers into mapped files.
+
+inline void putU16(char* p, uint16_t v) {
+    p[0] = (char)(v & 0xFF);
+    p[1] = (char)(v >> 8);
+}
+
+inline void putU32(char* p, uint32_t v) {
+    p[0] = (char)(v & 0xFF);
+    p[1] = (char)((v >> 8) & 0xFF);
+    p[2] = (char)((v >> 16) & 0xFF);
+    p[3] = (char)(v >> 24);
+}
+
+inline void putU64(char* p, uint64_t v) {
+    putU32(p, (uint32_t)v);
+    putU32(p + 4, (uint32_t)(v >> 32));
+}
+
+inline uint16_t getU16(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return (uint16_t)(u[0] | (u[1] << 8));
+}
+
+inline uint32_t getU32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t)u[0] | ((uint32_t)u[1] << 8) | ((uint32_t)u[2] << 16) | ((uint32_t)u[3] << 24);
+}
+
+inline uint64_t getU64(const char* p) {
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+}
+
+// LEB128 varints: 7 bits per byte, high bit set on all but the last
+inline void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+// Advances pos; false on truncation or more than 64 bits
+inline bool getVarint(const char* data, size_t size, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && pos < size; shift += 7) {
+        unsigned char b = (unsigned char)data[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Varint length + bytes
+inline void putBytes(std::string& out, std::string_view value) {
+    putVarint(out, value.size());
+    out.append(value.data(), value.size());
+}
+
+inline bool getBytes(const char* data, size_t size, size_t& pos, std::string_view& value) {
+    uint64_t len;
+    if (!getVarint(data, size, pos, len) || len > size - pos) return false;
+    value = std::string_view(data + pos, (size_t)len);
+    pos += (size_t)len;
+    return true;
+}
+
+#endif // BINARY_IO_H
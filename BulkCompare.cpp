@@ -0,0 +1,181 @@
+// bulkcompare.cpp
+
+#include "BulkCompare.h"
+#include "WorkStealingPool.h"
+#include "NdjsonWriter.h"
+#include "SerialSnapshot.h"
+#include "SerialDiff.h"
+#include "SerialNormalize.h"
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Padded so workers bumping their counters don't share cache lines
+struct alignas(64) WorkerState {
+    std::unique_ptr<NdjsonWriter> out;
+    uint64_t files = 0;
+    uint64_t changed = 0;
+    uint64_t unchanged = 0;
+    uint64_t errors = 0;
+    SystemSerials current; // decode scratch, reused across files
+    SystemSerials saved;
+};
+
+class BulkRun {
+public:
+    BulkRun(const BulkCompareOptions& options, WorkStealingPool& pool)
+        : options(options), pool(pool), currentRoot(options.currentDir), baselineRoot(options.baselineDir),
+        states(pool.threadCount()) {
+        for (auto& state : states) state.out.reset(new NdjsonWriter(options.out));
+    }
+
+    void walk(size_t worker, const fs::path& dir) {
+        std::error_code ec;
+        fs::directory_iterator it(dir, ec);
+        for (fs::directory_iterator end; !ec && it != end; it.increment(ec)) {
+            fs::path path = it->path();
+            std::error_code typeEc;
+            if (it->is_symlink(typeEc) && it->is_directory(typeEc)) continue; // could loop
+            if (it->is_directory(typeEc)) {
+                pool.submit([this, path](size_t w) { walk(w, path); });
+            }
+            else if (it->is_regular_file(typeEc)) {
+                pool.submit([this, path](size_t w) { compareFile(w, path); });
+            }
+        }
+        if (ec) error(states[worker], relativeName(dir), "cannot read directory: " + ec.message());
+    }
+
+    void finish(BulkCompareStats& stats) {
+        for (auto& state : states) {
+            state.out->flush();
+            stats.files += state.files;
+            stats.changed += state.changed;
+            stats.unchanged += state.unchanged;
+            stats.errors += state.errors;
+        }
+    }
+
+private:
+    const BulkCompareOptions& options;
+    WorkStealingPool& pool;
+    fs::path currentRoot;
+    fs::path baselineRoot;
+    std::vector<WorkerState> states;
+
+    std::string relativeName(const fs::path& path) const {
+        return path.lexically_relative(currentRoot).generic_u8string();
+    }
+
+    void error(WorkerState& state, const std::string& file, const std::string& message) {
+        state.errors++;
+        if (!options.out) return;
+        state.out->beginRecord();
+        state.out->field("type", "error");
+        state.out->field("file", file);
+        state.out->field("message", message);
+        state.out->endRecord();
+    }
+
+    void compareFile(size_t worker, const fs::path& path) {
+        WorkerState& state = states[worker];
+        state.files++;
+        std::string relative = relativeName(path);
+
+        // A corrupt file can make a decode throw (bad_alloc on a bogus
+        // count, a filesystem error); it becomes an error record rather
+        // than a file missing from the output
+        SerialDiff diff;
+        try {
+            if (!diffFile(state, path, relative, diff)) return;
+        }
+        catch (const std::exception& e) {
+            return error(state, relative, std::string("compare failed: ") + e.what());
+        }
+
+        bool changed = diff.hasChanges();
+        if (changed) state.changed++;
+        else state.unchanged++;
+        if (!options.out) return;
+
+        NdjsonWriter& out = *state.out;
+        out.beginRecord();
+        out.field("type", "diff");
+        out.field("file", relative);
+        out.field("changed", changed);
+        out.key("changes");
+        out.beginArray();
+        for (const auto& change : diff.changes) {
+            if (change.kind == ChangeKind::Unchanged || change.kind == ChangeKind::Stale) continue;
+            out.beginObject();
+            out.field("component", componentName(change.component));
+            out.field("kind", changeKindName(change.kind));
+            out.field("label", change.label);
+            out.field("old", change.oldValue);
+            out.field("new", change.newValue);
+            out.endObject();
+        }
+        out.endArray();
+        out.endRecord();
+    }
+
+    // False once it has reported why the file can't be compared
+    bool diffFile(WorkerState& state, const fs::path& path, const std::string& relative, SerialDiff& diff) {
+        std::string currentPath = path.string();
+        std::string baselinePath = (baselineRoot / path.lexically_relative(currentRoot)).string();
+
+        // Both current-format files: compare mapped, decode nothing unless
+        // the fingerprints say something changed. Then both sides are
+        // normalized like loaded files, so snapshots written before
+        // normalization don't report case or padding as a change.
+        SnapshotFile currentFile;
+        SnapshotFile baselineFile;
+        if (currentFile.open(currentPath) && baselineFile.open(baselinePath)) {
+            if (compareSnapshots(currentFile.get(), baselineFile.get()).any()) {
+                currentFile.get().toSerials(state.current);
+                baselineFile.get().toSerials(state.saved);
+                normalizeSerials(state.current);
+                normalizeSerials(state.saved);
+                diff = diffSerials(state.current, state.saved);
+            }
+            return true;
+        }
+
+        std::error_code ec;
+        SystemSerials current;
+        SystemSerials saved;
+        if (!fs::exists(baselinePath, ec)) error(state, relative, "no baseline at " + baselinePath);
+        else if (!loadSerialsFile(currentPath, current)) error(state, relative, "not a snapshot");
+        else if (!loadSerialsFile(baselinePath, saved)) error(state, relative, "no readable baseline at " + baselinePath);
+        else {
+            diff = diffSerials(current, saved);
+            return true;
+        }
+        return false;
+    }
+};
+
+}
+
+BulkCompareStats bulkCompare(const BulkCompareOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    WorkStealingPool pool(options.threads);
+    BulkRun run(options, pool);
+
+    fs::path root(options.currentDir);
+    pool.submit([&run, root](size_t worker) { run.walk(worker, root); });
+    pool.run();
+
+    BulkCompareStats stats = {};
+    run.finish(stats);
+    stats.errors += pool.failures(); // a task that threw past its own catch, e.g. in the walk
+    stats.steals = pool.steals();
+    stats.threads = pool.threadCount();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
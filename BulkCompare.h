@@ -0,0 +1,43 @@
+#pragma once
+#ifndef BULK_COMPARE_H
+#define BULK_COMPARE_H
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+struct BulkCompareOptions {
+    std::string currentDir;  // tree of collected snapshots
+    std::string baselineDir; // same relative paths, the baselines
+    size_t threads;          // 0 = hardware concurrency
+    FILE* out;               // NDJSON records, null = counts only
+
+    BulkCompareOptions() : threads(0), out(stdout) {}
+};
+
+struct BulkCompareStats {
+    uint64_t files;
+    uint64_t changed;
+    uint64_t unchanged;
+    uint64_t errors;  // no baseline, a file that isn't a snapshot or whose compare threw
+    uint64_t steals;
+    size_t threads;
+    double seconds;
+};
+
+// Compares every file under currentDir against the file at the same
+// relative path under baselineDir. The walk and the compares run on a
+// WorkStealingPool, so a directory of a few huge snapshots balances against
+// one of many small ones. Each worker formats into its own NdjsonWriter and
+// hands whole buffers to the output, so workers never wait on each other to
+// emit a record.
+//
+// Records: {"type":"diff","file":...,"changed":...,"changes":[...]} per file,
+// {"type":"error","file":...,"message":...} for files that can't be compared.
+// Snapshots are compared mapped in place; legacy formats are loaded. Either
+// way values are normalized before they are diffed, so files written before
+// normalization only differ where the hardware does.
+BulkCompareStats bulkCompare(const BulkCompareOptions& options);
+
+#endif // BULK_COMPARE_H
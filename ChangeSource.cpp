@@ -0,0 +1,31 @@
+// changesource.cpp
+
+#include "ChangeSource.h"
+#include <chrono>
+
+void QueuedChangeSource::post(unsigned components) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending |= components;
+    }
+    cv.notify_one();
+}
+
+unsigned QueuedChangeSource::waitForChanges(unsigned timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // A zero-length timed wait still sleeps for the timer slack
+    if (timeoutMs) cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return pending != 0; });
+    unsigned changed = pending;
+    pending = 0;
+    return changed;
+}
+
+unsigned ScriptedChangeSource::waitForChanges(unsigned timeoutMs) {
+    if (!running) return 0;
+
+    // Posted notifications first, then the next scripted step
+    unsigned changed = QueuedChangeSource::waitForChanges(0);
+    if (position < script.size()) changed |= script[position++];
+    else if (!changed) changed = QueuedChangeSource::waitForChanges(timeoutMs);
+    return changed;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef CHANGE_SOURCE_H
+#define CHANGE_SOURCE_H
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "system_serials.hpp" // WatchComponent
+
+// A source of "something changed" notifications for watch mode. The real
+// implementation sits on OS callbacks (WinChangeSource), tests drive a
+// ScriptedChangeSource instead.
+class ChangeSource {
+public:
+    virtual ~ChangeSource() {}
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+
+    // Blocks up to timeoutMs and returns the components that changed since
+    // the last call, or 0 on timeout
+    virtual unsigned waitForChanges(unsigned timeoutMs) = 0;
+};
+
+// Collects masks posted from callback threads until the watcher asks for them
+class QueuedChangeSource : public ChangeSource {
+public:
+    QueuedChangeSource() : pending(0) {}
+
+    void post(unsigned components);
+    unsigned waitForChanges(unsigned timeoutMs) override;
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned pending;
+};
+
+// Replays a fixed list of notifications, one per waitForChanges call. A step
+// with components == 0 behaves like a timeout. Anything post()ed from another
+// thread is merged in as usual.
+class ScriptedChangeSource : public QueuedChangeSource {
+public:
+    explicit ScriptedChangeSource(const std::vector<unsigned>& script) : script(script), position(0), running(false) {}
+
+    bool start() override { running = true; return true; }
+    void stop() override { running = false; }
+    unsigned waitForChanges(unsigned timeoutMs) override;
+
+    bool finished() const { return position >= script.size(); }
+
+private:
+    std::vector<unsigned> script;
+    size_t position;
+    bool running;
+};
+
+#endif // CHANGE_SOURCE_H
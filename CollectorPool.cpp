@@ -0,0 +1,160 @@
+// collectorpool.cpp
+
+#include "CollectorPool.h"
+#include "Trace.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+
+CollectorPool::CollectorPool(size_t maxThreads) : maxThreads(maxThreads), wallClock(0.0) {
+    if (this->maxThreads == 0) {
+        // Collectors mostly block on WMI/IOCTL/registry, not CPU, so a few
+        // more threads than cores is fine. Keep it bounded either way.
+        size_t hw = std::thread::hardware_concurrency();
+        this->maxThreads = (std::min)((std::max)(hw, (size_t)2), (size_t)8);
+    }
+}
+
+CollectorPool::CollectorId CollectorPool::add(const std::string& name, std::function<void()> work,
+    const std::vector<CollectorId>& dependsOn) {
+
+    CollectorId id = units.size();
+    Unit unit;
+    unit.name = name;
+    unit.work = std::move(work);
+    unit.depCount = 0;
+    unit.pendingDeps = 0;
+    units.push_back(std::move(unit));
+
+    for (CollectorId dep : dependsOn) {
+        // Only earlier units, which keeps the graph acyclic. Anything else is
+        // a caller bug: the unit would run without its input.
+        assert(dep < id && "CollectorPool::add: dependency on a unit not added yet");
+        if (dep >= id) continue;
+        units[dep].dependents.push_back(id);
+        units[id].depCount++;
+    }
+    return id;
+}
+
+void CollectorPool::setThreadHooks(std::function<void()> onStart, std::function<void()> onExit) {
+    threadStart = std::move(onStart);
+    threadExit = std::move(onExit);
+}
+
+void CollectorPool::setCompletionHandler(std::function<void(CollectorId, const CollectorTiming&)> handler) {
+    onComplete = std::move(handler);
+}
+
+CollectorTiming CollectorPool::runUnit(Unit& unit, const Deadline& deadline) {
+    CollectorTiming timing;
+    timing.name = unit.name;
+    timing.succeeded = true;
+    timing.skipped = false;
+    timing.timedOut = false;
+    timing.milliseconds = 0.0;
+
+    if (deadline.expired()) {
+        timing.succeeded = false;
+        timing.skipped = true;
+        return timing;
+    }
+
+    TraceSpan span("Collector", unit.name);
+    auto start = std::chrono::steady_clock::now();
+    try {
+        if (unit.work) unit.work();
+    }
+    catch (...) {
+        timing.succeeded = false;
+    }
+    auto end = std::chrono::steady_clock::now();
+    timing.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    timing.timedOut = deadline.expired();
+    return timing;
+}
+
+std::vector<CollectorTiming> CollectorPool::run(const Deadline& deadline) {
+    std::vector<CollectorTiming> timings(units.size());
+    auto start = std::chrono::steady_clock::now();
+
+    std::deque<CollectorId> ready;
+    for (CollectorId i = 0; i < units.size(); i++) {
+        units[i].pendingDeps = units[i].depCount;
+        if (units[i].pendingDeps == 0) ready.push_back(i);
+    }
+
+    if (maxThreads <= 1) {
+        // Inline mode: plain topological order on the calling thread
+        while (!ready.empty()) {
+            CollectorId id = ready.front();
+            ready.pop_front();
+            timings[id] = runUnit(units[id], deadline);
+            if (onComplete) onComplete(id, timings[id]);
+            for (CollectorId dep : units[id].dependents) {
+                if (--units[dep].pendingDeps == 0) ready.push_back(dep);
+            }
+        }
+    }
+    else {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t remaining = units.size();
+        std::vector<CollectorId> finished; // handed to onComplete on this thread
+
+        auto worker = [&]() {
+            if (threadStart) threadStart();
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                cv.wait(lock, [&]() { return !ready.empty() || remaining == 0; });
+                if (ready.empty()) break;
+
+                CollectorId id = ready.front();
+                ready.pop_front();
+                lock.unlock();
+                CollectorTiming timing = runUnit(units[id], deadline);
+                lock.lock();
+
+                timings[id] = timing;
+                for (CollectorId dep : units[id].dependents) {
+                    if (--units[dep].pendingDeps == 0) ready.push_back(dep);
+                }
+                if (onComplete) finished.push_back(id);
+                remaining--;
+                cv.notify_all();
+            }
+            lock.unlock();
+            if (threadExit) threadExit();
+        };
+
+        size_t threadCount = (std::min)(maxThreads, units.size());
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++) threads.emplace_back(worker);
+
+        if (onComplete) {
+            // Deliver completions while the workers keep going
+            std::vector<CollectorId> batch;
+            size_t delivered = 0;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (delivered < units.size()) {
+                cv.wait(lock, [&]() { return !finished.empty(); });
+                batch.swap(finished);
+                lock.unlock();
+                for (CollectorId id : batch) onComplete(id, timings[id]);
+                delivered += batch.size();
+                batch.clear();
+                lock.lock();
+            }
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    wallClock = std::chrono::duration<double, std::milli>(end - start).count();
+    return timings;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef COLLECTOR_POOL_H
+#define COLLECTOR_POOL_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include "Deadline.h"
+
+// Timing result for one collector unit
+struct CollectorTiming {
+    std::string name;
+    double milliseconds;
+    bool succeeded;
+    bool skipped;  // deadline had passed before it could start
+    bool timedOut; // finished after the deadline, its data may be partial
+};
+
+// Runs independent collector units on a bounded set of worker threads.
+// A unit starts as soon as every unit it depends on has finished, so the
+// wall-clock time of run() is roughly that of the slowest dependency chain.
+class CollectorPool {
+public:
+    typedef size_t CollectorId;
+
+    // maxThreads == 0 picks a default based on hardware concurrency.
+    // maxThreads == 1 runs every unit inline on the calling thread.
+    explicit CollectorPool(size_t maxThreads = 0);
+
+    // dependsOn may only name ids add() already returned; anything else
+    // asserts (release builds ignore it)
+    CollectorId add(const std::string& name, std::function<void()> work,
+        const std::vector<CollectorId>& dependsOn = {});
+
+    // Called once on every worker thread before/after it runs any unit
+    // (used to join the COM apartment). Not called in inline mode.
+    void setThreadHooks(std::function<void()> onStart, std::function<void()> onExit);
+
+    // Called once per unit as it finishes, always on the thread that called
+    // run(), so the handler can draw to the console without locking
+    void setCompletionHandler(std::function<void(CollectorId, const CollectorTiming&)> handler);
+
+    // Blocks until every unit has run or been skipped. Units still queued
+    // when the deadline passes are skipped; running ones are expected to
+    // watch the same deadline themselves. Returns timings in the order
+    // units were added.
+    std::vector<CollectorTiming> run(const Deadline& deadline = Deadline());
+
+    double wallClockMs() const { return wallClock; }
+    size_t threadCount() const { return maxThreads; }
+
+private:
+    struct Unit {
+        std::string name;
+        std::function<void()> work;
+        std::vector<CollectorId> dependents;
+        size_t depCount;
+        size_t pendingDeps;
+    };
+
+    size_t maxThreads;
+    std::vector<Unit> units;
+    std::function<void()> threadStart;
+    std::function<void()> threadExit;
+    std::function<void(CollectorId, const CollectorTiming&)> onComplete;
+    double wallClock;
+
+    static CollectorTiming runUnit(Unit& unit, const Deadline& deadline);
+};
+
+#endif // COLLECTOR_POOL_H
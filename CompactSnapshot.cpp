@@ -0,0 +1,97 @@
+// compactsnapshot.cpp
+
+#include "CompactSnapshot.h"
+#include <cstring>
+
+CompactSnapshotSet::Index CompactSnapshotSet::add(const SystemSerials& serials) {
+    CompactSnapshot s;
+    s.timestamp = pool.intern(serials.timestamp);
+    s.cpuId = pool.intern(serials.cpuId);
+    s.motherboardSerial = pool.intern(serials.motherboardSerial);
+    s.biosSerial = pool.intern(serials.biosSerial);
+    s.lists = (uint32_t)ids.size();
+    s.diskCount = (uint32_t)serials.diskSerials.size();
+    s.adapterCount = (uint32_t)serials.networkAdapters.size();
+    s.incomplete = serials.incomplete;
+
+    for (const auto& disk : serials.diskSerials) ids.push_back(pool.intern(disk));
+    for (const auto& adapter : serials.networkAdapters) {
+        ids.push_back(pool.intern(adapter.first));
+        ids.push_back(pool.intern(adapter.second));
+    }
+    snapshots.push_back(s);
+    return snapshots.size() - 1;
+}
+
+CompactSnapshotSet::Index CompactSnapshotSet::add(const SnapshotView& view) {
+    CompactSnapshot s;
+    s.timestamp = pool.intern(view.timestamp());
+    s.cpuId = pool.intern(view.cpuId());
+    s.motherboardSerial = pool.intern(view.motherboardSerial());
+    s.biosSerial = pool.intern(view.biosSerial());
+    s.lists = (uint32_t)ids.size();
+    s.diskCount = (uint32_t)view.diskCount();
+    s.adapterCount = (uint32_t)view.adapterCount();
+    s.incomplete = 0; // incomplete collections are never encoded
+
+    for (size_t i = 0; i < view.diskCount(); i++) ids.push_back(pool.intern(view.disk(i)));
+    for (size_t i = 0; i < view.adapterCount(); i++) {
+        ids.push_back(pool.intern(view.adapterName(i)));
+        ids.push_back(pool.intern(view.adapterMac(i)));
+    }
+    snapshots.push_back(s);
+    return snapshots.size() - 1;
+}
+
+void CompactSnapshotSet::toSerials(Index i, SystemSerials& out) const {
+    const CompactSnapshot& s = snapshots[i];
+    out.timestamp.assign(pool.get(s.timestamp));
+    out.cpuId.assign(pool.get(s.cpuId));
+    out.motherboardSerial.assign(pool.get(s.motherboardSerial));
+    out.biosSerial.assign(pool.get(s.biosSerial));
+    out.incomplete = s.incomplete;
+
+    const StringPool::Id* list = ids.data() + s.lists;
+    out.diskSerials.resize(s.diskCount);
+    for (uint32_t d = 0; d < s.diskCount; d++) out.diskSerials[d].assign(pool.get(list[d]));
+    list += s.diskCount;
+    out.networkAdapters.resize(s.adapterCount);
+    for (uint32_t a = 0; a < s.adapterCount; a++) {
+        out.networkAdapters[a].first.assign(pool.get(list[2 * a]));
+        out.networkAdapters[a].second.assign(pool.get(list[2 * a + 1]));
+    }
+}
+
+unsigned CompactSnapshotSet::changedComponents(Index a, Index b) const {
+    const CompactSnapshot& x = snapshots[a];
+    const CompactSnapshot& y = snapshots[b];
+    unsigned changed = 0;
+    if (x.cpuId != y.cpuId) changed |= WatchCpu;
+    if (x.motherboardSerial != y.motherboardSerial) changed |= WatchMotherboard;
+    if (x.biosSerial != y.biosSerial) changed |= WatchBios;
+
+    const StringPool::Id* xs = ids.data() + x.lists;
+    const StringPool::Id* ys = ids.data() + y.lists;
+    if (x.diskCount != y.diskCount || memcmp(xs, ys, x.diskCount * sizeof(StringPool::Id)) != 0)
+        changed |= WatchDisks;
+    if (x.adapterCount != y.adapterCount ||
+        memcmp(xs + x.diskCount, ys + y.diskCount, 2 * (size_t)x.adapterCount * sizeof(StringPool::Id)) != 0)
+        changed |= WatchAdapters;
+    return changed;
+}
+
+size_t CompactSnapshotSet::memoryUsage() const {
+    return pool.memoryUsage() + snapshots.capacity() * sizeof(CompactSnapshot) +
+        ids.capacity() * sizeof(StringPool::Id);
+}
+
+void CompactSnapshotSet::reserve(size_t snapshotCount, size_t idCount) {
+    snapshots.reserve(snapshotCount);
+    ids.reserve(idCount);
+}
+
+void CompactSnapshotSet::clear() {
+    pool.clear();
+    snapshots.clear();
+    ids.clear();
+}
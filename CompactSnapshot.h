@@ -0,0 +1,69 @@
+#pragma once
+#ifndef COMPACT_SNAPSHOT_H
+#define COMPACT_SNAPSHOT_H
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "system_serials.hpp"
+#include "SerialSnapshot.h"
+#include "StringPool.h"
+
+// One snapshot as StringPool IDs. Lists live in the owning set's shared ID
+// array: diskCount disk IDs, then adapterCount (name, MAC) ID pairs.
+struct CompactSnapshot {
+    StringPool::Id timestamp;
+    StringPool::Id cpuId;
+    StringPool::Id motherboardSerial;
+    StringPool::Id biosSerial;
+    uint32_t lists;      // first list ID
+    uint32_t diskCount;
+    uint32_t adapterCount;
+    uint32_t incomplete;
+};
+
+// Many snapshots in a few flat arrays, for holding a fleet in memory. Each
+// distinct value is stored once however many snapshots share it (a common
+// CPU ID, "Default string" BIOS serials, one machine's history), so a
+// snapshot costs 32 bytes plus 4 per disk and 8 per adapter instead of a
+// heap allocation per field. Scans walk contiguous memory, and equal values
+// compare as equal IDs. Not thread-safe.
+class CompactSnapshotSet {
+public:
+    typedef size_t Index;
+
+    Index add(const SystemSerials& serials);
+    // Straight from an encoded snapshot, no intermediate strings
+    Index add(const SnapshotView& view);
+
+    size_t size() const { return snapshots.size(); }
+    const CompactSnapshot& operator[](Index i) const { return snapshots[i]; }
+
+    std::string_view text(StringPool::Id id) const { return pool.get(id); }
+    StringPool::Id disk(Index i, size_t d) const { return ids[snapshots[i].lists + d]; }
+    StringPool::Id adapterName(Index i, size_t a) const { return ids[snapshots[i].lists + snapshots[i].diskCount + 2 * a]; }
+    StringPool::Id adapterMac(Index i, size_t a) const { return ids[snapshots[i].lists + snapshots[i].diskCount + 2 * a + 1]; }
+
+    void toSerials(Index i, SystemSerials& out) const;
+
+    // WatchComponent bits whose values differ, ignoring the timestamp. Lists
+    // compare in order, like SerialWatcher::changedComponents; only ID
+    // compares, no string is touched.
+    unsigned changedComponents(Index a, Index b) const;
+
+    const StringPool& strings() const { return pool; }
+
+    // Heap bytes held, for sizing fleet analyses
+    size_t memoryUsage() const;
+
+    void reserve(size_t snapshotCount, size_t idCount);
+    void clear();
+
+private:
+    StringPool pool;
+    std::vector<CompactSnapshot> snapshots;
+    std::vector<StringPool::Id> ids;
+};
+
+#endif // COMPACT_SNAPSHOT_H
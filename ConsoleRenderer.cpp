@@ -0,0 +1,231 @@
+// consolerenderer.cpp
+
+#include "ConsoleRenderer.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif
+
+ScreenFrame::ScreenFrame() : attr(7) {
+    clear();
+}
+
+void ScreenFrame::clear() {
+    rows.assign(1, Line());
+}
+
+void ScreenFrame::write(std::string_view text) {
+    size_t start = 0;
+    for (size_t i = 0; i <= text.size(); i++) {
+        if (i < text.size() && text[i] != '\n' && (unsigned char)text[i] >= 0x20) continue;
+
+        // Flush the printable run before the control character
+        if (i > start) {
+            Line& line = rows.back();
+            line.text.append(text.data() + start, i - start);
+            line.attrs.append(i - start, (char)attr);
+        }
+        if (i < text.size() && text[i] == '\n') rows.push_back(Line());
+        start = i + 1;
+    }
+}
+
+ScreenFrameBuf::int_type ScreenFrameBuf::overflow(int_type ch) {
+    if (ch != traits_type::eof()) {
+        char c = traits_type::to_char_type(ch);
+        frame.write(std::string_view(&c, 1));
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize ScreenFrameBuf::xsputn(const char* s, std::streamsize n) {
+    frame.write(std::string_view(s, (size_t)n));
+    return n;
+}
+
+// Windows attribute color (bit 0 blue, 1 green, 2 red, 3 bright) to the
+// ANSI 0-7 index (bit 0 red, 1 green, 2 blue)
+static int ansiColor(int color) {
+    return ((color & 1) << 2) | (color & 2) | ((color & 4) >> 2);
+}
+
+static void appendAttribute(std::string& out, uint8_t attr) {
+    // Plain grey on black is the console default, so use the terminal's own
+    if (attr == 7) {
+        out += "\x1b[0m";
+        return;
+    }
+    int fg = attr & 15;
+    int bg = (attr >> 4) & 15;
+    out += "\x1b[0;";
+    out += std::to_string((fg & 8 ? 90 : 30) + ansiColor(fg));
+    if (bg) {
+        out += ';';
+        out += std::to_string((bg & 8 ? 100 : 40) + ansiColor(bg));
+    }
+    out += 'm';
+}
+
+static void appendLine(std::string& out, const ScreenFrame::Line& line) {
+    // One SGR per color run rather than per character
+    int current = -1;
+    for (size_t i = 0; i < line.text.size(); i++) {
+        uint8_t a = (uint8_t)line.attrs[i];
+        if (a != current) {
+            appendAttribute(out, a);
+            current = a;
+        }
+        out += line.text[i];
+    }
+    out += "\x1b[0m\x1b[K"; // reset and clear whatever the old line left behind
+}
+
+static void appendMoveTo(std::string& out, size_t row) {
+    out += "\x1b[";
+    out += std::to_string(row + 1);
+    out += ";1H";
+}
+
+std::string ConsoleRenderer::renderDiff(const ScreenFrame& previous, const ScreenFrame& next, bool fullRepaint,
+    size_t top) {
+    std::string out;
+    const auto& before = previous.lines();
+    const auto& after = next.lines();
+
+    if (fullRepaint) {
+        out += "\x1b[H\x1b[2J";
+        for (size_t i = 0; i < after.size(); i++) {
+            if (i) out += "\r\n";
+            appendLine(out, after[i]);
+        }
+        return out;
+    }
+
+    size_t rows = (std::max)(before.size(), after.size());
+    for (size_t i = top; i < rows; i++) {
+        if (i < after.size()) {
+            if (i < before.size() && before[i] == after[i]) continue;
+            appendMoveTo(out, i - top);
+            appendLine(out, after[i]);
+        }
+        else {
+            appendMoveTo(out, i - top);
+            out += "\x1b[2K";
+        }
+    }
+
+    // Leave the cursor where the frame's text ends, ready for input prompts
+    if (after.size() > top) {
+        appendMoveTo(out, after.size() - 1 - top);
+        size_t column = after.back().text.size();
+        if (column) {
+            out += "\x1b[";
+            out += std::to_string(column);
+            out += 'C';
+        }
+    }
+    return out;
+}
+
+std::string ConsoleRenderer::renderPlain(const ScreenFrame& previous, const ScreenFrame& next, bool fullRepaint) {
+    std::string out;
+    const auto& before = previous.lines();
+    const auto& after = next.lines();
+
+    // Usually the frame only grew since the last present (output ahead of
+    // an input prompt), so only the new text goes out
+    size_t last = before.size() - 1;
+    bool extends = !fullRepaint && after.size() >= before.size() &&
+        std::equal(before.begin(), before.begin() + last, after.begin()) &&
+        after[last].text.compare(0, before[last].text.size(), before[last].text) == 0;
+    if (extends) {
+        out.assign(after[last].text, before[last].text.size(), std::string::npos);
+        for (size_t i = last + 1; i < after.size(); i++) {
+            out += '\n';
+            out += after[i].text;
+        }
+        return out;
+    }
+
+    // A new screen: start it on a fresh line below the old one
+    bool atLineStart = before.size() == 1 && before[0].text.empty();
+    if (!atLineStart) out += '\n';
+    for (size_t i = 0; i < after.size(); i++) {
+        if (i) out += '\n';
+        out += after[i].text;
+    }
+    return out;
+}
+
+ConsoleRenderer::ConsoleRenderer() : shownTop(0), valid(false), plain(false) {
+}
+
+bool ConsoleRenderer::enableVirtualTerminal() {
+#ifdef _WIN32
+    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (!GetConsoleMode(hOut, &mode)) return false;
+    if (mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING) return true;
+    return SetConsoleMode(hOut, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+#else
+    return isatty(STDOUT_FILENO) != 0;
+#endif
+}
+
+int ConsoleRenderer::viewportHeight() {
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return 0;
+    return csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+#else
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0) return 0;
+    return ws.ws_row;
+#endif
+}
+
+bool ConsoleRenderer::writeAll(const std::string& data) {
+    const char* p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+#ifdef _WIN32
+        DWORD written = 0;
+        DWORD chunk = (DWORD)(std::min)(left, (size_t)1 << 20);
+        if (!WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), p, chunk, &written, NULL) || written == 0) return false;
+#else
+        ssize_t written = ::write(STDOUT_FILENO, p, left);
+        if (written <= 0) return false;
+#endif
+        p += written;
+        left -= (size_t)written;
+    }
+    return true;
+}
+
+size_t ConsoleRenderer::present(const ScreenFrame& frame) {
+    if (plain) {
+        output = renderPlain(shown, frame, !valid);
+    }
+    else {
+        // A repaint of a frame taller than the window leaves its last rows
+        // on screen. While that window stays on the same rows it is diffed
+        // like any other frame; when it moves, the frame scrolled and is
+        // repainted.
+        int height = viewportHeight();
+        size_t top = height > 0 && frame.height() > (size_t)height ? frame.height() - (size_t)height : 0;
+        output = renderDiff(shown, frame, !valid || top != shownTop, top);
+        shownTop = top;
+    }
+
+    if (!output.empty() && !writeAll(output)) {
+        valid = false;
+        return 0;
+    }
+    shown = frame;
+    valid = true;
+    return output.size();
+}
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef CONSOLE_RENDERER_H
+#define CONSOLE_RENDERER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <streambuf>
+#include <ostream>
+#include <cstdint>
+
+// One screen's worth of text with a color attribute per character. Colors
+// use the Windows console attribute layout (background << 4 | foreground,
+// bit 3 = bright) so ConsoleUtils::Color values map straight across; 7 is
+// drawn in the terminal's default colors.
+class ScreenFrame {
+public:
+    struct Line {
+        std::string text;
+        std::string attrs; // one attribute byte per character of text
+
+        bool operator==(const Line& other) const { return text == other.text && attrs == other.attrs; }
+        bool operator!=(const Line& other) const { return !(*this == other); }
+    };
+
+    ScreenFrame();
+
+    void clear();
+    void setAttribute(uint8_t attribute) { attr = attribute; }
+    uint8_t attribute() const { return attr; }
+
+    // '\n' starts a new line, '\r' and other control characters are dropped
+    void write(std::string_view text);
+
+    const std::vector<Line>& lines() const { return rows; }
+
+    // Lines up to the last one holding text (a trailing '\n' adds an empty one)
+    size_t height() const { return rows.size(); }
+
+private:
+    std::vector<Line> rows;
+    uint8_t attr;
+};
+
+// Lets the usual iostream formatting (setw, setprecision, ...) land in a frame
+class ScreenFrameBuf : public std::streambuf {
+public:
+    explicit ScreenFrameBuf(ScreenFrame& frame) : frame(frame) {}
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+private:
+    ScreenFrame& frame;
+};
+
+// Presents frames to a VT/ANSI terminal. Each present() compares the new
+// frame with the one on screen, rewrites only the lines that differ and
+// sends the result with a single write. Frames taller than the window are
+// diffed within the rows the window shows; scrollback keeps what was there
+// at the last full repaint. Without VT support (setPlain) frames are
+// written as text only.
+class ConsoleRenderer {
+public:
+    ConsoleRenderer();
+
+    // Turns on VT processing for the Windows console; a no-op elsewhere.
+    // Returns false if stdout is not a terminal that understands it.
+    bool enableVirtualTerminal();
+
+    // Write text without escape sequences: what was appended to the frame
+    // since the last present(), or the whole frame when it was redrawn
+    void setPlain(bool enable) { plain = enable; valid = false; }
+
+    // Forget what is on screen; the next present() clears and repaints
+    void invalidate() { valid = false; }
+
+    // Returns the number of bytes written
+    size_t present(const ScreenFrame& frame);
+
+    // The escape sequence stream that turns previous into next. With
+    // fullRepaint the screen is cleared and every line is drawn; otherwise
+    // frame row top sits on the window's first row and only rows from top
+    // on are touched.
+    static std::string renderDiff(const ScreenFrame& previous, const ScreenFrame& next, bool fullRepaint,
+        size_t top = 0);
+
+    // The plain text stream for next after previous was written
+    static std::string renderPlain(const ScreenFrame& previous, const ScreenFrame& next, bool fullRepaint);
+
+    // Terminal rows, or 0 if unknown
+    static int viewportHeight();
+
+private:
+    ScreenFrame shown;
+    size_t shownTop; // frame row on the window's first row
+    bool valid;
+    bool plain;
+    std::string output;
+
+    static bool writeAll(const std::string& data);
+};
+
+#endif // CONSOLE_RENDERER_H
@@ -1,4 +1,7 @@
 #include "ConsoleUtils.h"
 
-HANDLE ConsoleUtils::hConsole = NULL;
-WORD ConsoleUtils::originalAttributes = 7;
\ No newline at end of file
+// Declared in dependency order: the stream writes through frameBuf into frame
+ScreenFrame ConsoleUtils::frame;
+ScreenFrameBuf ConsoleUtils::frameBuf(ConsoleUtils::frame);
+std::ostream ConsoleUtils::stream(&ConsoleUtils::frameBuf);
+ConsoleRenderer ConsoleUtils::renderer;
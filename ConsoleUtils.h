@@ -2,23 +2,19 @@
 #ifndef CONSOLE_UTILS_H
 #define CONSOLE_UTILS_H
 
-#include <windows.h>
-#ifdef max
-#undef max
-#endif
 #include <iostream>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include "ConsoleRenderer.h"
 
+// Everything is composed into one ScreenFrame through out(); present()
+// diffs it against what is on screen and sends the changes in one write.
+// clearScreen() only starts a new frame, nothing is erased until present().
 class ConsoleUtils {
 public:
-    // Expose console handle for redirect operations
-    static HANDLE hConsole;
-    static WORD originalAttributes;
-
     enum Color {
         BLACK = 0,
         DARK_BLUE = 1,
@@ -39,86 +35,94 @@ public:
     };
 
     static void initialize() {
-        hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        CONSOLE_SCREEN_BUFFER_INFO csbi;
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
-        originalAttributes = csbi.wAttributes;
+        // Redirected output or an old console: no cursor movement or colors
+        renderer.setPlain(!renderer.enableVirtualTerminal());
+        frame.clear();
+        resetColor();
     }
 
+    static std::ostream& out() { return stream; }
+
     static void setColor(Color foreground, Color background = BLACK) {
-        SetConsoleTextAttribute(hConsole, (background << 4) | foreground);
+        frame.setAttribute((uint8_t)((background << 4) | foreground));
     }
 
     static void resetColor() {
-        SetConsoleTextAttribute(hConsole, originalAttributes);
+        frame.setAttribute(DARK_WHITE);
+    }
+
+    // Call before anything blocks (input, sleeps, long collections)
+    static void present() {
+        renderer.present(frame);
     }
 
     static void printColored(const std::string& text, Color color) {
         setColor(color);
-        std::cout << text;
+        out() << text;
         resetColor();
     }
 
     static void printHeader(const std::string& title, Color color = CYAN) {
-        std::cout << "\n";
+        out() << "\n";
         setColor(color);
-        std::cout << std::string(70, '=') << "\n";
-        std::cout << " " << title << "\n";
-        std::cout << std::string(70, '=') << "\n";
+        out() << std::string(70, '=') << "\n";
+        out() << " " << title << "\n";
+        out() << std::string(70, '=') << "\n";
         resetColor();
     }
 
     static void printItem(const std::string& label, const std::string& value,
         Color labelColor = DARK_WHITE, Color valueColor = WHITE) {
         setColor(labelColor);
-        std::cout << std::left << std::setw(25) << label << ": ";
+        out() << std::left << std::setw(25) << label << ": ";
         setColor(valueColor);
-        std::cout << value << "\n";
+        out() << value << "\n";
         resetColor();
     }
 
     static void printSuccess(const std::string& message) {
         setColor(GREEN);
-        std::cout << "[SUCCESS] ";
+        out() << "[SUCCESS] ";
         resetColor();
-        std::cout << message << "\n";
+        out() << message << "\n";
     }
 
     static void printError(const std::string& message) {
         setColor(RED);
-        std::cout << "[ERROR] ";
+        out() << "[ERROR] ";
         resetColor();
-        std::cout << message << "\n";
+        out() << message << "\n";
     }
 
     static void printWarning(const std::string& message) {
         setColor(YELLOW);
-        std::cout << "[WARNING] ";
+        out() << "[WARNING] ";
         resetColor();
-        std::cout << message << "\n";
+        out() << message << "\n";
     }
 
     static void printInfo(const std::string& message) {
         setColor(CYAN);
-        std::cout << "[INFO] ";
+        out() << "[INFO] ";
         resetColor();
-        std::cout << message << "\n";
+        out() << message << "\n";
     }
 
     static void clearScreen() {
-        system("cls");
+        frame.clear();
     }
 
     static void pause() {
-        std::cout << "\nPress any key to continue...";
+        out() << "\nPress any key to continue...";
+        present();
         std::cin.get();
     }
 
     static void printSubHeader(const std::string& title, Color color = CYAN) {
         setColor(color);
-        std::cout << std::string(40, '-') << "\n";
-        std::cout << "  " << title << "\n";
-        std::cout << std::string(40, '-') << "\n";
+        out() << std::string(40, '-') << "\n";
+        out() << "  " << title << "\n";
+        out() << std::string(40, '-') << "\n";
         resetColor();
     }
 
@@ -130,27 +134,33 @@ public:
 
         while (std::getline(ss, line)) {
             lines.push_back(line);
-            maxLength = std::max(maxLength, line.length());
+            maxLength = (std::max)(maxLength, line.length());
         }
 
         setColor(borderColor);
-        std::cout << "+" << std::string(maxLength + 2, '-') << "+\n";
+        out() << "+" << std::string(maxLength + 2, '-') << "+\n";
         resetColor();
 
         for (const auto& l : lines) {
             setColor(borderColor);
-            std::cout << "| ";
+            out() << "| ";
             resetColor();
-            std::cout << std::left << std::setw(maxLength) << l;
+            out() << std::left << std::setw(maxLength) << l;
             setColor(borderColor);
-            std::cout << " |\n";
+            out() << " |\n";
             resetColor();
         }
 
         setColor(borderColor);
-        std::cout << "+" << std::string(maxLength + 2, '-') << "+\n";
+        out() << "+" << std::string(maxLength + 2, '-') << "+\n";
         resetColor();
     }
+
+private:
+    static ScreenFrame frame;
+    static ScreenFrameBuf frameBuf;
+    static std::ostream stream;
+    static ConsoleRenderer renderer;
 };
 
 #endif // CONSOLE_UTILS_H
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <chrono>
+
+// Point in time a refresh has to finish by. Collectors check it between
+// blocking calls and size their own waits from remainingMs(), so one wedged
+// WMI provider or disk costs at most the remaining budget. Cooperative:
+// nothing is interrupted, collectors return what they have.
+class Deadline {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Never expires
+    Deadline() : at(Clock::time_point::max()) {}
+
+    // 0 means no deadline
+    static Deadline after(unsigned milliseconds) {
+        Deadline d;
+        if (milliseconds) d.at = Clock::now() + std::chrono::milliseconds(milliseconds);
+        return d;
+    }
+
+    bool isSet() const { return at != Clock::time_point::max(); }
+    bool expired() const { return isSet() && Clock::now() >= at; }
+
+    // Milliseconds left, at most cap; 0 once expired. Useful as a wait
+    // timeout: slice long waits with a small cap and re-check.
+    unsigned long remainingMs(unsigned long cap = 0xFFFFFFFEul) const {
+        if (!isSet()) return cap;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(at - Clock::now()).count();
+        if (left <= 0) return 0;
+        return (unsigned long)left < cap ? (unsigned long)left : cap;
+    }
+
+private:
+    Clock::time_point at;
+};
+
+#endif // DEADLINE_H
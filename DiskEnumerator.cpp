@@ -0,0 +1,106 @@
+// diskenumerator.cpp
+
+#include "DiskEnumerator.h"
+#include "BinaryIO.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+
+// Offsets into STORAGE_DEVICE_DESCRIPTOR
+static const size_t SizeOffset = 4;
+static const size_t RemovableOffset = 10;
+static const size_t VendorIdOffset = 12;
+static const size_t ProductIdOffset = 16;
+static const size_t SerialNumberOffset = 24;
+static const size_t BusTypeOffset = 28;
+
+static void descriptorString(const unsigned char* data, size_t size, size_t field, std::string& out) {
+    out.clear();
+    uint32_t offset = getU32((const char*)data + field);
+    if (offset == 0 || offset >= size) return;
+    const char* begin = (const char*)data + offset;
+    const char* nul = (const char*)memchr(begin, '\0', size - offset);
+    const char* end = nul ? nul : (const char*)data + size;
+    while (begin < end && (unsigned char)*begin <= ' ') begin++;
+    while (end > begin && (unsigned char)end[-1] <= ' ') end--;
+    out.assign(begin, end - begin);
+}
+
+size_t storageDescriptorSize(const unsigned char* data, size_t size) {
+    if (size < StorageDescriptorHeaderSize) return 0;
+    return getU32((const char*)data + SizeOffset);
+}
+
+bool parseStorageDescriptor(const unsigned char* data, size_t size, DiskInfo& disk) {
+    if (size < StorageDescriptorFixedSize) return false;
+    // Never trust the strings past what the device said it wrote
+    size = (std::min)(size, (std::max)(storageDescriptorSize(data, size), StorageDescriptorFixedSize));
+    disk.removable = data[RemovableOffset] != 0;
+    disk.busType = getU32((const char*)data + BusTypeOffset);
+    descriptorString(data, size, VendorIdOffset, disk.vendor);
+    descriptorString(data, size, ProductIdOffset, disk.product);
+    descriptorString(data, size, SerialNumberOffset, disk.serial);
+    return true;
+}
+
+void assignDiskSerials(const std::vector<DiskInfo>& disks, std::vector<std::string>& serials) {
+    size_t count = 0;
+    for (const auto& disk : disks) {
+        if (disk.serial.empty()) continue;
+        if (count == serials.size()) serials.emplace_back();
+        serials[count++].assign(disk.serial);
+    }
+    serials.resize(count);
+}
+
+void FixtureDiskEnumerator::add(const std::string& path, const std::string& descriptor) {
+    devices.emplace_back(path, descriptor);
+}
+
+bool FixtureDiskEnumerator::loadDirectory(const std::string& dir) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) files.push_back(it->path());
+    }
+    if (ec) return false;
+    std::sort(files.begin(), files.end());
+
+    for (const auto& file : files) {
+        std::ifstream in(file.string(), std::ios::binary);
+        if (!in) return false;
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        add(file.filename().string(), bytes);
+    }
+    return true;
+}
+
+bool FixtureDiskEnumerator::enumerate(std::vector<DiskInfo>& disks, const Deadline& deadline, bool& timedOut) {
+    size_t count = 0;
+    if (buffer.size() < StorageDescriptorInitialBuffer) buffer.resize(StorageDescriptorInitialBuffer);
+
+    for (const auto& device : devices) {
+        if (deadline.expired()) {
+            timedOut = true;
+            break;
+        }
+        const std::string& descriptor = device.second;
+        size_t returned;
+        for (;;) {
+            returned = (std::min)(buffer.size(), descriptor.size());
+            memcpy(buffer.data(), descriptor.data(), returned);
+            queryCount++;
+            size_t required = storageDescriptorSize(buffer.data(), returned);
+            if (required <= buffer.size() || required > descriptor.size()) break;
+            buffer.resize(required);
+        }
+
+        if (count == disks.size()) disks.emplace_back();
+        if (!parseStorageDescriptor(buffer.data(), returned, disks[count])) continue;
+        disks[count++].path.assign(device.first);
+    }
+    disks.resize(count);
+    return true;
+}
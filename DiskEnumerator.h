@@ -0,0 +1,81 @@
+#pragma once
+#ifndef DISK_ENUMERATOR_H
+#define DISK_ENUMERATOR_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "Deadline.h"
+
+// One disk as its STORAGE_DEVICE_DESCRIPTOR describes it
+struct DiskInfo {
+    std::string path;    // device interface path, or the fixture's name
+    std::string serial;  // empty if the device reports none
+    std::string vendor;
+    std::string product;
+    uint32_t busType;    // STORAGE_BUS_TYPE
+    bool removable;
+
+    DiskInfo() : busType(0), removable(false) {}
+};
+
+// Portable STORAGE_DEVICE_DESCRIPTOR decoding, shared by the real and fake
+// enumerators. The descriptor is variable length: the fixed part is
+// followed by NUL-terminated strings at the offsets it names, and a device
+// handed a short buffer fills what fits and reports the full size.
+static const size_t StorageDescriptorHeaderSize = 8;  // Version, Size
+static const size_t StorageDescriptorFixedSize = 36;  // through RawPropertiesLength
+static const size_t StorageDescriptorInitialBuffer = 1024;
+
+// Size the device says the whole descriptor needs, 0 if size is too short to tell
+size_t storageDescriptorSize(const unsigned char* data, size_t size);
+
+// Strings whose offset is 0 or past size are left empty; the serial is
+// trimmed of the padding ATA devices add. False if the fixed part is missing.
+bool parseStorageDescriptor(const unsigned char* data, size_t size, DiskInfo& disk);
+
+// Replaces serials with those of the disks that have one, in enumeration
+// order, overwriting the strings already there
+void assignDiskSerials(const std::vector<DiskInfo>& disks, std::vector<std::string>& serials);
+
+// Finds every disk and reads its descriptor. The real implementation
+// (WinDiskEnumerator) queries all devices at once; tests and Linux builds
+// use FixtureDiskEnumerator. Implementations overwrite the DiskInfo
+// entries already in the output, so a refresh that finds the same disks
+// doesn't allocate.
+class DiskEnumerator {
+public:
+    virtual ~DiskEnumerator() {}
+
+    // Replaces disks with every disk that answered before the deadline, in
+    // discovery order, and sets timedOut if any didn't. False if the
+    // devices couldn't be listed at all.
+    virtual bool enumerate(std::vector<DiskInfo>& disks, const Deadline& deadline, bool& timedOut) = 0;
+};
+
+// Serves captured descriptors the way a device would: each query fills at
+// most the current buffer, and a descriptor that didn't fit is queried
+// again with a buffer of the size it reported.
+class FixtureDiskEnumerator : public DiskEnumerator {
+public:
+    FixtureDiskEnumerator() : queryCount(0) {}
+
+    void add(const std::string& path, const std::string& descriptor);
+
+    // Every regular file in dir, in name order, as one raw descriptor dump
+    bool loadDirectory(const std::string& dir);
+
+    bool enumerate(std::vector<DiskInfo>& disks, const Deadline& deadline, bool& timedOut) override;
+
+    // Queries issued so far, two for every descriptor over the initial buffer
+    size_t queries() const { return queryCount; }
+
+private:
+    std::vector<std::pair<std::string, std::string>> devices; // path, descriptor bytes
+    std::vector<unsigned char> buffer;                        // grow-only
+    size_t queryCount;
+};
+
+#endif // DISK_ENUMERATOR_H
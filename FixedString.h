@@ -0,0 +1,73 @@
+#pragma once
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <string_view>
+#include <cstring>
+#include <cstddef>
+
+// Bounded string in inline storage, for the paths and values a collector
+// builds on every refresh. Never allocates; text past Capacity is dropped
+// and truncated() reports it, so a caller can skip a path that didn't fit
+// rather than open the wrong one. Always NUL-terminated.
+template <size_t Capacity>
+class FixedString {
+public:
+    FixedString() : length(0), overflowed(false) { text[0] = '\0'; }
+    explicit FixedString(std::string_view s) : FixedString() { append(s); }
+
+    FixedString& assign(std::string_view s) {
+        clear();
+        return append(s);
+    }
+
+    FixedString& append(std::string_view s) {
+        size_t n = s.size();
+        if (n > Capacity - length) {
+            n = Capacity - length;
+            overflowed = true;
+        }
+        memcpy(text + length, s.data(), n);
+        length += n;
+        text[length] = '\0';
+        return *this;
+    }
+
+    FixedString& append(char c) {
+        if (length == Capacity) {
+            overflowed = true;
+            return *this;
+        }
+        text[length++] = c;
+        text[length] = '\0';
+        return *this;
+    }
+
+    void clear() {
+        length = 0;
+        overflowed = false;
+        text[0] = '\0';
+    }
+
+    // For APIs that write into a caller's buffer: fill data() (up to
+    // capacity() bytes), then resize() to what was written
+    char* data() { return text; }
+    void resize(size_t n) {
+        length = n < Capacity ? n : Capacity;
+        text[length] = '\0';
+    }
+
+    const char* c_str() const { return text; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool truncated() const { return overflowed; }
+    std::string_view view() const { return std::string_view(text, length); }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    char text[Capacity + 1];
+    size_t length;
+    bool overflowed;
+};
+
+#endif // FIXED_STRING_H
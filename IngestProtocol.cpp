@@ -0,0 +1,302 @@
+// ingestprotocol.cpp
+
+#include "IngestProtocol.h"
+#include "BinaryIO.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+bool IngestProtocol::appendFrame(std::string& out, std::string_view machineId, std::string_view snapshot) {
+    // Anything parseFrame would refuse, and a length that would wrap
+    if (machineId.empty() || machineId.size() > 0xFFFF) return false;
+    if (KeyLengthSize + machineId.size() + snapshot.size() > MaxFrameSize) return false;
+
+    size_t start = out.size();
+    out.resize(start + LengthSize + KeyLengthSize);
+    putU32(&out[start], (uint32_t)(KeyLengthSize + machineId.size() + snapshot.size()));
+    putU16(&out[start + LengthSize], (uint16_t)machineId.size());
+    out.append(machineId.data(), machineId.size());
+    out.append(snapshot.data(), snapshot.size());
+    return true;
+}
+
+IngestProtocol::ParseResult IngestProtocol::parseFrame(const char* data, size_t size, size_t& consumed,
+    std::string_view& machineId, std::string_view& snapshot) {
+
+    if (size < LengthSize) return NeedMore;
+    uint32_t length = getU32(data);
+    if (length < KeyLengthSize || length > MaxFrameSize) return Malformed;
+    if (size < LengthSize + length) return NeedMore;
+
+    uint16_t keyLength = getU16(data + LengthSize);
+    if (keyLength == 0 || KeyLengthSize + (size_t)keyLength > length) return Malformed;
+
+    const char* key = data + LengthSize + KeyLengthSize;
+    machineId = std::string_view(key, keyLength);
+    snapshot = std::string_view(key + keyLength, length - KeyLengthSize - keyLength);
+    consumed = LengthSize + length;
+    return Complete;
+}
+
+const char* ingestStatusName(IngestStatus status) {
+    switch (status) {
+    case IngestUnchanged: return "unchanged";
+    case IngestChanged: return "changed";
+    case IngestNew: return "new";
+    case IngestRejected: return "rejected";
+    case IngestFailed: return "failed";
+    }
+    return "unknown";
+}
+
+#ifdef _WIN32
+typedef SOCKET NativeSocket;
+static const NativeSocket NativeInvalid = INVALID_SOCKET;
+#else
+typedef int NativeSocket;
+static const NativeSocket NativeInvalid = -1;
+#endif
+
+static NativeSocket native(IngestSocket::Handle handle) {
+    return handle == IngestSocket::Invalid ? NativeInvalid : (NativeSocket)handle;
+}
+
+static IngestSocket::Handle wrap(NativeSocket socket) {
+    return socket == NativeInvalid ? IngestSocket::Invalid : (IngestSocket::Handle)socket;
+}
+
+static void closeNative(NativeSocket socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    ::close(socket);
+#endif
+}
+
+// Small request/reply frames: don't let Nagle hold them back
+static void setNoDelay(NativeSocket socket) {
+    int on = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+}
+
+bool IngestSocket::startup() {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+static bool splitHostPort(const std::string& address, std::string& host, std::string& port) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) return false;
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    return true;
+}
+
+static bool isUnixAddress(const std::string& address) {
+    return address.compare(0, 5, "unix:") == 0;
+}
+
+#ifndef _WIN32
+static bool unixAddress(const std::string& address, sockaddr_un& sa, std::string& error) {
+    std::string path = address.substr(5);
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(sa.sun_path)) {
+        error = "bad unix socket path";
+        return false;
+    }
+    memcpy(sa.sun_path, path.data(), path.size());
+    return true;
+}
+#endif
+
+// 127.0.0.0/8, ::1 or an IPv4-mapped 127.x address
+static bool isLoopback(const sockaddr* sa) {
+    if (sa->sa_family == AF_INET) {
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(
+            &reinterpret_cast<const sockaddr_in*>(sa)->sin_addr);
+        return ip[0] == 127;
+    }
+    if (sa->sa_family == AF_INET6) {
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(
+            &reinterpret_cast<const sockaddr_in6*>(sa)->sin6_addr);
+        static const unsigned char loopback[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+        static const unsigned char mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+        return memcmp(ip, loopback, 16) == 0 || (memcmp(ip, mapped, 12) == 0 && ip[12] == 127);
+    }
+    return false;
+}
+
+// Resolves, then tries each address until bind+listen or connect succeeds.
+// Pushes carry no credentials, so a listener is only ever bound to
+// loopback: anything that can connect can overwrite any machine's
+// snapshot. Remote machines reach it through a tunnel.
+static IngestSocket::Handle openTcp(const std::string& address, bool listening, std::string& error) {
+    std::string host, port;
+    if (!splitHostPort(address, host, port)) {
+        error = "expected host:port or unix:/path";
+        return IngestSocket::Invalid;
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &results) != 0) {
+        error = "cannot resolve " + address;
+        return IngestSocket::Invalid;
+    }
+
+    if (listening) {
+        for (addrinfo* ai = results; ai; ai = ai->ai_next) {
+            if (isLoopback(ai->ai_addr)) continue;
+            freeaddrinfo(results);
+            error = "refusing to listen on " + address +
+                ": pushes are not authenticated, use a loopback address or a unix socket";
+            return IngestSocket::Invalid;
+        }
+    }
+
+    NativeSocket socket = NativeInvalid;
+    for (addrinfo* ai = results; ai && socket == NativeInvalid; ai = ai->ai_next) {
+        socket = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (socket == NativeInvalid) continue;
+        bool ok;
+        if (listening) {
+            int on = 1;
+            setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on));
+            ok = bind(socket, ai->ai_addr, (int)ai->ai_addrlen) == 0 && listen(socket, SOMAXCONN) == 0;
+        }
+        else {
+            ok = connect(socket, ai->ai_addr, (int)ai->ai_addrlen) == 0;
+            if (ok) setNoDelay(socket);
+        }
+        if (!ok) {
+            closeNative(socket);
+            socket = NativeInvalid;
+        }
+    }
+    freeaddrinfo(results);
+    if (socket == NativeInvalid) error = (listening ? "cannot listen on " : "cannot connect to ") + address;
+    return wrap(socket);
+}
+
+IngestSocket::Handle IngestSocket::listenOn(const std::string& address, std::string& error) {
+    if (!isUnixAddress(address)) return openTcp(address, true, error);
+#ifdef _WIN32
+    error = "unix sockets are not supported on this platform";
+    return Invalid;
+#else
+    sockaddr_un sa;
+    if (!unixAddress(address, sa, error)) return Invalid;
+    unlink(sa.sun_path); // left behind by a previous run
+    NativeSocket socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket == NativeInvalid) {
+        error = "socket() failed";
+        return Invalid;
+    }
+    // Owner only, set before listen() so no other user can ever connect
+    if (bind(socket, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0 || chmod(sa.sun_path, 0600) != 0 ||
+        listen(socket, SOMAXCONN) != 0) {
+        closeNative(socket);
+        error = "cannot listen on " + address;
+        return Invalid;
+    }
+    return wrap(socket);
+#endif
+}
+
+IngestSocket::Handle IngestSocket::connectTo(const std::string& address, std::string& error) {
+    if (!isUnixAddress(address)) return openTcp(address, false, error);
+#ifdef _WIN32
+    error = "unix sockets are not supported on this platform";
+    return Invalid;
+#else
+    sockaddr_un sa;
+    if (!unixAddress(address, sa, error)) return Invalid;
+    NativeSocket socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket == NativeInvalid) {
+        error = "socket() failed";
+        return Invalid;
+    }
+    if (connect(socket, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+        closeNative(socket);
+        error = "cannot connect to " + address;
+        return Invalid;
+    }
+    return wrap(socket);
+#endif
+}
+
+IngestSocket::Handle IngestSocket::acceptFrom(Handle listener) {
+    for (;;) {
+        NativeSocket socket = accept(native(listener), nullptr, nullptr);
+#ifndef _WIN32
+        if (socket == NativeInvalid && errno == EINTR) continue;
+#endif
+        if (socket != NativeInvalid) setNoDelay(socket); // fails harmlessly on Unix sockets
+        return wrap(socket);
+    }
+}
+
+bool IngestSocket::sendAll(Handle socket, const char* data, size_t size) {
+    while (size > 0) {
+        int chunk = size > (1u << 30) ? (1 << 30) : (int)size;
+#ifdef _WIN32
+        int sent = send(native(socket), data, chunk, 0);
+#else
+        long sent = ::send(native(socket), data, (size_t)chunk, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+#endif
+        if (sent <= 0) return false;
+        data += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+long IngestSocket::receive(Handle socket, char* buffer, size_t size) {
+    int chunk = size > (1u << 30) ? (1 << 30) : (int)size;
+    for (;;) {
+#ifdef _WIN32
+        int got = recv(native(socket), buffer, chunk, 0);
+        return got < 0 ? -1 : got;
+#else
+        long got = ::recv(native(socket), buffer, (size_t)chunk, 0);
+        if (got < 0 && errno == EINTR) continue;
+        return got < 0 ? -1 : got;
+#endif
+    }
+}
+
+void IngestSocket::shutdown(Handle socket) {
+    if (socket == Invalid) return;
+#ifdef _WIN32
+    ::shutdown(native(socket), SD_RECEIVE);
+#else
+    ::shutdown(native(socket), SHUT_RD);
+#endif
+}
+
+void IngestSocket::close(Handle socket) {
+    if (socket != Invalid) closeNative(native(socket));
+}
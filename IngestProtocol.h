@@ -0,0 +1,70 @@
+#pragma once
+#ifndef INGEST_PROTOCOL_H
+#define INGEST_PROTOCOL_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Wire format between agents (BanSniffer push) and the ingestion server
+// (BanSniffer serve). Stream socket, integers little-endian:
+//
+//   request  u32 length of the rest, u16 machine id length, machine id,
+//            encoded SerialSnapshot
+//   reply    u8 IngestStatus per request, in request order
+//
+// Requests may be pipelined; a reply is sent once the request's batch has
+// been written to the store.
+namespace IngestProtocol {
+    const size_t LengthSize = 4;
+    const size_t KeyLengthSize = 2;
+    const uint32_t MaxFrameSize = 1u << 20;
+
+    // Appends one request to out. False, with out untouched, if the machine
+    // id is empty or longer than its u16 length field, or the frame would
+    // exceed MaxFrameSize.
+    bool appendFrame(std::string& out, std::string_view machineId, std::string_view snapshot);
+
+    enum ParseResult { Complete, NeedMore, Malformed };
+
+    // Parses one request from the front of data. On Complete, consumed is
+    // the frame's total size and the views point into data.
+    ParseResult parseFrame(const char* data, size_t size, size_t& consumed,
+        std::string_view& machineId, std::string_view& snapshot);
+}
+
+enum IngestStatus : unsigned char {
+    IngestUnchanged = 0,
+    IngestChanged = 1,
+    IngestNew = 2,      // no previous snapshot for this machine
+    IngestRejected = 3, // not a well-formed snapshot
+    IngestFailed = 4    // well-formed, but the store couldn't write it
+};
+
+const char* ingestStatusName(IngestStatus status);
+
+// Minimal blocking sockets over BSD sockets or Winsock. Addresses are
+// "host:port" for TCP or "unix:/path" for a Unix domain socket (not on
+// Windows). The protocol has no authentication, so listenOn only accepts
+// loopback TCP addresses, and Unix sockets are created owner-only.
+namespace IngestSocket {
+    typedef intptr_t Handle;
+    const Handle Invalid = -1;
+
+    bool startup();
+    Handle listenOn(const std::string& address, std::string& error);
+    Handle connectTo(const std::string& address, std::string& error);
+    Handle acceptFrom(Handle listener);
+
+    bool sendAll(Handle socket, const char* data, size_t size);
+    // Bytes read, 0 on orderly close, -1 on error
+    long receive(Handle socket, char* buffer, size_t size);
+
+    // Stops receiving, which wakes a thread blocked in receive (or, on
+    // Linux, accept); replies can still be sent
+    void shutdown(Handle socket);
+    void close(Handle socket);
+}
+
+#endif // INGEST_PROTOCOL_H
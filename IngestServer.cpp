@@ -0,0 +1,463 @@
+// ingestserver.cpp
+
+#include "IngestServer.h"
+#include "NdjsonWriter.h"
+#include "SerialDiff.h"
+#include "SerialNormalize.h"
+#include <deque>
+#include <unordered_map>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+static const size_t ReadBufferSize = 64 * 1024;
+static const size_t DiffQueueCapacity = 64 * 1024;
+static const size_t DiffBatch = 64;
+
+struct IngestServer::Connection {
+    IngestSocket::Handle socket;
+    std::atomic<bool> finished;
+
+    explicit Connection(IngestSocket::Handle socket) : socket(socket), finished(false) {}
+    // Last owner is either the reader or the batch holding its unacked requests
+    ~Connection() { IngestSocket::close(socket); }
+};
+
+struct IngestServer::Pending {
+    std::shared_ptr<Connection> connection;
+    std::string machineId;
+    std::string snapshot;
+    bool valid;
+    IngestStatus status;
+};
+
+struct IngestServer::DiffJob {
+    std::string machineId;
+    std::string previous;
+    std::string current;
+};
+
+// The server never trusts what an agent says about its own snapshot: the
+// fingerprint decides whether a push is stored, diffed and indexed, so one
+// that doesn't hash the values it travels with is rejected. Accepted pushes
+// are normalized (the index and compare see the same spellings whatever the
+// agent's version) and re-encoded with a fingerprint computed here. Runs on
+// the connection's reader thread, off the commit path.
+static bool canonicalSnapshot(std::string_view wire, SystemSerials& scratch, std::string& out) {
+    SnapshotView view;
+    if (!view.attach(wire.data(), wire.size())) return false;
+    view.toSerials(scratch);
+
+    // Checked against the values as sent, so agents that predate
+    // normalization still verify; version 1 snapshots carry nothing to check
+    SerialFingerprint sent;
+    if (view.fingerprint(sent)) {
+        SerialFingerprint actual = fingerprintSerials(scratch);
+        if (sent.root != actual.root) return false;
+        for (size_t i = 0; i < 5; i++) {
+            if (sent.components[i] != actual.components[i]) return false;
+        }
+    }
+    else if (view.version() >= 2) {
+        return false; // stripped or truncated fingerprint
+    }
+    normalizeSerials(scratch);
+    out = SerialSnapshot::encode(scratch);
+    return true;
+}
+
+// Bounded multi-producer queue. Consumers take everything available up to a
+// limit, which is what turns a burst of pushes into one group commit.
+template <typename T>
+class IngestServer::Queue {
+public:
+    explicit Queue(size_t capacity) : capacity(capacity), closed(false) {}
+
+    // Moves every item in (clearing items), waiting while the queue is full
+    void push(std::vector<T>& items) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return closed || queue.size() < capacity; });
+        for (auto& item : items) queue.push_back(std::move(item));
+        items.clear();
+        notEmpty.notify_all();
+    }
+
+    // Waits for at least one item, then appends up to max to out. False once
+    // the queue is closed and drained.
+    bool pop(std::vector<T>& out, size_t max) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return closed || !queue.empty(); });
+        if (queue.empty()) return false;
+        while (!queue.empty() && out.size() < max) {
+            out.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        notFull.notify_all();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> queue;
+    size_t capacity;
+    bool closed;
+};
+
+IngestServer::IngestServer()
+    : listener(IngestSocket::Invalid), stopping(false), running(false), received(0), added(0),
+    changed(0), unchanged(0), rejected(0), failed(0), batches(0), shared(0) {
+}
+
+IngestServer::~IngestServer() {
+    stop();
+}
+
+bool IngestServer::start(const IngestOptions& opts, std::string& error) {
+    if (running) {
+        error = "already running";
+        return false;
+    }
+    options = opts;
+    if (options.maxBatch == 0) options.maxBatch = 1;
+    if (options.workers == 0) options.workers = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    if (!IngestSocket::startup()) {
+        error = "socket startup failed";
+        return false;
+    }
+    if (!store.open(options.storePath)) {
+        error = "cannot open store " + options.storePath;
+        return false;
+    }
+    listener = IngestSocket::listenOn(options.listen, error);
+    if (listener == IngestSocket::Invalid) {
+        store.close();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(indexLock);
+        index.reset();
+        if (options.indexSerials) {
+            index.reset(new SerialIndex());
+            store.forEach([&](std::string_view machineId, const SnapshotView& snapshot) {
+                index->update(machineId, snapshot);
+            });
+        }
+    }
+
+    received = added = changed = unchanged = rejected = failed = batches = shared = 0;
+    stopping = false;
+    commitQueue.reset(new Queue<Pending>(options.maxBatch * 4));
+    diffQueue.reset(new Queue<DiffJob>(DiffQueueCapacity));
+    for (unsigned i = 0; i < options.workers; i++) workers.emplace_back(&IngestServer::diffLoop, this);
+    committerThread = std::thread(&IngestServer::commitLoop, this);
+    acceptThread = std::thread(&IngestServer::acceptLoop, this);
+
+    std::lock_guard<std::mutex> lock(stateLock);
+    running = true;
+    return true;
+}
+
+void IngestServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stateLock);
+        if (!running || stopping) return;
+        stopping = true;
+    }
+
+    // Winsock only wakes accept() when the socket is closed; Linux needs a
+    // shutdown, and closing under a blocked thread there is a race
+#ifdef _WIN32
+    IngestSocket::close(listener);
+    acceptThread.join();
+#else
+    IngestSocket::shutdown(listener);
+    acceptThread.join();
+    IngestSocket::close(listener);
+#endif
+    listener = IngestSocket::Invalid;
+
+    // Readers stop at their next receive; requests already queued are still
+    // committed and acked
+    {
+        std::lock_guard<std::mutex> lock(readersLock);
+        for (auto& reader : readers) IngestSocket::shutdown(reader.second->socket);
+    }
+    reapReaders(true);
+
+    commitQueue->close();
+    committerThread.join();
+    diffQueue->close();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+    store.close();
+
+    std::lock_guard<std::mutex> lock(stateLock);
+    running = false;
+    stateChanged.notify_all();
+}
+
+void IngestServer::wait() {
+    std::unique_lock<std::mutex> lock(stateLock);
+    stateChanged.wait(lock, [&] { return !running; });
+}
+
+IngestStats IngestServer::stats() const {
+    IngestStats s;
+    s.received = received;
+    s.added = added;
+    s.changed = changed;
+    s.unchanged = unchanged;
+    s.rejected = rejected;
+    s.failed = failed;
+    s.batches = batches;
+    s.shared = shared;
+    return s;
+}
+
+size_t IngestServer::machinesWith(SerialComponent component, std::string_view value, std::vector<std::string>& machines) const {
+    machines.clear();
+    std::lock_guard<std::mutex> lock(indexLock);
+    if (!index) return 0;
+    std::vector<SerialIndex::MachineId> ids;
+    index->machinesWith(component, value, ids);
+    for (SerialIndex::MachineId id : ids) machines.emplace_back(index->machineName(id));
+    return machines.size();
+}
+
+void IngestServer::reapReaders(bool all) {
+    std::lock_guard<std::mutex> lock(readersLock);
+    auto done = std::remove_if(readers.begin(), readers.end(), [&](std::pair<std::thread, std::shared_ptr<Connection>>& reader) {
+        if (!all && !reader.second->finished) return false;
+        reader.first.join();
+        return true;
+    });
+    readers.erase(done, readers.end());
+}
+
+void IngestServer::acceptLoop() {
+    while (!stopping) {
+        IngestSocket::Handle socket = IngestSocket::acceptFrom(listener);
+        if (socket == IngestSocket::Invalid) {
+            if (stopping) break;
+            // Out of descriptors or similar; back off instead of spinning
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        auto connection = std::make_shared<Connection>(socket);
+        reapReaders(false);
+        std::lock_guard<std::mutex> lock(readersLock);
+        if (stopping) break; // connection closes with the last reference
+        readers.emplace_back(std::thread(&IngestServer::readLoop, this, connection), connection);
+    }
+}
+
+void IngestServer::readLoop(std::shared_ptr<Connection> connection) {
+    std::vector<char> buffer(ReadBufferSize);
+    size_t used = 0;
+    std::vector<Pending> parsed;
+    SystemSerials scratch;
+    bool framingLost = false;
+
+    while (!framingLost) {
+        if (used == buffer.size()) buffer.resize(buffer.size() * 2); // a frame larger than the buffer
+        long got = IngestSocket::receive(connection->socket, buffer.data() + used, buffer.size() - used);
+        if (got <= 0) break;
+        used += (size_t)got;
+
+        // Every complete frame in the buffer goes to the committer in one push
+        size_t pos = 0;
+        for (;;) {
+            size_t consumed = 0;
+            std::string_view machineId;
+            std::string_view snapshot;
+            IngestProtocol::ParseResult result =
+                IngestProtocol::parseFrame(buffer.data() + pos, used - pos, consumed, machineId, snapshot);
+            if (result == IngestProtocol::NeedMore) break;
+            if (result == IngestProtocol::Malformed) {
+                framingLost = true; // no way to find the next frame boundary
+                break;
+            }
+
+            Pending pending;
+            pending.connection = connection;
+            pending.machineId.assign(machineId.data(), machineId.size());
+            pending.valid = canonicalSnapshot(snapshot, scratch, pending.snapshot);
+            pending.status = IngestRejected;
+            parsed.push_back(std::move(pending));
+            pos += consumed;
+        }
+        if (pos > 0) {
+            memmove(buffer.data(), buffer.data() + pos, used - pos);
+            used -= pos;
+        }
+        if (!parsed.empty()) commitQueue->push(parsed);
+    }
+    connection->finished = true;
+}
+
+void IngestServer::commitLoop() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastIndexFlush = Clock::now();
+    NdjsonWriter sharedOut(options.diffOut);
+    std::vector<Pending> batch;
+    batch.reserve(options.maxBatch);
+    while (commitQueue->pop(batch, options.maxBatch)) {
+        commitBatch(batch, sharedOut);
+        batch.clear();
+        if (options.diffOut) sharedOut.flush();
+
+        if (Clock::now() - lastIndexFlush >= std::chrono::milliseconds(options.indexFlushMs)) {
+            store.flush();
+            lastIndexFlush = Clock::now();
+        }
+    }
+}
+
+void IngestServer::commitBatch(std::vector<Pending>& batch, NdjsonWriter& sharedOut) {
+    // Classify everything first: lookups only remap the store when they
+    // reach records appended since the last one, so doing them before this
+    // batch's appends keeps it to one remap per batch. A machine pushing
+    // twice in one batch is compared against its own earlier push.
+    std::unordered_map<std::string_view, const Pending*> latest;
+    std::vector<std::pair<size_t, std::string>> changedItems; // batch index, previous snapshot
+    for (size_t i = 0; i < batch.size(); i++) {
+        Pending& item = batch[i];
+        if (!item.valid) continue;
+
+        SnapshotView current;
+        current.attach(item.snapshot.data(), item.snapshot.size());
+        SnapshotView previous;
+        auto found = latest.find(item.machineId);
+        bool known = found != latest.end()
+            ? previous.attach(found->second->snapshot.data(), found->second->snapshot.size())
+            : store.lookup(item.machineId, previous);
+
+        if (!known) {
+            item.status = IngestNew;
+        }
+        else if (compareSnapshots(current, previous).any()) {
+            item.status = IngestChanged;
+            changedItems.emplace_back(i, std::string(previous.bytes()));
+        }
+        else {
+            item.status = IngestUnchanged;
+            continue; // the stored record already says the same thing
+        }
+        latest[item.machineId] = &item;
+    }
+
+    // One append per stored snapshot, one flush for the batch
+    bool stored = true;
+    size_t storedCount = 0;
+    for (const auto& item : batch) {
+        if (item.status != IngestNew && item.status != IngestChanged) continue;
+        stored = store.upsertEncoded(item.machineId, item.snapshot) && stored;
+        storedCount++;
+    }
+    if (storedCount > 0 && !store.flushRecords()) stored = false;
+
+    uint64_t counts[5] = {};
+    std::unordered_map<Connection*, std::string> replies;
+    for (auto& item : batch) {
+        if (!stored && (item.status == IngestNew || item.status == IngestChanged)) item.status = IngestFailed;
+        counts[item.status]++;
+        replies[item.connection.get()] += (char)item.status;
+    }
+    for (const auto& reply : replies) {
+        // A client that went away just misses its acks
+        IngestSocket::sendAll(reply.first->socket, reply.second.data(), reply.second.size());
+    }
+
+    received += batch.size();
+    unchanged += counts[IngestUnchanged];
+    changed += counts[IngestChanged];
+    added += counts[IngestNew];
+    rejected += counts[IngestRejected];
+    failed += counts[IngestFailed];
+    batches++;
+
+    if (!stored) return;
+    indexBatch(batch, sharedOut);
+    if (changedItems.empty()) return;
+    std::vector<DiffJob> jobs;
+    jobs.reserve(changedItems.size());
+    for (auto& changedItem : changedItems) {
+        Pending& item = batch[changedItem.first];
+        jobs.push_back(DiffJob{ std::move(item.machineId), std::move(changedItem.second), std::move(item.snapshot) });
+    }
+    diffQueue->push(jobs);
+}
+
+void IngestServer::indexBatch(const std::vector<Pending>& batch, NdjsonWriter& sharedOut) {
+    std::lock_guard<std::mutex> lock(indexLock);
+    if (!index) return;
+    for (const auto& item : batch) {
+        if (item.status != IngestNew && item.status != IngestChanged) continue;
+        SnapshotView snapshot;
+        snapshot.attach(item.snapshot.data(), item.snapshot.size());
+        index->update(item.machineId, snapshot, [&](SerialComponent component, std::string_view value, size_t count) {
+            shared++;
+            if (!options.diffOut) return;
+            sharedOut.beginRecord();
+            sharedOut.field("type", "shared");
+            sharedOut.field("machine", item.machineId);
+            sharedOut.field("component", componentName(component));
+            sharedOut.field("value", value);
+            sharedOut.field("machines", (long long)count);
+            sharedOut.endRecord();
+        });
+    }
+}
+
+void IngestServer::diffLoop() {
+    // Each worker buffers whole records and writes them in one call, so
+    // workers sharing the output never interleave within a line
+    NdjsonWriter out(options.diffOut);
+    std::vector<DiffJob> jobs;
+    while (diffQueue->pop(jobs, DiffBatch)) {
+        for (const auto& job : jobs) {
+            SnapshotView current;
+            SnapshotView previous;
+            if (!current.attach(job.current.data(), job.current.size()) ||
+                !previous.attach(job.previous.data(), job.previous.size()))
+                continue;
+
+            SerialDiff diff = diffSerials(current, previous);
+            if (!options.diffOut) continue;
+
+            out.beginRecord();
+            out.field("type", "diff");
+            out.field("machine", job.machineId);
+            out.field("timestamp", current.timestamp());
+            out.field("baselineTimestamp", previous.timestamp());
+            out.key("changes");
+            out.beginArray();
+            for (const auto& change : diff.changes) {
+                if (change.kind == ChangeKind::Unchanged || change.kind == ChangeKind::Stale) continue;
+                out.beginObject();
+                out.field("component", componentName(change.component));
+                out.field("kind", changeKindName(change.kind));
+                out.field("label", change.label);
+                out.field("old", change.oldValue);
+                out.field("new", change.newValue);
+                out.endObject();
+            }
+            out.endArray();
+            out.endRecord();
+        }
+        jobs.clear();
+        if (options.diffOut) out.flush();
+    }
+}
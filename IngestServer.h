@@ -0,0 +1,125 @@
+#pragma once
+#ifndef INGEST_SERVER_H
+#define INGEST_SERVER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include "IngestProtocol.h"
+#include "BaselineStore.h"
+#include "SerialIndex.h"
+
+class NdjsonWriter;
+
+struct IngestOptions {
+    std::string listen;        // "host:port" or "unix:/path"
+    std::string storePath;     // BaselineStore path
+    unsigned workers;          // diff threads, 0 = hardware concurrency
+    size_t maxBatch;           // snapshots per group commit
+    unsigned indexFlushMs;     // how often the store's index is rewritten
+    FILE* diffOut;             // NDJSON "diff" and "shared" records, null = don't print
+    bool indexSerials;         // keep a SerialIndex of the fleet's values
+
+    IngestOptions() : workers(0), maxBatch(4096), indexFlushMs(5000), diffOut(stdout), indexSerials(true) {}
+};
+
+struct IngestStats {
+    uint64_t received;
+    uint64_t added;
+    uint64_t changed;
+    uint64_t unchanged;
+    uint64_t rejected;
+    uint64_t failed;
+    uint64_t batches;
+    uint64_t shared;    // values a stored snapshot shares with other machines
+};
+
+// Fleet ingestion endpoint (BanSniffer serve). Agents push snapshots over
+// IngestProtocol; every machine's latest snapshot lives in a BaselineStore.
+//
+//   connection threads  one per socket, parse and validate frames
+//   committer           drains whatever has queued up as one batch: looks
+//                       up each machine's previous snapshot, classifies it,
+//                       appends the new and changed ones and flushes once,
+//                       then acks every request in the batch
+//   diff workers        diffSerials for each changed machine, one NDJSON
+//                       record per diff
+//
+// With indexSerials the committer also keeps a SerialIndex over every
+// machine's latest snapshot, loaded from the store on start and updated
+// for each stored snapshot. A stored value that other machines already
+// report is printed as a "shared" record.
+//
+// Batches grow with load, so a busy server pays one write and one flush for
+// thousands of snapshots while a quiet one still acks each push at once.
+// Unchanged snapshots are acked but not rewritten.
+class IngestServer {
+public:
+    IngestServer();
+    ~IngestServer();
+
+    IngestServer(const IngestServer&) = delete;
+    IngestServer& operator=(const IngestServer&) = delete;
+
+    bool start(const IngestOptions& options, std::string& error);
+
+    // Stops accepting, drains queued snapshots and diffs, flushes the store
+    void stop();
+
+    // Blocks until stop() is called from another thread
+    void wait();
+
+    IngestStats stats() const;
+
+    // Names of the machines whose latest snapshot reports value; empty
+    // without indexSerials
+    size_t machinesWith(SerialComponent component, std::string_view value, std::vector<std::string>& machines) const;
+
+private:
+    struct Connection;
+    struct Pending;
+    struct DiffJob;
+    template <typename T> class Queue;
+
+    IngestOptions options;
+    BaselineStore store;
+    std::unique_ptr<SerialIndex> index;
+    mutable std::mutex indexLock;
+    IngestSocket::Handle listener;
+    std::unique_ptr<Queue<Pending>> commitQueue;
+    std::unique_ptr<Queue<DiffJob>> diffQueue;
+    std::thread acceptThread;
+    std::thread committerThread;
+    std::vector<std::thread> workers;
+    std::mutex readersLock;
+    std::vector<std::pair<std::thread, std::shared_ptr<Connection>>> readers;
+    std::atomic<bool> stopping;
+    std::mutex stateLock;
+    std::condition_variable stateChanged;
+    bool running;
+
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> added;
+    std::atomic<uint64_t> changed;
+    std::atomic<uint64_t> unchanged;
+    std::atomic<uint64_t> rejected;
+    std::atomic<uint64_t> failed;
+    std::atomic<uint64_t> batches;
+    std::atomic<uint64_t> shared;
+
+    void acceptLoop();
+    void readLoop(std::shared_ptr<Connection> connection);
+    void commitLoop();
+    void commitBatch(std::vector<Pending>& batch, NdjsonWriter& sharedOut);
+    void indexBatch(const std::vector<Pending>& batch, NdjsonWriter& sharedOut);
+    void diffLoop();
+    void reapReaders(bool all);
+};
+
+#endif // INGEST_SERVER_H
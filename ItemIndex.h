@@ -0,0 +1,51 @@
+#pragma once
+#ifndef ITEM_INDEX_H
+#define ITEM_INDEX_H
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Hash index over one side's items (disk serials, MACs), so matching two
+// lists is linear instead of a nested loop. Duplicates are chained through
+// next[] so every occurrence can be claimed once; add in reverse order to
+// claim duplicates first-to-last. Keys are views into the indexed side and
+// must outlive the index.
+class ItemIndex {
+public:
+    explicit ItemIndex(size_t n) : next(n, -1), used(n, false) { heads.reserve(n); }
+
+    void add(std::string_view key, int i) {
+        auto it = heads.find(key);
+        if (it == heads.end()) {
+            heads.emplace(key, i);
+        }
+        else {
+            next[i] = it->second;
+            it->second = i;
+        }
+    }
+
+    // First unclaimed item with this key, or -1
+    int claim(std::string_view key) {
+        auto it = heads.find(key);
+        if (it == heads.end()) return -1;
+        for (int i = it->second; i >= 0; i = next[i]) {
+            if (!used[i]) {
+                used[i] = true;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    bool isUsed(int i) const { return used[i]; }
+    void markUsed(int i) { used[i] = true; }
+
+private:
+    std::unordered_map<std::string_view, int> heads;
+    std::vector<int> next;
+    std::vector<bool> used;
+};
+
+#endif // ITEM_INDEX_H
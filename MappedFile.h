@@ -0,0 +1,37 @@
+#pragma once
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file (CreateFileMapping on Windows,
+// mmap elsewhere). Move-only; the mapping is released on close() or destruction.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Fails for missing or empty files
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return view; }
+    size_t size() const { return length; }
+    bool isOpen() const { return view != nullptr; }
+
+private:
+    const char* view;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif // MAPPED_FILE_H
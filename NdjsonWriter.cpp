@@ -0,0 +1,115 @@
+// ndjsonwriter.cpp
+
+#include "NdjsonWriter.h"
+
+NdjsonWriter::NdjsonWriter(FILE* out, size_t flushThreshold)
+    : out(out), flushThreshold(flushThreshold), afterKey(false), failed(false) {
+    buffer.reserve(flushThreshold + 4096);
+}
+
+NdjsonWriter::~NdjsonWriter() {
+    flush();
+}
+
+void NdjsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (first.empty()) return;
+    if (!first.back()) buffer += ',';
+    first.back() = false;
+}
+
+void NdjsonWriter::beginRecord() {
+    first.clear();
+    afterKey = false;
+    beginObject();
+}
+
+void NdjsonWriter::endRecord() {
+    while (first.size() > 1) endObject(); // tolerate a missing close
+    endObject();
+    buffer += '\n';
+    if (buffer.size() >= flushThreshold) flush();
+}
+
+void NdjsonWriter::beginObject() {
+    separator();
+    buffer += '{';
+    first.push_back(true);
+}
+
+void NdjsonWriter::endObject() {
+    if (first.empty()) return;
+    buffer += '}';
+    first.pop_back();
+}
+
+void NdjsonWriter::beginArray() {
+    separator();
+    buffer += '[';
+    first.push_back(true);
+}
+
+void NdjsonWriter::endArray() {
+    if (first.empty()) return;
+    buffer += ']';
+    first.pop_back();
+}
+
+void NdjsonWriter::key(std::string_view name) {
+    separator();
+    appendEscaped(name);
+    buffer += ':';
+    afterKey = true;
+}
+
+void NdjsonWriter::value(std::string_view text) {
+    separator();
+    appendEscaped(text);
+}
+
+void NdjsonWriter::value(bool flag) {
+    separator();
+    buffer += flag ? "true" : "false";
+}
+
+void NdjsonWriter::value(long long number) {
+    separator();
+    buffer += std::to_string(number);
+}
+
+void NdjsonWriter::appendEscaped(std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    buffer += '"';
+    for (char ch : text) {
+        unsigned char c = (unsigned char)ch;
+        switch (c) {
+        case '"': buffer += "\\\""; break;
+        case '\\': buffer += "\\\\"; break;
+        case '\n': buffer += "\\n"; break;
+        case '\r': buffer += "\\r"; break;
+        case '\t': buffer += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                buffer += "\\u00";
+                buffer += hex[c >> 4];
+                buffer += hex[c & 15];
+            }
+            else {
+                buffer += ch;
+            }
+        }
+    }
+    buffer += '"';
+}
+
+bool NdjsonWriter::flush() {
+    if (!buffer.empty() && out) {
+        if (fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size()) failed = true;
+        buffer.clear();
+    }
+    if (out && fflush(out) != 0) failed = true;
+    return !failed;
+}
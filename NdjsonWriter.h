@@ -0,0 +1,55 @@
+#pragma once
+#ifndef NDJSON_WRITER_H
+#define NDJSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+
+// Newline-delimited JSON, one record per line. Everything is appended to a
+// single buffer and handed to the stream in large writes, so a run produces
+// a handful of syscalls no matter how many records it emits.
+class NdjsonWriter {
+public:
+    explicit NdjsonWriter(FILE* out, size_t flushThreshold = 64 * 1024);
+    ~NdjsonWriter();
+
+    NdjsonWriter(const NdjsonWriter&) = delete;
+    NdjsonWriter& operator=(const NdjsonWriter&) = delete;
+
+    void beginRecord();
+    void endRecord();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Object member name; the next value call supplies its value
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(bool flag);
+    void value(long long number);
+
+    // Shorthand for key() + value()
+    template <typename T>
+    void field(std::string_view name, const T& v) { key(name); value(v); }
+
+    bool flush();
+
+private:
+    FILE* out;
+    size_t flushThreshold;
+    std::string buffer;
+    std::vector<bool> first; // per open container: nothing written yet
+    bool afterKey;
+    bool failed;
+
+    void separator();
+    void appendEscaped(std::string_view text);
+};
+
+#endif // NDJSON_WRITER_H
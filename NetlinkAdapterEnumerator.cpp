@@ -0,0 +1,137 @@
+// netlinkadapterenumerator.cpp
+
+#ifdef __linux__
+
+#include "NetlinkAdapterEnumerator.h"
+#include "SerialFormat.h"
+#include "Trace.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// The kernel sizes dump datagrams to at most this much unless a single
+// link message is larger
+static const size_t InitialBufferSize = 32 * 1024;
+static const int MaxAttempts = 3;
+
+static void addLink(nlmsghdr* header, std::vector<AdapterInfo>& adapters, size_t& count) {
+    ifinfomsg* info = (ifinfomsg*)NLMSG_DATA(header);
+    const char* name = NULL;
+    size_t nameLength = 0;
+    const unsigned char* address = NULL;
+    size_t addressLength = 0;
+    int length = (int)IFLA_PAYLOAD(header);
+    for (rtattr* attr = IFLA_RTA(info); RTA_OK(attr, length); attr = RTA_NEXT(attr, length)) {
+        if (attr->rta_type == IFLA_IFNAME) {
+            name = (const char*)RTA_DATA(attr);
+            nameLength = strnlen(name, RTA_PAYLOAD(attr));
+        }
+        else if (attr->rta_type == IFLA_ADDRESS) {
+            address = (const unsigned char*)RTA_DATA(attr);
+            addressLength = RTA_PAYLOAD(attr);
+        }
+    }
+    if (!name || addressLength != 6) return;
+    static const unsigned char zero[6] = {};
+    if (memcmp(address, zero, 6) == 0) return; // loopback, tunnels
+
+    if (count == adapters.size()) adapters.emplace_back();
+    AdapterInfo& adapter = adapters[count++];
+    adapter.luid = (uint64_t)info->ifi_index;
+    adapter.index = (uint32_t)info->ifi_index;
+    adapter.name.assign(name, nameLength);
+    adapter.description.clear();
+    formatMac(address, 6, adapter.mac);
+}
+
+NetlinkAdapterEnumerator::NetlinkAdapterEnumerator() : fd(-1), sequence(0) {
+}
+
+NetlinkAdapterEnumerator::~NetlinkAdapterEnumerator() {
+    close();
+}
+
+bool NetlinkAdapterEnumerator::open() {
+    fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) return false;
+    // A reply that never comes fails the refresh instead of hanging it
+    timeval timeout = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return true;
+}
+
+void NetlinkAdapterEnumerator::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+NetlinkAdapterEnumerator::DumpResult NetlinkAdapterEnumerator::dump(std::vector<AdapterInfo>& adapters, size_t& count) {
+    struct {
+        nlmsghdr header;
+        ifinfomsg info;
+    } request;
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(ifinfomsg));
+    request.header.nlmsg_type = RTM_GETLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = ++sequence;
+    request.info.ifi_family = AF_UNSPEC;
+
+    sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd, &request, request.header.nlmsg_len, 0, (sockaddr*)&kernel, sizeof(kernel)) < 0) return DumpFailed;
+
+    DumpResult result = DumpOk;
+    count = 0;
+    for (;;) {
+        ssize_t got = recv(fd, buffer.data(), buffer.size(), MSG_TRUNC);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return DumpFailed;
+        }
+        if ((size_t)got > buffer.size()) {
+            // The rest of the datagram is lost, and with it maybe NLMSG_DONE;
+            // a fresh socket drops the remainder of this dump
+            buffer.resize((size_t)got);
+            close();
+            return DumpRetry;
+        }
+
+        int length = (int)got;
+        for (nlmsghdr* header = (nlmsghdr*)buffer.data(); NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+            if (header->nlmsg_seq != sequence) continue; // left over from an abandoned dump
+            if (header->nlmsg_flags & NLM_F_DUMP_INTR) result = DumpRetry;
+            if (header->nlmsg_type == NLMSG_DONE) return result;
+            if (header->nlmsg_type == NLMSG_ERROR) return DumpFailed;
+            if (header->nlmsg_type == RTM_NEWLINK) addLink(header, adapters, count);
+        }
+    }
+}
+
+bool NetlinkAdapterEnumerator::enumerate(std::vector<AdapterInfo>& adapters) {
+    TraceSpan span("Netlink Adapters");
+    if (buffer.size() < InitialBufferSize) buffer.resize(InitialBufferSize);
+
+    for (int attempt = 0; attempt < MaxAttempts; attempt++) {
+        if (fd < 0 && !open()) break;
+        size_t count = 0;
+        DumpResult result = dump(adapters, count);
+        if (result == DumpOk) {
+            finishAdapters(adapters, count);
+            return true;
+        }
+        if (result == DumpFailed) {
+            close();
+            break;
+        }
+    }
+    adapters.clear();
+    return false;
+}
+
+#endif // __linux__
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef NETLINK_ADAPTER_ENUMERATOR_H
+#define NETLINK_ADAPTER_ENUMERATOR_H
+
+#ifdef __linux__
+
+#include <vector>
+#include <cstdint>
+#include "AdapterEnumerator.h"
+
+// One RTM_GETLINK dump over a NETLINK_ROUTE socket kept open across
+// refreshes, instead of a readdir plus an open/read per interface under
+// /sys/class/net. Names and addresses come straight from the IFLA_IFNAME
+// and IFLA_ADDRESS attributes. A dump the kernel flags as interrupted (an
+// interface changed mid-dump) or a reply too large for the buffer is
+// repeated once the buffer has grown.
+class NetlinkAdapterEnumerator : public AdapterEnumerator {
+public:
+    NetlinkAdapterEnumerator();
+    ~NetlinkAdapterEnumerator();
+
+    NetlinkAdapterEnumerator(const NetlinkAdapterEnumerator&) = delete;
+    NetlinkAdapterEnumerator& operator=(const NetlinkAdapterEnumerator&) = delete;
+
+    bool enumerate(std::vector<AdapterInfo>& adapters) override;
+
+private:
+    enum DumpResult { DumpOk, DumpRetry, DumpFailed };
+
+    int fd;
+    uint32_t sequence;
+    std::vector<char> buffer; // grow-only
+
+    bool open();
+    void close();
+    DumpResult dump(std::vector<AdapterInfo>& adapters, size_t& count);
+};
+
+#endif // __linux__
+
+#endif // NETLINK_ADAPTER_ENUMERATOR_H
@@ -0,0 +1,250 @@
+// serialdiff.cpp
+
+#include "SerialDiff.h"
+#include "ItemIndex.h"
+#include <string_view>
+
+// Gives SystemSerials the same accessors as SnapshotView so one set of
+// diff routines serves both
+struct SerialsAccess {
+    const SystemSerials& s;
+
+    std::string_view cpuId() const { return s.cpuId; }
+    std::string_view motherboardSerial() const { return s.motherboardSerial; }
+    std::string_view biosSerial() const { return s.biosSerial; }
+    size_t diskCount() const { return s.diskSerials.size(); }
+    std::string_view disk(size_t i) const { return s.diskSerials[i]; }
+    size_t adapterCount() const { return s.networkAdapters.size(); }
+    std::string_view adapterName(size_t i) const { return s.networkAdapters[i].first; }
+    std::string_view adapterMac(size_t i) const { return s.networkAdapters[i].second; }
+
+    // Hashing costs as much as comparing, so only stored fingerprints are used
+    bool fingerprint(SerialFingerprint&) const { return false; }
+};
+
+static SerialChange makeChange(SerialComponent component, ChangeKind kind, const std::string& label,
+    std::string_view oldValue, std::string_view newValue, int currentIndex, int savedIndex) {
+    SerialChange change;
+    change.component = component;
+    change.kind = kind;
+    change.label = label;
+    change.oldValue.assign(oldValue);
+    change.newValue.assign(newValue);
+    change.currentIndex = currentIndex;
+    change.savedIndex = savedIndex;
+    return change;
+}
+
+static void diffScalar(SerialComponent component, const char* label, std::string_view current,
+    std::string_view saved, std::vector<SerialChange>& out) {
+    ChangeKind kind = current == saved ? ChangeKind::Unchanged : ChangeKind::Modified;
+    out.push_back(makeChange(component, kind, label, saved, current, 0, 0));
+}
+
+template <typename Source>
+static void diffDisksImpl(const Source& current, const Source& saved, std::vector<SerialChange>& out) {
+    ItemIndex savedIndex(saved.diskCount());
+    for (size_t j = saved.diskCount(); j-- > 0;) savedIndex.add(saved.disk(j), (int)j);
+
+    // Exact matches first, remember what didn't match
+    std::vector<int> unmatched;
+    std::vector<int> match(current.diskCount(), -1);
+    for (size_t i = 0; i < current.diskCount(); i++) {
+        match[i] = savedIndex.claim(current.disk(i));
+        if (match[i] < 0) unmatched.push_back((int)i);
+    }
+
+    // Leftover saved disks pair up with leftover current ones, in order
+    std::vector<int> leftover;
+    for (size_t j = 0; j < saved.diskCount(); j++) {
+        if (!savedIndex.isUsed((int)j)) leftover.push_back((int)j);
+    }
+    for (size_t k = 0; k < unmatched.size() && k < leftover.size(); k++)
+        match[unmatched[k]] = leftover[k];
+
+    for (size_t i = 0; i < current.diskCount(); i++) {
+        std::string label = "Disk " + std::to_string(i);
+        if (match[i] < 0) {
+            out.push_back(makeChange(SerialComponent::Disk, ChangeKind::Added, label,
+                std::string_view(), current.disk(i), (int)i, -1));
+        }
+        else {
+            std::string_view old = saved.disk((size_t)match[i]);
+            ChangeKind kind = old == current.disk(i) ? ChangeKind::Unchanged : ChangeKind::Modified;
+            out.push_back(makeChange(SerialComponent::Disk, kind, label, old, current.disk(i), (int)i, match[i]));
+        }
+    }
+    for (size_t k = unmatched.size(); k < leftover.size(); k++) {
+        int j = leftover[k];
+        out.push_back(makeChange(SerialComponent::Disk, ChangeKind::Removed, "Disk " + std::to_string(j),
+            saved.disk((size_t)j), std::string_view(), -1, j));
+    }
+}
+
+template <typename Source>
+static void diffAdaptersImpl(const Source& current, const Source& saved, std::vector<SerialChange>& out) {
+    size_t savedCount = saved.adapterCount();
+    ItemIndex byMac(savedCount);
+    for (size_t j = savedCount; j-- > 0;) byMac.add(saved.adapterMac(j), (int)j);
+
+    std::vector<int> match(current.adapterCount(), -1);
+    std::vector<int> unmatched;
+    for (size_t i = 0; i < current.adapterCount(); i++) {
+        match[i] = byMac.claim(current.adapterMac(i));
+        if (match[i] < 0) unmatched.push_back((int)i);
+    }
+
+    // Same adapter name with a new MAC is a modification, not add + remove
+    if (!unmatched.empty()) {
+        ItemIndex byName(savedCount);
+        for (size_t j = savedCount; j-- > 0;) {
+            byName.add(saved.adapterName(j), (int)j);
+            if (byMac.isUsed((int)j)) byName.markUsed((int)j);
+        }
+        for (int i : unmatched) {
+            match[i] = byName.claim(current.adapterName((size_t)i));
+            if (match[i] >= 0) byMac.markUsed(match[i]);
+        }
+    }
+
+    for (size_t i = 0; i < current.adapterCount(); i++) {
+        std::string label(current.adapterName(i));
+        if (match[i] < 0) {
+            out.push_back(makeChange(SerialComponent::NetworkAdapter, ChangeKind::Added, label,
+                std::string_view(), current.adapterMac(i), (int)i, -1));
+        }
+        else {
+            std::string_view old = saved.adapterMac((size_t)match[i]);
+            ChangeKind kind = old == current.adapterMac(i) ? ChangeKind::Unchanged : ChangeKind::Modified;
+            out.push_back(makeChange(SerialComponent::NetworkAdapter, kind, label, old,
+                current.adapterMac(i), (int)i, match[i]));
+        }
+    }
+    for (size_t j = 0; j < savedCount; j++) {
+        if (byMac.isUsed((int)j)) continue;
+        out.push_back(makeChange(SerialComponent::NetworkAdapter, ChangeKind::Removed,
+            std::string(saved.adapterName(j)), saved.adapterMac(j), std::string_view(), -1, (int)j));
+    }
+}
+
+// Rows for a list whose subtree hash matched: the same multiset on both
+// sides, so nothing needs matching
+template <typename Source>
+static void unchangedDisks(const Source& current, std::vector<SerialChange>& out) {
+    for (size_t i = 0; i < current.diskCount(); i++) {
+        out.push_back(makeChange(SerialComponent::Disk, ChangeKind::Unchanged, "Disk " + std::to_string(i),
+            current.disk(i), current.disk(i), (int)i, (int)i));
+    }
+}
+
+template <typename Source>
+static void unchangedAdapters(const Source& current, std::vector<SerialChange>& out) {
+    for (size_t i = 0; i < current.adapterCount(); i++) {
+        out.push_back(makeChange(SerialComponent::NetworkAdapter, ChangeKind::Unchanged,
+            std::string(current.adapterName(i)), current.adapterMac(i), current.adapterMac(i), (int)i, (int)i));
+    }
+}
+
+template <typename Source>
+static SerialDiff diffImpl(const Source& current, const Source& saved) {
+    SerialDiff diff;
+    diff.changes.reserve(3 + current.diskCount() + saved.diskCount() +
+        current.adapterCount() + saved.adapterCount());
+
+    unsigned walk = WatchAll;
+    SerialFingerprint a, b;
+    if (current.fingerprint(a) && saved.fingerprint(b)) walk = differingComponents(a, b);
+
+    diffScalar(SerialComponent::CpuId, "CPU ID", current.cpuId(), saved.cpuId(), diff.changes);
+    diffScalar(SerialComponent::MotherboardSerial, "Motherboard Serial",
+        current.motherboardSerial(), saved.motherboardSerial(), diff.changes);
+    diffScalar(SerialComponent::BiosSerial, "BIOS Serial", current.biosSerial(), saved.biosSerial(), diff.changes);
+    if (walk & WatchDisks) diffDisksImpl(current, saved, diff.changes);
+    else unchangedDisks(current, diff.changes);
+    if (walk & WatchAdapters) diffAdaptersImpl(current, saved, diff.changes);
+    else unchangedAdapters(current, diff.changes);
+    return diff;
+}
+
+SerialDiff diffSerials(const SystemSerials& current, const SystemSerials& saved) {
+    SerialDiff diff = diffImpl(SerialsAccess{ current }, SerialsAccess{ saved });
+    if (current.incomplete) {
+        for (auto& change : diff.changes) {
+            if (change.kind != ChangeKind::Unchanged && (current.incomplete & componentBit(change.component)))
+                change.kind = ChangeKind::Stale;
+        }
+    }
+    return diff;
+}
+
+SerialDiff diffSerials(const SnapshotView& current, const SnapshotView& saved) {
+    return diffImpl(current, saved);
+}
+
+void diffDisks(const SystemSerials& current, const SystemSerials& saved, std::vector<SerialChange>& out) {
+    diffDisksImpl(SerialsAccess{ current }, SerialsAccess{ saved }, out);
+}
+
+void diffAdapters(const SystemSerials& current, const SystemSerials& saved, std::vector<SerialChange>& out) {
+    diffAdaptersImpl(SerialsAccess{ current }, SerialsAccess{ saved }, out);
+}
+
+bool SerialDiff::hasChanges() const {
+    for (const auto& change : changes) {
+        if (change.kind != ChangeKind::Unchanged && change.kind != ChangeKind::Stale) return true;
+    }
+    return false;
+}
+
+std::map<std::string, bool> SerialDiff::summary() const {
+    std::map<std::string, bool> result;
+    result["CPU ID"] = false;
+    result["Motherboard Serial"] = false;
+    result["BIOS Serial"] = false;
+    result["Disk Serials"] = false;
+    result["Network Adapters"] = false;
+    for (const auto& change : changes) {
+        if (change.kind == ChangeKind::Unchanged || change.kind == ChangeKind::Stale) continue;
+        switch (change.component) {
+        case SerialComponent::CpuId: result["CPU ID"] = true; break;
+        case SerialComponent::MotherboardSerial: result["Motherboard Serial"] = true; break;
+        case SerialComponent::BiosSerial: result["BIOS Serial"] = true; break;
+        case SerialComponent::Disk: result["Disk Serials"] = true; break;
+        case SerialComponent::NetworkAdapter: result["Network Adapters"] = true; break;
+        }
+    }
+    return result;
+}
+
+const char* changeKindName(ChangeKind kind) {
+    switch (kind) {
+    case ChangeKind::Unchanged: return "unchanged";
+    case ChangeKind::Modified: return "modified";
+    case ChangeKind::Added: return "added";
+    case ChangeKind::Removed: return "removed";
+    case ChangeKind::Stale: return "stale";
+    }
+    return "unknown";
+}
+
+const char* componentName(SerialComponent component) {
+    switch (component) {
+    case SerialComponent::CpuId: return "cpu";
+    case SerialComponent::MotherboardSerial: return "motherboard";
+    case SerialComponent::BiosSerial: return "bios";
+    case SerialComponent::Disk: return "disk";
+    case SerialComponent::NetworkAdapter: return "adapter";
+    }
+    return "unknown";
+}
+
+unsigned componentBit(SerialComponent component) {
+    switch (component) {
+    case SerialComponent::CpuId: return WatchCpu;
+    case SerialComponent::MotherboardSerial: return WatchMotherboard;
+    case SerialComponent::BiosSerial: return WatchBios;
+    case SerialComponent::Disk: return WatchDisks;
+    case SerialComponent::NetworkAdapter: return WatchAdapters;
+    }
+    return 0;
+}
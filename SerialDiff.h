@@ -0,0 +1,70 @@
+#pragma once
+#ifndef SERIAL_DIFF_H
+#define SERIAL_DIFF_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "system_serials.hpp"
+#include "SerialSnapshot.h"
+
+enum class ChangeKind {
+    Unchanged,
+    Modified,
+    Added,
+    Removed,
+    Stale     // differs, but the current side missed its refresh deadline
+};
+
+enum class SerialComponent {
+    CpuId,
+    MotherboardSerial,
+    BiosSerial,
+    Disk,
+    NetworkAdapter
+};
+
+// One compared item. For disks and adapters, currentIndex/savedIndex point
+// at the item's position in each input (-1 when it only exists on one side).
+struct SerialChange {
+    SerialComponent component;
+    ChangeKind kind;
+    std::string label;
+    std::string oldValue;
+    std::string newValue;
+    int currentIndex;
+    int savedIndex;
+};
+
+struct SerialDiff {
+    std::vector<SerialChange> changes;
+
+    // Stale rows don't count as changes
+    bool hasChanges() const;
+
+    // Per-category flags in the old compareSerials shape
+    // ("CPU ID", "Motherboard Serial", "BIOS Serial", "Disk Serials", "Network Adapters")
+    std::map<std::string, bool> summary() const;
+};
+
+const char* changeKindName(ChangeKind kind);
+const char* componentName(SerialComponent component);
+unsigned componentBit(SerialComponent component); // WatchComponent bit
+
+// Disks are matched by serial and adapters by MAC through hash tables, so
+// the diff is linear in the number of items. Unmatched disks, and adapters
+// whose name survived but MAC didn't, pair up as Modified (old -> new);
+// whatever is left over is Added or Removed. Differences in components
+// flagged in current.incomplete are reported as Stale instead.
+//
+// For snapshots that carry fingerprints, disk and adapter lists whose
+// subtree hashes match skip the matching step; their rows pair items by
+// position (savedIndex == currentIndex) since the order isn't hashed.
+SerialDiff diffSerials(const SystemSerials& current, const SystemSerials& saved);
+SerialDiff diffSerials(const SnapshotView& current, const SnapshotView& saved);
+
+// Single-category variants, appended to out
+void diffDisks(const SystemSerials& current, const SystemSerials& saved, std::vector<SerialChange>& out);
+void diffAdapters(const SystemSerials& current, const SystemSerials& saved, std::vector<SerialChange>& out);
+
+#endif // SERIAL_DIFF_H
@@ -0,0 +1,161 @@
+// serialfingerprint.cpp
+
+#include "SerialFingerprint.h"
+#include "BinaryIO.h"
+
+// Per-component seeds so equal strings in different places hash apart
+enum : uint64_t {
+    CpuSeed = 0x43505549,
+    BoardSeed = 0x424f4152,
+    BiosSeed = 0x42494f53,
+    DiskSeed = 0x4449534b,
+    AdapterSeed = 0x41445054
+};
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+Hash128 hash128(std::string_view data, uint64_t seed) {
+    const uint64_t c1 = 0x87c37b91114253d5ull;
+    const uint64_t c2 = 0x4cf5ad432745937full;
+    const char* p = data.data();
+    const size_t len = data.size();
+    const size_t blocks = len / 16;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t k1 = getU64(p + i * 16);
+        uint64_t k2 = getU64(p + i * 16 + 8);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const unsigned char* tail = reinterpret_cast<const unsigned char*>(p + blocks * 16);
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (len & 15) {
+    case 15: k2 ^= (uint64_t)tail[14] << 48; // fall through
+    case 14: k2 ^= (uint64_t)tail[13] << 40; // fall through
+    case 13: k2 ^= (uint64_t)tail[12] << 32; // fall through
+    case 12: k2 ^= (uint64_t)tail[11] << 24; // fall through
+    case 11: k2 ^= (uint64_t)tail[10] << 16; // fall through
+    case 10: k2 ^= (uint64_t)tail[9] << 8;   // fall through
+    case 9:
+        k2 ^= (uint64_t)tail[8];
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        // fall through
+    case 8: k1 ^= (uint64_t)tail[7] << 56; // fall through
+    case 7: k1 ^= (uint64_t)tail[6] << 48; // fall through
+    case 6: k1 ^= (uint64_t)tail[5] << 40; // fall through
+    case 5: k1 ^= (uint64_t)tail[4] << 32; // fall through
+    case 4: k1 ^= (uint64_t)tail[3] << 24; // fall through
+    case 3: k1 ^= (uint64_t)tail[2] << 16; // fall through
+    case 2: k1 ^= (uint64_t)tail[1] << 8;  // fall through
+    case 1:
+        k1 ^= (uint64_t)tail[0];
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    return Hash128{ h1, h2 };
+}
+
+// Folds a multiset of leaves: the sum is order-independent and, unlike xor,
+// doesn't cancel duplicates. The count is mixed in with it.
+class LeafSum {
+public:
+    LeafSum() : lo(0), hi(0), count(0) {}
+
+    void add(const Hash128& leaf) {
+        lo += leaf.lo;
+        hi += leaf.hi;
+        count++;
+    }
+
+    Hash128 finish(uint64_t seed) const {
+        char buffer[24];
+        putU64(buffer, lo);
+        putU64(buffer + 8, hi);
+        putU64(buffer + 16, count);
+        return hash128(std::string_view(buffer, sizeof(buffer)), seed);
+    }
+
+private:
+    uint64_t lo;
+    uint64_t hi;
+    uint64_t count;
+};
+
+SerialFingerprint fingerprintSerials(const SystemSerials& serials) {
+    SerialFingerprint fp;
+    fp.components[0] = hash128(serials.cpuId, CpuSeed);
+    fp.components[1] = hash128(serials.motherboardSerial, BoardSeed);
+    fp.components[2] = hash128(serials.biosSerial, BiosSeed);
+
+    LeafSum disks;
+    for (const auto& disk : serials.diskSerials) disks.add(hash128(disk, DiskSeed));
+    fp.components[3] = disks.finish(DiskSeed);
+
+    // Name and MAC are chained so swapping MACs between adapters shows up
+    LeafSum adapters;
+    for (const auto& adapter : serials.networkAdapters)
+        adapters.add(hash128(adapter.second, hash128(adapter.first, AdapterSeed).lo));
+    fp.components[4] = adapters.finish(AdapterSeed);
+
+    char buffer[16 * 5];
+    for (int i = 0; i < 5; i++) {
+        putU64(buffer + i * 16, fp.components[i].lo);
+        putU64(buffer + i * 16 + 8, fp.components[i].hi);
+    }
+    fp.root = hash128(std::string_view(buffer, sizeof(buffer)));
+    return fp;
+}
+
+unsigned differingComponents(const SerialFingerprint& a, const SerialFingerprint& b) {
+    if (a.root == b.root) return 0;
+    unsigned differing = 0;
+    for (int i = 0; i < 5; i++) {
+        if (a.components[i] != b.components[i]) differing |= 1u << i;
+    }
+    return differing;
+}
+
+void SerialFingerprint::encode(char* out) const {
+    putU64(out, root.lo);
+    putU64(out + 8, root.hi);
+    for (int i = 0; i < 5; i++) {
+        putU64(out + 16 + i * 16, components[i].lo);
+        putU64(out + 24 + i * 16, components[i].hi);
+    }
+}
+
+bool SerialFingerprint::decode(std::string_view data) {
+    if (data.size() != EncodedSize) return false;
+    const char* p = data.data();
+    root = Hash128{ getU64(p), getU64(p + 8) };
+    for (int i = 0; i < 5; i++)
+        components[i] = Hash128{ getU64(p + 16 + i * 16), getU64(p + 24 + i * 16) };
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef SERIAL_FINGERPRINT_H
+#define SERIAL_FINGERPRINT_H
+
+#include <string_view>
+#include <cstdint>
+#include "system_serials.hpp"
+
+struct Hash128 {
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const Hash128& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+// MurmurHash3 x64_128
+Hash128 hash128(std::string_view data, uint64_t seed = 0);
+
+// Two-level Merkle tree over the identity-bearing fields. Leaves are one
+// hash per CPU ID, board serial, BIOS serial, disk and adapter (name + MAC);
+// disks and adapters are folded by summing their leaves, so the order the
+// OS enumerated them in doesn't matter. The root hashes the five component
+// hashes. The timestamp is not part of it.
+//
+// Equal roots mean equal serials (up to a 2^-128 collision); unequal roots
+// name the differing components, so a compare only walks those.
+struct SerialFingerprint {
+    Hash128 root;
+    Hash128 components[5]; // by WatchComponent bit position: CPU, board, BIOS, disks, adapters
+
+    static const size_t EncodedSize = 16 * 6;
+
+    // Little-endian: root, then the components in order
+    void encode(char* out) const;
+    bool decode(std::string_view data);
+};
+
+SerialFingerprint fingerprintSerials(const SystemSerials& serials);
+
+// WatchComponent bits whose subtrees differ; 0 when the roots match
+unsigned differingComponents(const SerialFingerprint& a, const SerialFingerprint& b);
+
+#endif // SERIAL_FINGERPRINT_H
@@ -0,0 +1,69 @@
+// serialformat.cpp
+
+#include "SerialFormat.h"
+
+static const char UpperHex[] = "0123456789ABCDEF";
+static const char LowerHex[] = "0123456789abcdef";
+
+std::string formatProcessorId(uint32_t edx, uint32_t eax) {
+    std::string out;
+    formatProcessorId(edx, eax, out);
+    return out;
+}
+
+void formatProcessorId(uint32_t edx, uint32_t eax, std::string& out) {
+    out.assign(16, '0');
+    for (int i = 0; i < 8; i++) {
+        out[7 - i] = UpperHex[(edx >> (4 * i)) & 15];
+        out[15 - i] = UpperHex[(eax >> (4 * i)) & 15];
+    }
+}
+
+std::string formatCpuRegisters(const int regs[4]) {
+    std::string out;
+    formatCpuRegisters(regs, out);
+    return out;
+}
+
+void formatCpuRegisters(const int regs[4], std::string& out) {
+    char buf[32];
+    size_t n = 0;
+    for (int r = 0; r < 4; r++) {
+        uint32_t value = (uint32_t)regs[r];
+        int shift = 28;
+        while (shift > 0 && ((value >> shift) & 15) == 0) shift -= 4; // no leading zeros
+        for (; shift >= 0; shift -= 4) buf[n++] = LowerHex[(value >> shift) & 15];
+    }
+    out.assign(buf, n);
+}
+
+std::string formatMac(const unsigned char* bytes, size_t length, bool uppercase) {
+    std::string out;
+    formatMac(bytes, length, out, uppercase);
+    return out;
+}
+
+void formatMac(const unsigned char* bytes, size_t length, std::string& out, bool uppercase) {
+    if (length == 0) {
+        out.clear();
+        return;
+    }
+    const char* digits = uppercase ? UpperHex : LowerHex;
+    out.assign(length * 3 - 1, '-');
+    for (size_t i = 0; i < length; i++) {
+        out[i * 3] = digits[bytes[i] >> 4];
+        out[i * 3 + 1] = digits[bytes[i] & 15];
+    }
+}
+
+void formatTimestamp(time_t when, std::string& out) {
+    struct tm local;
+#ifdef _WIN32
+    localtime_s(&local, &when);
+#else
+    localtime_r(&when, &local);
+#endif
+    char buf[80];
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%d %X", &local);
+    out.assign(buf, n);
+}
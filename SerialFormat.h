@@ -0,0 +1,32 @@
+#pragma once
+#ifndef SERIAL_FORMAT_H
+#define SERIAL_FORMAT_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+// Hex formatting shared by the collectors. Table driven rather than
+// iostream based: no locale, no stream state. The overloads taking out
+// overwrite it and don't allocate once it has the capacity, which is what
+// the collectors use on every refresh.
+
+// Win32_Processor.ProcessorId layout: CPUID leaf 1 EDX then EAX, 16 upper hex digits
+std::string formatProcessorId(uint32_t edx, uint32_t eax);
+void formatProcessorId(uint32_t edx, uint32_t eax, std::string& out);
+
+// getCPUID's historical format: the four leaf 0 registers in lower case
+// hex with no padding, exactly as std::hex printed them
+std::string formatCpuRegisters(const int regs[4]);
+void formatCpuRegisters(const int regs[4], std::string& out);
+
+// Hardware address as two hex digits per byte separated by '-'
+std::string formatMac(const unsigned char* bytes, size_t length, bool uppercase = true);
+
+void formatMac(const unsigned char* bytes, size_t length, std::string& out, bool uppercase = true);
+
+// Local time as "%Y-%m-%d %X", the SystemSerials::timestamp format
+void formatTimestamp(time_t when, std::string& out);
+
+#endif // SERIAL_FORMAT_H
@@ -0,0 +1,294 @@
+// serialindex.cpp
+
+#include "SerialIndex.h"
+#include "SerialNormalize.h"
+#include "BinaryIO.h"
+#include <algorithm>
+
+// Pending adds/removes a posting list holds before they are merged into
+// the encoded list
+static const size_t PendingLimit = 32;
+
+// Key tag per component; keys are tag + value
+static char componentTag(SerialComponent component) {
+    switch (component) {
+    case SerialComponent::CpuId: return 'C';
+    case SerialComponent::MotherboardSerial: return 'M';
+    case SerialComponent::BiosSerial: return 'B';
+    case SerialComponent::Disk: return 'D';
+    case SerialComponent::NetworkAdapter: return 'N';
+    }
+    return '?';
+}
+
+static SerialComponent tagComponent(char tag) {
+    switch (tag) {
+    case 'C': return SerialComponent::CpuId;
+    case 'M': return SerialComponent::MotherboardSerial;
+    case 'B': return SerialComponent::BiosSerial;
+    case 'D': return SerialComponent::Disk;
+    default: return SerialComponent::NetworkAdapter;
+    }
+}
+
+template <typename Visit>
+static void forEachValue(const SystemSerials& serials, Visit visit) {
+    visit(SerialComponent::CpuId, std::string_view(serials.cpuId));
+    visit(SerialComponent::MotherboardSerial, std::string_view(serials.motherboardSerial));
+    visit(SerialComponent::BiosSerial, std::string_view(serials.biosSerial));
+    for (const auto& disk : serials.diskSerials) visit(SerialComponent::Disk, std::string_view(disk));
+    for (const auto& adapter : serials.networkAdapters) visit(SerialComponent::NetworkAdapter, std::string_view(adapter.second));
+}
+
+template <typename Visit>
+static void forEachValue(const SnapshotView& snapshot, Visit visit) {
+    visit(SerialComponent::CpuId, snapshot.cpuId());
+    visit(SerialComponent::MotherboardSerial, snapshot.motherboardSerial());
+    visit(SerialComponent::BiosSerial, snapshot.biosSerial());
+    for (size_t i = 0; i < snapshot.diskCount(); i++) visit(SerialComponent::Disk, snapshot.disk(i));
+    for (size_t i = 0; i < snapshot.adapterCount(); i++) visit(SerialComponent::NetworkAdapter, snapshot.adapterMac(i));
+}
+
+// Ascending machine numbers: delta varints plus sorted pending buffers.
+// added never overlaps the encoded list, removed is always a subset of it.
+struct SerialIndex::PostingList {
+    std::string encoded;
+    uint32_t encodedCount;
+    MachineId last; // largest encoded value
+    std::vector<MachineId> added;
+    std::vector<MachineId> removed;
+
+    PostingList() : encodedCount(0), last(0) {}
+
+    void add(MachineId machine) {
+        auto gone = std::lower_bound(removed.begin(), removed.end(), machine);
+        if (gone != removed.end() && *gone == machine) {
+            removed.erase(gone);
+        }
+        else if (encodedCount == 0 || machine > last) {
+            putVarint(encoded, machine - last);
+            last = machine;
+            encodedCount++;
+        }
+        else {
+            added.insert(std::lower_bound(added.begin(), added.end(), machine), machine);
+            if (added.size() + removed.size() > PendingLimit) compact();
+        }
+    }
+
+    void remove(MachineId machine) {
+        auto pending = std::lower_bound(added.begin(), added.end(), machine);
+        if (pending != added.end() && *pending == machine) {
+            added.erase(pending);
+            return;
+        }
+        removed.insert(std::lower_bound(removed.begin(), removed.end(), machine), machine);
+        if (added.size() + removed.size() > PendingLimit) compact();
+    }
+
+    void decode(std::vector<MachineId>& out) const {
+        size_t pos = 0;
+        size_t a = 0;
+        size_t r = 0;
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < encodedCount; i++) {
+            uint64_t delta;
+            if (!getVarint(encoded.data(), encoded.size(), pos, delta)) break;
+            value += delta;
+            while (a < added.size() && added[a] < value) out.push_back(added[a++]);
+            if (r < removed.size() && removed[r] == value) {
+                r++;
+                continue;
+            }
+            out.push_back((MachineId)value);
+        }
+        while (a < added.size()) out.push_back(added[a++]);
+    }
+
+    void compact() {
+        std::vector<MachineId> all;
+        all.reserve(encodedCount + added.size());
+        decode(all);
+        encoded.clear();
+        encodedCount = 0;
+        last = 0;
+        added.clear();
+        removed.clear();
+        for (MachineId machine : all) {
+            putVarint(encoded, machine - last);
+            last = machine;
+        }
+        encodedCount = (uint32_t)all.size();
+        encoded.shrink_to_fit();
+    }
+
+    size_t memoryUsage() const {
+        return sizeof(PostingList) + encoded.capacity() + (added.capacity() + removed.capacity()) * sizeof(MachineId);
+    }
+};
+
+struct SerialIndex::Posting {
+    Posting() : count(0), single(0) {}
+
+    uint32_t count;
+    MachineId single;                  // the machine while count == 1 and list is null
+    std::unique_ptr<PostingList> list; // once a second machine joins
+};
+
+SerialIndex::SerialIndex() : postings(1), values(1), present(1, false), liveMachines(0) {
+}
+
+SerialIndex::~SerialIndex() {
+}
+
+// The same canonical form for indexed and queried values
+static void normalizeValue(SerialComponent component, std::string& value) {
+    if (component == SerialComponent::NetworkAdapter) normalizeMacInPlace(value);
+    else if (!value.empty()) value.resize(normalizeSerialInPlace(&value[0], value.size()));
+}
+
+// False for a value that normalizes to nothing
+bool SerialIndex::internKey(SerialComponent component, std::string_view value, StringPool::Id& key) {
+    valueBuffer.assign(value.data(), value.size());
+    normalizeValue(component, valueBuffer);
+    if (valueBuffer.empty()) return false;
+    keyBuffer.assign(1, componentTag(component));
+    keyBuffer.append(valueBuffer);
+    key = keys.intern(keyBuffer);
+    if (key >= postings.size()) postings.resize(key + 1);
+    return true;
+}
+
+bool SerialIndex::findKey(SerialComponent component, std::string_view value, StringPool::Id& key) const {
+    std::string normalized(value);
+    normalizeValue(component, normalized);
+    if (normalized.empty()) return false;
+    normalized.insert(normalized.begin(), componentTag(component));
+    return keys.find(normalized, key);
+}
+
+void SerialIndex::addPosting(StringPool::Id key, MachineId machine) {
+    Posting& posting = postings[key];
+    if (posting.count == 0) {
+        posting.single = machine;
+        posting.count = 1;
+        return;
+    }
+    if (!posting.list) {
+        posting.list.reset(new PostingList());
+        posting.list->add(posting.single);
+    }
+    posting.list->add(machine);
+    posting.count++;
+}
+
+void SerialIndex::removePosting(StringPool::Id key, MachineId machine) {
+    Posting& posting = postings[key];
+    if (posting.count == 0) return;
+    if (!posting.list) {
+        if (posting.single == machine) posting.count = 0;
+        return;
+    }
+    posting.list->remove(machine);
+    if (--posting.count == 0) posting.list.reset();
+}
+
+void SerialIndex::applyChanges(MachineId machine, std::vector<StringPool::Id>& next, const SharedHandler& onShared) {
+    std::sort(next.begin(), next.end());
+    next.erase(std::unique(next.begin(), next.end()), next.end());
+
+    // Merge walk over the old and new key sets; keys in both are untouched
+    const std::vector<StringPool::Id>& old = values[machine];
+    size_t i = 0;
+    size_t j = 0;
+    while (i < old.size() || j < next.size()) {
+        if (j == next.size() || (i < old.size() && old[i] < next[j])) {
+            removePosting(old[i++], machine);
+        }
+        else if (i == old.size() || next[j] < old[i]) {
+            StringPool::Id key = next[j++];
+            addPosting(key, machine);
+            if (onShared && postings[key].count > 1) {
+                std::string_view text = keys.get(key);
+                onShared(tagComponent(text[0]), text.substr(1), postings[key].count);
+            }
+        }
+        else {
+            i++;
+            j++;
+        }
+    }
+    values[machine].assign(next.begin(), next.end());
+}
+
+template <typename Source>
+SerialIndex::MachineId SerialIndex::updateImpl(std::string_view machine, const Source& source, const SharedHandler& onShared) {
+    MachineId id = machines.intern(machine);
+    if (id >= values.size()) {
+        values.resize(id + 1);
+        present.resize(id + 1, false);
+    }
+    if (!present[id]) {
+        present[id] = true;
+        liveMachines++;
+    }
+
+    scratch.clear();
+    forEachValue(source, [&](SerialComponent component, std::string_view value) {
+        StringPool::Id key;
+        if (internKey(component, value, key)) scratch.push_back(key);
+    });
+    applyChanges(id, scratch, onShared);
+    return id;
+}
+
+SerialIndex::MachineId SerialIndex::update(std::string_view machine, const SystemSerials& serials, const SharedHandler& onShared) {
+    return updateImpl(machine, serials, onShared);
+}
+
+SerialIndex::MachineId SerialIndex::update(std::string_view machine, const SnapshotView& snapshot, const SharedHandler& onShared) {
+    return updateImpl(machine, snapshot, onShared);
+}
+
+void SerialIndex::remove(std::string_view machine) {
+    MachineId id;
+    if (!machines.find(machine, id) || id >= present.size() || !present[id]) return;
+    for (StringPool::Id key : values[id]) removePosting(key, id);
+    std::vector<StringPool::Id>().swap(values[id]);
+    present[id] = false;
+    liveMachines--;
+}
+
+size_t SerialIndex::machinesWith(SerialComponent component, std::string_view value, std::vector<MachineId>& out) const {
+    out.clear();
+    StringPool::Id key;
+    if (!findKey(component, value, key)) return 0;
+    const Posting& posting = postings[key];
+    if (posting.list) posting.list->decode(out);
+    else if (posting.count == 1) out.push_back(posting.single);
+    return out.size();
+}
+
+size_t SerialIndex::countWith(SerialComponent component, std::string_view value) const {
+    StringPool::Id key;
+    return findKey(component, value, key) ? postings[key].count : 0;
+}
+
+void SerialIndex::forEachShared(size_t minMachines,
+    const std::function<void(SerialComponent component, std::string_view value, size_t count)>& visit) const {
+    for (StringPool::Id key = 1; key < postings.size(); key++) {
+        if (postings[key].count < minMachines || postings[key].count == 0) continue;
+        std::string_view text = keys.get(key);
+        visit(tagComponent(text[0]), text.substr(1), postings[key].count);
+    }
+}
+
+size_t SerialIndex::memoryUsage() const {
+    size_t bytes = keys.memoryUsage() + machines.memoryUsage() + postings.capacity() * sizeof(Posting) +
+        values.capacity() * sizeof(std::vector<StringPool::Id>) + present.capacity() / 8;
+    for (const auto& posting : postings) {
+        if (posting.list) bytes += posting.list->memoryUsage();
+    }
+    for (const auto& machineKeys : values) bytes += machineKeys.capacity() * sizeof(StringPool::Id);
+    return bytes;
+}
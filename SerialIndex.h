@@ -0,0 +1,88 @@
+#pragma once
+#ifndef SERIAL_INDEX_H
+#define SERIAL_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "system_serials.hpp"
+#include "SerialSnapshot.h"
+#include "SerialDiff.h"
+#include "StringPool.h"
+
+// Inverted index across a fleet: (component, value) -> machines reporting
+// it, for spotting serials that should be unique but aren't (spoofers,
+// "Default string" firmware, cloned disks, reused MACs). Indexes the CPU ID,
+// board and BIOS serials, every disk serial and every adapter MAC; empty
+// values are skipped.
+//
+// Keys are StringPool IDs of component tag + value, so a posting is found
+// with one hash probe. A value held by one machine stores it inline; larger
+// posting lists are ascending machine numbers as delta varints. Additions
+// above the list's maximum (new machines) append in place; anything else
+// lands in small sorted add/remove buffers that are merged into the encoded
+// list once they grow.
+//
+// update() replaces a machine's values and touches only the postings that
+// changed. Indexed and queried values are both normalized (SerialNormalize),
+// so a store holding spellings from older agents still answers lookups for
+// the canonical form. Not thread-safe.
+class SerialIndex {
+public:
+    typedef StringPool::Id MachineId; // dense, from 1
+
+    SerialIndex();
+    ~SerialIndex();
+
+    SerialIndex(const SerialIndex&) = delete;
+    SerialIndex& operator=(const SerialIndex&) = delete;
+
+    // Called for each value the update adds to a posting that already had
+    // other machines; count includes the updated machine
+    typedef std::function<void(SerialComponent component, std::string_view value, size_t count)> SharedHandler;
+
+    MachineId update(std::string_view machine, const SystemSerials& serials, const SharedHandler& onShared = nullptr);
+    MachineId update(std::string_view machine, const SnapshotView& snapshot, const SharedHandler& onShared = nullptr);
+    void remove(std::string_view machine);
+
+    // Machines reporting value, in ascending MachineId order
+    size_t machinesWith(SerialComponent component, std::string_view value, std::vector<MachineId>& out) const;
+    size_t countWith(SerialComponent component, std::string_view value) const;
+
+    std::string_view machineName(MachineId id) const { return machines.get(id); }
+    size_t machineCount() const { return liveMachines; }
+
+    // Every value reported by at least minMachines machines
+    void forEachShared(size_t minMachines,
+        const std::function<void(SerialComponent component, std::string_view value, size_t count)>& visit) const;
+
+    size_t memoryUsage() const;
+
+private:
+    struct PostingList;
+    struct Posting;
+
+    StringPool keys;     // component tag byte + value
+    StringPool machines; // machine names
+    std::vector<Posting> postings;                   // by key ID
+    std::vector<std::vector<StringPool::Id>> values; // by MachineId, sorted key IDs
+    std::vector<bool> present;                       // by MachineId
+    size_t liveMachines;
+    std::vector<StringPool::Id> scratch;
+    std::string keyBuffer;
+    std::string valueBuffer;
+
+    template <typename Source>
+    MachineId updateImpl(std::string_view machine, const Source& source, const SharedHandler& onShared);
+    bool internKey(SerialComponent component, std::string_view value, StringPool::Id& key);
+    bool findKey(SerialComponent component, std::string_view value, StringPool::Id& key) const;
+    void applyChanges(MachineId machine, std::vector<StringPool::Id>& next, const SharedHandler& onShared);
+    void addPosting(StringPool::Id key, MachineId machine);
+    void removePosting(StringPool::Id key, MachineId machine);
+};
+
+#endif // SERIAL_INDEX_H
@@ -0,0 +1,191 @@
+// serialnormalize.cpp
+
+#include "SerialNormalize.h"
+#include "SerialFormat.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SERIAL_NORMALIZE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ATA IDENTIFY serial: 20 bytes, 40 hex digits when a provider hex-encodes it
+static const size_t HexAtaSerialLength = 40;
+
+static inline bool isPad(unsigned char c) {
+    return c <= ' ';
+}
+
+static inline int hexValue(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+void foldUpperScalar(char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] >= 'a' && data[i] <= 'z') data[i] = (char)(data[i] - 0x20);
+    }
+}
+
+bool allHexDigitsScalar(const char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (hexValue((unsigned char)data[i]) < 0) return false;
+    }
+    return true;
+}
+
+#ifdef SERIAL_NORMALIZE_SSE2
+
+// Signed byte compares: bytes >= 0x80 are negative and fall outside every
+// ASCII range tested here, so UTF-8 passes through untouched
+void foldUpper(char* data, size_t length) {
+    const __m128i belowA = _mm_set1_epi8('a' - 1);
+    const __m128i aboveZ = _mm_set1_epi8('z' + 1);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, belowA), _mm_cmplt_epi8(v, aboveZ));
+        v = _mm_sub_epi8(v, _mm_and_si128(lower, caseBit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), v);
+    }
+    foldUpperScalar(data + i, length - i);
+}
+
+bool allHexDigits(const char* data, size_t length) {
+    const __m128i below0 = _mm_set1_epi8('0' - 1);
+    const __m128i above9 = _mm_set1_epi8('9' + 1);
+    const __m128i belowA = _mm_set1_epi8('a' - 1);
+    const __m128i aboveF = _mm_set1_epi8('f' + 1);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, below0), _mm_cmplt_epi8(v, above9));
+        __m128i folded = _mm_or_si128(v, caseBit);
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(folded, belowA), _mm_cmplt_epi8(folded, aboveF));
+        if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xFFFF) return false;
+    }
+    return allHexDigitsScalar(data + i, length - i);
+}
+
+#else
+
+void foldUpper(char* data, size_t length) {
+    foldUpperScalar(data, length);
+}
+
+bool allHexDigits(const char* data, size_t length) {
+    return allHexDigitsScalar(data, length);
+}
+
+#endif
+
+// Trims in place, returns the new length
+static size_t trim(char* data, size_t length, bool dropTrailingDots) {
+    size_t end = length;
+    while (end > 0 && (isPad((unsigned char)data[end - 1]) || (dropTrailingDots && data[end - 1] == '.'))) end--;
+    size_t start = 0;
+    while (start < end && isPad((unsigned char)data[start])) start++;
+    if (start > 0) memmove(data, data + start, end - start);
+    return end - start;
+}
+
+// Decodes a hex-encoded, byte-swapped ATA serial in place. Only taken when
+// every decoded byte is printable, which plain hex serials (NVMe EUIs,
+// numeric serials) essentially never are at this length.
+static size_t decodeSwappedHex(char* data, size_t length) {
+    if (length != HexAtaSerialLength || !allHexDigits(data, length)) return length;
+
+    char decoded[HexAtaSerialLength / 2];
+    bool alnum = false;
+    for (size_t i = 0; i < sizeof(decoded); i++) {
+        int c = hexValue((unsigned char)data[2 * i]) << 4 | hexValue((unsigned char)data[2 * i + 1]);
+        if (c < 0x20 || c > 0x7E) return length;
+        alnum |= (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+        decoded[i ^ 1] = (char)c; // ATA strings are big-endian words
+    }
+    if (!alnum) return length;
+    memcpy(data, decoded, sizeof(decoded));
+    return sizeof(decoded);
+}
+
+size_t normalizeSerialInPlace(char* data, size_t length) {
+    length = trim(data, length, true);
+    size_t decoded = decodeSwappedHex(data, length);
+    if (decoded != length) length = trim(data, decoded, true);
+    foldUpper(data, length);
+    return length;
+}
+
+std::string normalizeSerial(std::string_view raw) {
+    std::string out(raw);
+    if (!out.empty()) out.resize(normalizeSerialInPlace(&out[0], out.size()));
+    return out;
+}
+
+bool parseMac(std::string_view text, unsigned char* bytes, size_t capacity, size_t& length) {
+    length = 0;
+    size_t nibbles = 0;
+    bool lastWasSeparator = true; // no leading separator
+    for (unsigned char c : text) {
+        int v = hexValue(c);
+        if (v >= 0) {
+            if (nibbles % 2 == 0) {
+                if (length == capacity) return false;
+                bytes[length++] = (unsigned char)(v << 4);
+            }
+            else {
+                bytes[length - 1] |= (unsigned char)v;
+            }
+            nibbles++;
+            lastWasSeparator = false;
+        }
+        else if ((c == ':' || c == '-' || c == '.') && !lastWasSeparator && nibbles % 2 == 0) {
+            lastWasSeparator = true;
+        }
+        else {
+            return false;
+        }
+    }
+    return nibbles > 0 && nibbles % 2 == 0 && !lastWasSeparator;
+}
+
+void normalizeMacInPlace(std::string& value) {
+    std::string_view raw(value);
+    while (!raw.empty() && isPad((unsigned char)raw.back())) raw.remove_suffix(1);
+    while (!raw.empty() && isPad((unsigned char)raw.front())) raw.remove_prefix(1);
+
+    unsigned char bytes[8];
+    size_t length;
+    if (parseMac(raw, bytes, sizeof(bytes), length) && (length == 6 || length == 8)) {
+        formatMac(bytes, length, value); // bytes are parsed out before value is overwritten
+        return;
+    }
+    if (value.empty()) return;
+    value.resize(trim(&value[0], value.size(), false));
+    foldUpper(&value[0], value.size());
+}
+
+std::string normalizeMac(std::string_view raw) {
+    std::string out(raw);
+    normalizeMacInPlace(out);
+    return out;
+}
+
+static void normalizeInPlace(std::string& value) {
+    if (!value.empty()) value.resize(normalizeSerialInPlace(&value[0], value.size()));
+}
+
+void normalizeSerials(SystemSerials& serials) {
+    normalizeInPlace(serials.cpuId);
+    normalizeInPlace(serials.motherboardSerial);
+    normalizeInPlace(serials.biosSerial);
+    for (auto& disk : serials.diskSerials) normalizeInPlace(disk);
+    for (auto& adapter : serials.networkAdapters) {
+        if (!adapter.first.empty()) adapter.first.resize(trim(&adapter.first[0], adapter.first.size(), false));
+        normalizeMacInPlace(adapter.second);
+    }
+}
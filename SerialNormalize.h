@@ -0,0 +1,43 @@
+#pragma once
+#ifndef SERIAL_NORMALIZE_H
+#define SERIAL_NORMALIZE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include "system_serials.hpp"
+
+// Canonical forms, so the same hardware reads the same through every
+// collection path (WMI, IOCTL, sysfs) and old baselines don't diff against
+// new ones on formatting alone.
+//
+// Serials: leading/trailing whitespace and NULs trimmed, trailing '.'
+// padding from STORAGE_DEVICE_DESCRIPTOR dropped, upper case. A 40 digit
+// hex string that decodes to printable ASCII is the byte-swapped ATA
+// IDENTIFY field some WMI providers return; it is decoded and unswapped.
+//
+// MACs: any of "d8:44:89:9d:d0:08", "D844899DD008", "d844.899d.d008" become
+// "D8-44-89-9D-D0-08"; text that doesn't parse is only trimmed and folded.
+
+// Rewrites data in place and returns the new length (never longer)
+size_t normalizeSerialInPlace(char* data, size_t length);
+std::string normalizeSerial(std::string_view raw);
+
+// Accepts ':', '-', '.' or no separators; false unless every digit pairs up
+bool parseMac(std::string_view text, unsigned char* bytes, size_t capacity, size_t& length);
+std::string normalizeMac(std::string_view raw);
+void normalizeMacInPlace(std::string& value);
+
+// Every serial and MAC in place; adapter names are only trimmed. Values
+// only shrink, except a MAC that gains separators, so a refresh that
+// reuses last refresh's strings doesn't allocate here.
+void normalizeSerials(SystemSerials& serials);
+
+// The kernels, exposed so the bench can compare them against the scalar
+// versions. foldUpper/allHexDigits use SSE2 where the target has it.
+void foldUpper(char* data, size_t length);
+void foldUpperScalar(char* data, size_t length);
+bool allHexDigits(const char* data, size_t length);
+bool allHexDigitsScalar(const char* data, size_t length);
+
+#endif // SERIAL_NORMALIZE_H
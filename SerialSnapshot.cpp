@@ -0,0 +1,295 @@
+// serialsnapshot.cpp
+
+#include "SerialSnapshot.h"
+#include "BinaryIO.h"
+#include "SerialNormalize.h"
+#include "ItemIndex.h"
+#include <fstream>
+#include <cstring>
+
+static const char Magic[4] = { 'B', 'S', 'N', 'P' };
+
+std::string SerialSnapshot::encode(const SystemSerials& serials) {
+    char fingerprint[SerialFingerprint::EncodedSize];
+    fingerprintSerials(serials).encode(fingerprint);
+
+    std::string_view scalarValues[ScalarCount];
+    scalarValues[Timestamp] = serials.timestamp;
+    scalarValues[CpuId] = serials.cpuId;
+    scalarValues[MotherboardSerial] = serials.motherboardSerial;
+    scalarValues[BiosSerial] = serials.biosSerial;
+    scalarValues[Fingerprint] = std::string_view(fingerprint, sizeof(fingerprint));
+
+    uint32_t diskCount = (uint32_t)serials.diskSerials.size();
+    uint32_t adapterCount = (uint32_t)serials.networkAdapters.size();
+    uint32_t fieldCount = ScalarCount + diskCount + 2 * adapterCount;
+
+    // Size everything first so the output is built with one allocation
+    size_t total = HeaderSize + 4 * (size_t)fieldCount + 4 * (size_t)fieldCount;
+    for (auto value : scalarValues) total += value.size();
+    for (const auto& disk : serials.diskSerials) total += disk.size();
+    for (const auto& adapter : serials.networkAdapters) total += adapter.first.size() + adapter.second.size();
+
+    std::string out(total, '\0');
+    char* p = &out[0];
+
+    memcpy(p, Magic, 4);
+    putU16(p + 4, Version);
+    putU16(p + 6, (uint16_t)HeaderSize);
+    putU32(p + 8, (uint32_t)total);
+    putU32(p + 12, ScalarCount);
+    putU32(p + 16, diskCount);
+    putU32(p + 20, adapterCount);
+    putU32(p + 24, 0);
+    putU32(p + 28, 0);
+
+    char* table = p + HeaderSize;
+    size_t offset = HeaderSize + 4 * (size_t)fieldCount;
+    uint32_t index = 0;
+
+    auto writeField = [&](std::string_view value) {
+        putU32(table + 4 * index++, (uint32_t)offset);
+        putU32(p + offset, (uint32_t)value.size());
+        if (!value.empty()) memcpy(p + offset + 4, value.data(), value.size());
+        offset += 4 + value.size();
+    };
+
+    for (auto value : scalarValues) writeField(value);
+    for (const auto& disk : serials.diskSerials) writeField(disk);
+    for (const auto& adapter : serials.networkAdapters) {
+        writeField(adapter.first);
+        writeField(adapter.second);
+    }
+    return out;
+}
+
+bool SerialSnapshot::writeFile(const SystemSerials& serials, const std::string& filename) {
+    std::string encoded = encode(serials);
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(encoded.data(), (std::streamsize)encoded.size());
+    return file.good();
+}
+
+bool SnapshotView::looksLikeSnapshot(const char* data, size_t size) {
+    return data && size >= SerialSnapshot::HeaderSize && memcmp(data, Magic, 4) == 0;
+}
+
+bool SnapshotView::attach(const char* data, size_t size) {
+    *this = SnapshotView();
+    if (!looksLikeSnapshot(data, size)) return false;
+
+    uint16_t version = getU16(data + 4);
+    uint32_t headerSize = getU16(data + 6);
+    uint32_t fileSize = getU32(data + 8);
+    uint32_t scalarCount = getU32(data + 12);
+    uint32_t diskCount = getU32(data + 16);
+    uint32_t adapterCount = getU32(data + 20);
+
+    if (version == 0 || headerSize < SerialSnapshot::HeaderSize) return false;
+    if (fileSize > size) return false; // truncated
+
+    // Offset table must fit inside the file
+    uint64_t fieldCount = (uint64_t)scalarCount + diskCount + 2ull * adapterCount;
+    if (headerSize + 4 * fieldCount > fileSize) return false;
+
+    base = data;
+    length = fileSize;
+    scalars = scalarCount;
+    disks = diskCount;
+    adapters = adapterCount;
+    ver = version;
+    return true;
+}
+
+std::string_view SnapshotView::field(uint32_t index) const {
+    uint32_t headerSize = getU16(base + 6);
+    uint32_t offset = getU32(base + headerSize + 4 * (size_t)index);
+    if ((uint64_t)offset + 4 > length) return std::string_view();
+    uint32_t len = getU32(base + offset);
+    if ((uint64_t)offset + 4 + len > length) return std::string_view();
+    return std::string_view(base + offset + 4, len);
+}
+
+void SnapshotView::toSerials(SystemSerials& out) const {
+    out.timestamp.assign(timestamp());
+    out.cpuId.assign(cpuId());
+    out.motherboardSerial.assign(motherboardSerial());
+    out.biosSerial.assign(biosSerial());
+
+    out.diskSerials.resize(disks);
+    for (size_t i = 0; i < disks; i++) out.diskSerials[i].assign(disk(i));
+
+    out.networkAdapters.resize(adapters);
+    for (size_t i = 0; i < adapters; i++) {
+        out.networkAdapters[i].first.assign(adapterName(i));
+        out.networkAdapters[i].second.assign(adapterMac(i));
+    }
+}
+
+bool SnapshotFile::open(const std::string& filename) {
+    view = SnapshotView();
+    if (!file.open(filename)) return false;
+    if (!view.attach(file.data(), file.size())) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+SnapshotChanges compareSnapshots(const SnapshotView& current, const SnapshotView& saved) {
+    SnapshotChanges changes = {};
+
+    // Only differing subtrees are walked. They are still compared field by
+    // field: an adapter rename changes the hash but not the MAC comparison.
+    unsigned walk = WatchAll;
+    SerialFingerprint a, b;
+    if (current.fingerprint(a) && saved.fingerprint(b)) {
+        walk = differingComponents(a, b);
+        if (!walk) return changes;
+    }
+
+    if (walk & WatchCpu) changes.cpuId = current.cpuId() != saved.cpuId();
+    if (walk & WatchMotherboard) changes.motherboardSerial = current.motherboardSerial() != saved.motherboardSerial();
+    if (walk & WatchBios) changes.biosSerial = current.biosSerial() != saved.biosSerial();
+
+    // Order doesn't matter but multiplicity does: each saved disk can match
+    // one current disk only, so {A,A} against {A,B} is a change
+    if (walk & WatchDisks) {
+        changes.diskSerials = current.diskCount() != saved.diskCount();
+        if (!changes.diskSerials) {
+            ItemIndex savedDisks(saved.diskCount());
+            for (size_t j = saved.diskCount(); j-- > 0;) savedDisks.add(saved.disk(j), (int)j);
+            for (size_t i = 0; i < current.diskCount() && !changes.diskSerials; i++)
+                changes.diskSerials = savedDisks.claim(current.disk(i)) < 0;
+        }
+    }
+
+    // Adapters the same way, by MAC
+    if (walk & WatchAdapters) {
+        changes.networkAdapters = current.adapterCount() != saved.adapterCount();
+        if (!changes.networkAdapters) {
+            ItemIndex savedMacs(saved.adapterCount());
+            for (size_t j = saved.adapterCount(); j-- > 0;) savedMacs.add(saved.adapterMac(j), (int)j);
+            for (size_t i = 0; i < current.adapterCount() && !changes.networkAdapters; i++)
+                changes.networkAdapters = savedMacs.claim(current.adapterMac(i)) < 0;
+        }
+    }
+    return changes;
+}
+
+// Legacy SystemInfoChecker format: size_t length + bytes per field. size_t
+// was 8 bytes on x64 builds and 4 on Win32, so try both and only accept a
+// parse that consumes the file exactly.
+static bool loadLegacyBinary(const char* data, size_t size, size_t lengthWidth, SystemSerials& serials) {
+    size_t pos = 0;
+    auto readLength = [&](size_t& value) {
+        if (pos + lengthWidth > size) return false;
+        value = lengthWidth == 8 ? (size_t)getU64(data + pos) : (size_t)getU32(data + pos);
+        pos += lengthWidth;
+        return value <= size - pos;
+    };
+    auto readString = [&](std::string& value) {
+        size_t len;
+        if (!readLength(len) || len > size - pos) return false;
+        value.assign(data + pos, len);
+        pos += len;
+        return true;
+    };
+
+    SystemSerials parsed;
+    if (!readString(parsed.timestamp) || !readString(parsed.cpuId) ||
+        !readString(parsed.motherboardSerial) || !readString(parsed.biosSerial))
+        return false;
+
+    size_t count;
+    if (!readLength(count)) return false;
+    for (size_t i = 0; i < count; i++) {
+        std::string disk;
+        if (!readString(disk)) return false;
+        parsed.diskSerials.push_back(disk);
+    }
+
+    if (!readLength(count)) return false;
+    for (size_t i = 0; i < count; i++) {
+        std::string name, mac;
+        if (!readString(name) || !readString(mac)) return false;
+        parsed.networkAdapters.push_back(std::make_pair(name, mac));
+    }
+
+    if (pos != size) return false;
+    serials = parsed;
+    return true;
+}
+
+// Legacy SystemCheckerApp format: newline separated text
+static bool loadLegacyText(const char* data, size_t size, SystemSerials& serials) {
+    size_t pos = 0;
+    auto readLine = [&](std::string& line) {
+        if (pos >= size) return false;
+        const char* end = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+        size_t lineEnd = end ? (size_t)(end - data) : size;
+        size_t len = lineEnd - pos;
+        if (len > 0 && data[pos + len - 1] == '\r') len--;
+        line.assign(data + pos, len);
+        pos = end ? lineEnd + 1 : size;
+        return true;
+    };
+    auto readCount = [&](size_t& n) {
+        std::string line;
+        if (!readLine(line) || line.empty()) return false;
+        n = 0;
+        for (char c : line) {
+            if (c < '0' || c > '9') return false;
+            n = n * 10 + (size_t)(c - '0');
+        }
+        return n <= size; // can't have more lines than bytes
+    };
+
+    SystemSerials parsed;
+    if (!readLine(parsed.cpuId) || !readLine(parsed.biosSerial) || !readLine(parsed.motherboardSerial))
+        return false;
+
+    size_t n;
+    if (!readCount(n)) return false;
+    for (size_t i = 0; i < n; ++i) {
+        std::string d;
+        if (!readLine(d)) return false;
+        parsed.diskSerials.push_back(d);
+    }
+
+    if (!readCount(n)) return false;
+    for (size_t i = 0; i < n; ++i) {
+        std::string k, v;
+        if (!readLine(k)) return false;
+        readLine(v); // last MAC may be empty at EOF
+        parsed.networkAdapters.push_back(std::make_pair(k, v));
+    }
+
+    serials = parsed;
+    return true;
+}
+
+bool loadSerialsFile(const std::string& filename, SystemSerials& serials) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+
+    SnapshotView view;
+    bool loaded = false;
+    if (view.attach(file.data(), file.size())) {
+        view.toSerials(serials);
+        loaded = true;
+    }
+    else if (SnapshotView::looksLikeSnapshot(file.data(), file.size())) {
+        return false; // our format, but corrupt or truncated
+    }
+    else {
+        loaded = loadLegacyBinary(file.data(), file.size(), 8, serials) ||
+            loadLegacyBinary(file.data(), file.size(), 4, serials) ||
+            loadLegacyText(file.data(), file.size(), serials);
+    }
+
+    // Baselines saved before normalization compare like fresh collections
+    if (loaded) normalizeSerials(serials);
+    return loaded;
+}
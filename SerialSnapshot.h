@@ -0,0 +1,122 @@
+#pragma once
+#ifndef SERIAL_SNAPSHOT_H
+#define SERIAL_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include "system_serials.hpp"
+#include "SerialFingerprint.h"
+#include "MappedFile.h"
+
+// Versioned binary snapshot of SystemSerials. Replaces the old newline text
+// (system_serials.dat) and raw size_t (serials.dat) writers.
+//
+// Layout, all integers little-endian:
+//   header       magic "BSNP", u16 version, u16 headerSize, u32 fileSize,
+//                u32 scalarCount, u32 diskCount, u32 adapterCount, u32 reserved
+//   offset table u32 per field: scalarCount scalars, then diskCount disks,
+//                then adapterCount (name, MAC) pairs
+//   fields       u32 length + bytes, referenced by the offset table
+//
+// Readers use scalarCount from the header to find the lists, so newer
+// writers can append scalars without breaking older readers. Version 2
+// added the Fingerprint scalar (SerialFingerprint::encode, 96 bytes).
+namespace SerialSnapshot {
+    const uint16_t Version = 2;
+    const uint32_t HeaderSize = 32;
+
+    // Scalar slots in the offset table
+    enum Scalar : uint32_t {
+        Timestamp = 0,
+        CpuId = 1,
+        MotherboardSerial = 2,
+        BiosSerial = 3,
+        Fingerprint = 4,
+        ScalarCount = 5
+    };
+
+    std::string encode(const SystemSerials& serials);
+    bool writeFile(const SystemSerials& serials, const std::string& filename);
+}
+
+// Zero-copy, bounds-checked accessors over an encoded snapshot. The view
+// never allocates; every string_view points into the underlying buffer.
+class SnapshotView {
+public:
+    SnapshotView() : base(nullptr), length(0), scalars(0), disks(0), adapters(0), ver(0) {}
+
+    // False if the buffer isn't a well-formed snapshot
+    bool attach(const char* data, size_t size);
+    bool valid() const { return base != nullptr; }
+
+    uint16_t version() const { return ver; }
+    // The encoded snapshot, header included
+    std::string_view bytes() const { return std::string_view(base, length); }
+    std::string_view timestamp() const { return scalar(SerialSnapshot::Timestamp); }
+    std::string_view cpuId() const { return scalar(SerialSnapshot::CpuId); }
+    std::string_view motherboardSerial() const { return scalar(SerialSnapshot::MotherboardSerial); }
+    std::string_view biosSerial() const { return scalar(SerialSnapshot::BiosSerial); }
+
+    size_t diskCount() const { return disks; }
+    std::string_view disk(size_t i) const { return field(scalars + (uint32_t)i); }
+
+    size_t adapterCount() const { return adapters; }
+    std::string_view adapterName(size_t i) const { return field(scalars + disks + 2 * (uint32_t)i); }
+    std::string_view adapterMac(size_t i) const { return field(scalars + disks + 2 * (uint32_t)i + 1); }
+
+    // False for version 1 snapshots, which predate the fingerprint
+    bool fingerprint(SerialFingerprint& out) const { return out.decode(scalar(SerialSnapshot::Fingerprint)); }
+
+    void toSerials(SystemSerials& out) const;
+
+    static bool looksLikeSnapshot(const char* data, size_t size);
+
+private:
+    const char* base;
+    size_t length;
+    uint32_t scalars;
+    uint32_t disks;
+    uint32_t adapters;
+    uint16_t ver;
+
+    std::string_view scalar(uint32_t slot) const {
+        return slot < scalars ? field(slot) : std::string_view();
+    }
+    std::string_view field(uint32_t index) const;
+};
+
+// A snapshot file mapped into memory
+class SnapshotFile {
+public:
+    bool open(const std::string& filename);
+    void close() { view = SnapshotView(); file.close(); }
+    const SnapshotView& get() const { return view; }
+
+private:
+    MappedFile file;
+    SnapshotView view;
+};
+
+// Which categories differ between two snapshots. Disks compare as a set,
+// adapters by MAC, matching SystemInfoChecker::compareSerials. When both
+// carry fingerprints, matching roots answer in one compare and only the
+// components whose hashes differ are walked.
+struct SnapshotChanges {
+    bool cpuId;
+    bool motherboardSerial;
+    bool biosSerial;
+    bool diskSerials;
+    bool networkAdapters;
+
+    bool any() const { return cpuId || motherboardSerial || biosSerial || diskSerials || networkAdapters; }
+};
+
+SnapshotChanges compareSnapshots(const SnapshotView& current, const SnapshotView& saved);
+
+// Loads a snapshot, or one of the two legacy formats so old baselines keep
+// working until they are next saved
+bool loadSerialsFile(const std::string& filename, SystemSerials& serials);
+
+#endif // SERIAL_SNAPSHOT_H
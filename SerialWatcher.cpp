@@ -0,0 +1,64 @@
+// serialwatcher.cpp
+
+#include "SerialWatcher.h"
+#include <utility>
+
+SerialWatcher::SerialWatcher(ChangeSource& source, Collector collect)
+    : source(source), collect(collect), settleMs(250), collectCounts() {
+}
+
+unsigned SerialWatcher::changedComponents(const SystemSerials& a, const SystemSerials& b, unsigned mask) {
+    unsigned changed = 0;
+    if ((mask & WatchCpu) && a.cpuId != b.cpuId) changed |= WatchCpu;
+    if ((mask & WatchMotherboard) && a.motherboardSerial != b.motherboardSerial) changed |= WatchMotherboard;
+    if ((mask & WatchBios) && a.biosSerial != b.biosSerial) changed |= WatchBios;
+    if ((mask & WatchDisks) && a.diskSerials != b.diskSerials) changed |= WatchDisks;
+    if ((mask & WatchAdapters) && a.networkAdapters != b.networkAdapters) changed |= WatchAdapters;
+    return changed;
+}
+
+void SerialWatcher::collectInto(unsigned components, SystemSerials& target) {
+    collect(components, target);
+    for (unsigned bit = 0; bit < 5; bit++) {
+        if (components & (1u << bit)) collectCounts[bit]++;
+    }
+}
+
+bool SerialWatcher::run(ChangeHandler onChange, std::function<bool()> keepRunning, unsigned pollMs) {
+    if (!source.start()) return false;
+
+    collectInto(WatchAll, serials);
+    unsigned retry = serials.incomplete;
+
+    while (keepRunning()) {
+        // Components that missed the refresh deadline are tried again every poll
+        unsigned components = source.waitForChanges(pollMs) | retry;
+        if (!components) continue;
+
+        // Soak up the rest of a burst before touching the hardware
+        for (int i = 0; i < 10; i++) {
+            unsigned more = source.waitForChanges(settleMs);
+            if (!more) break;
+            components |= more;
+        }
+
+        // Re-collect into a copy so untouched components keep their values
+        scratch = serials;
+        collectInto(components, scratch);
+
+        // A partial read isn't a change; keep the last complete values
+        retry = scratch.incomplete & components;
+        if (retry & WatchCpu) scratch.cpuId = serials.cpuId;
+        if (retry & WatchMotherboard) scratch.motherboardSerial = serials.motherboardSerial;
+        if (retry & WatchBios) scratch.biosSerial = serials.biosSerial;
+        if (retry & WatchDisks) scratch.diskSerials = serials.diskSerials;
+        if (retry & WatchAdapters) scratch.networkAdapters = serials.networkAdapters;
+        unsigned changed = changedComponents(serials, scratch, components & ~retry);
+        std::swap(serials, scratch);
+
+        if (changed && onChange) onChange(changed, serials);
+    }
+
+    source.stop();
+    return true;
+}
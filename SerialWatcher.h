@@ -0,0 +1,49 @@
+#pragma once
+#ifndef SERIAL_WATCHER_H
+#define SERIAL_WATCHER_H
+
+#include <functional>
+#include "system_serials.hpp"
+#include "ChangeSource.h"
+
+// Long-running watch mode. Waits on a ChangeSource and re-collects only the
+// components a notification names, instead of re-running every query.
+class SerialWatcher {
+public:
+    // Must refill exactly the components in the mask (clearing lists first)
+    // and flag any that missed the deadline in serials.incomplete; those
+    // keep their previous values and are retried on the next poll
+    typedef std::function<void(unsigned components, SystemSerials& serials)> Collector;
+    // Called with the components whose values actually differ afterwards
+    typedef std::function<void(unsigned changed, const SystemSerials& serials)> ChangeHandler;
+
+    SerialWatcher(ChangeSource& source, Collector collect);
+
+    // Notifications arriving within this window of the first one are
+    // coalesced into a single re-collection (adapter changes come in bursts)
+    void setSettleTime(unsigned ms) { settleMs = ms; }
+
+    // Full collection, then watch until keepRunning() returns false. It is
+    // checked at least every pollMs.
+    bool run(ChangeHandler onChange, std::function<bool()> keepRunning, unsigned pollMs = 500);
+
+    const SystemSerials& current() const { return serials; }
+
+    // How many times each component was re-collected, indexed by bit
+    // position of WatchComponent (0 = CPU ... 4 = adapters)
+    unsigned collections(unsigned bit) const { return bit < 5 ? collectCounts[bit] : 0; }
+
+    static unsigned changedComponents(const SystemSerials& a, const SystemSerials& b, unsigned mask);
+
+private:
+    ChangeSource& source;
+    Collector collect;
+    SystemSerials serials;
+    SystemSerials scratch;
+    unsigned settleMs;
+    unsigned collectCounts[5];
+
+    void collectInto(unsigned components, SystemSerials& target);
+};
+
+#endif // SERIAL_WATCHER_H
@@ -0,0 +1,258 @@
+// smbiosreader.cpp
+
+#include "SmbiosReader.h"
+#include "BinaryIO.h"
+#include "system_serials.hpp" // WatchComponent
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+// Structure types read here
+static const uint8_t BiosInformation = 0;
+static const uint8_t SystemInformation = 1;
+static const uint8_t BaseboardInformation = 2;
+static const uint8_t SystemEnclosure = 3;
+static const uint8_t MemoryDevice = 17;
+static const uint8_t EndOfTable = 127;
+
+static const size_t StructureHeaderSize = 4; // type, length, handle
+
+// Field offsets, per the DMTF SMBIOS reference specification. A field is
+// only read if the structure's length covers it; older versions are shorter.
+static const size_t BiosVendorOffset = 0x04;
+static const size_t BiosVersionOffset = 0x05;
+static const size_t BiosReleaseDateOffset = 0x08;
+static const size_t SystemManufacturerOffset = 0x04;
+static const size_t SystemProductOffset = 0x05;
+static const size_t SystemSerialOffset = 0x07;
+static const size_t SystemUuidOffset = 0x08;
+static const size_t BoardManufacturerOffset = 0x04;
+static const size_t BoardProductOffset = 0x05;
+static const size_t BoardSerialOffset = 0x07;
+static const size_t ChassisManufacturerOffset = 0x04;
+static const size_t ChassisTypeOffset = 0x05;
+static const size_t ChassisSerialOffset = 0x07;
+static const size_t ChassisAssetTagOffset = 0x08;
+static const size_t MemorySizeOffset = 0x0C;
+static const size_t MemoryLocatorOffset = 0x10;
+static const size_t MemoryBankLocatorOffset = 0x11;
+static const size_t MemorySpeedOffset = 0x15;
+static const size_t MemoryManufacturerOffset = 0x17;
+static const size_t MemorySerialOffset = 0x18;
+static const size_t MemoryPartNumberOffset = 0x1A;
+static const size_t MemoryExtendedSizeOffset = 0x1C;
+static const size_t MemoryExtendedSpeedOffset = 0x54;
+
+static const uint16_t MemorySizeUnknown = 0xFFFF;
+static const uint16_t MemorySizeExtended = 0x7FFF;
+static const uint16_t MemorySizeInKb = 0x8000;
+static const uint16_t MemorySpeedExtended = 0xFFFF;
+
+static const char UpperHex[] = "0123456789ABCDEF";
+
+// One formatted area plus its string set
+struct Structure {
+    const unsigned char* data;
+    size_t length;          // formatted area
+    const char* strings;    // first string
+    const char* stringsEnd; // the terminating double NUL
+
+    bool has(size_t offset, size_t width) const { return offset + width <= length; }
+    uint8_t byteAt(size_t offset) const { return has(offset, 1) ? data[offset] : 0; }
+    uint16_t wordAt(size_t offset) const { return has(offset, 2) ? getU16((const char*)data + offset) : 0; }
+    uint32_t dwordAt(size_t offset) const { return has(offset, 4) ? getU32((const char*)data + offset) : 0; }
+};
+
+// The string whose 1-based number is stored at offset, trimmed; 0 means none
+static void structureString(const Structure& s, size_t offset, std::string& out) {
+    out.clear();
+    uint8_t index = s.byteAt(offset);
+    if (index == 0) return;
+    const char* p = s.strings;
+    for (uint8_t i = 1; p < s.stringsEnd; i++) {
+        const char* end = (const char*)memchr(p, '\0', (size_t)(s.stringsEnd - p));
+        if (!end) end = s.stringsEnd;
+        if (i == index) {
+            while (p < end && (unsigned char)*p <= ' ') p++;
+            while (end > p && (unsigned char)end[-1] <= ' ') end--;
+            out.assign(p, (size_t)(end - p));
+            return;
+        }
+        p = end + 1;
+    }
+}
+
+// From 2.6 on the first three fields are little-endian, as dmidecode and
+// WMI print them; all zeros or all ones means the UUID isn't set
+static void formatUuid(const unsigned char* bytes, bool littleEndianFields, std::string& out) {
+    bool zero = true, ones = true;
+    for (int i = 0; i < 16; i++) {
+        zero = zero && bytes[i] == 0x00;
+        ones = ones && bytes[i] == 0xFF;
+    }
+    if (zero || ones) {
+        out.clear();
+        return;
+    }
+    static const int littleEndian[16] = { 3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 };
+    out.assign(36, '-');
+    size_t pos = 0;
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) pos++; // the dash already there
+        unsigned char b = bytes[littleEndianFields ? littleEndian[i] : i];
+        out[pos++] = UpperHex[b >> 4];
+        out[pos++] = UpperHex[b & 15];
+    }
+}
+
+static void decodeMemoryDevice(const Structure& s, SmbiosInfo& info, size_t& modules) {
+    uint16_t size = s.wordAt(MemorySizeOffset);
+    if (size == 0) return; // empty slot
+
+    if (modules == info.memoryModules.size()) info.memoryModules.emplace_back();
+    SmbiosMemoryModule& module = info.memoryModules[modules++];
+    if (size == MemorySizeUnknown) module.sizeMb = 0;
+    else if (size == MemorySizeExtended) module.sizeMb = s.dwordAt(MemoryExtendedSizeOffset) & 0x7FFFFFFF;
+    else if (size & MemorySizeInKb) module.sizeMb = (size & 0x7FFF) / 1024;
+    else module.sizeMb = size;
+
+    module.speedMts = s.wordAt(MemorySpeedOffset);
+    if (module.speedMts == MemorySpeedExtended) module.speedMts = s.dwordAt(MemoryExtendedSpeedOffset);
+    structureString(s, MemoryLocatorOffset, module.locator);
+    structureString(s, MemoryBankLocatorOffset, module.bankLocator);
+    structureString(s, MemoryManufacturerOffset, module.manufacturer);
+    structureString(s, MemorySerialOffset, module.serial);
+    structureString(s, MemoryPartNumberOffset, module.partNumber);
+}
+
+bool parseSmbiosTable(const unsigned char* table, size_t size, uint8_t majorVersion, uint8_t minorVersion,
+    SmbiosInfo& info) {
+
+    info.majorVersion = majorVersion;
+    info.minorVersion = minorVersion;
+    std::string* fields[] = { &info.biosVendor, &info.biosVersion, &info.biosReleaseDate,
+        &info.systemManufacturer, &info.systemProduct, &info.systemSerial, &info.systemUuid,
+        &info.boardManufacturer, &info.boardProduct, &info.boardSerial,
+        &info.chassisManufacturer, &info.chassisSerial, &info.chassisAssetTag };
+    for (std::string* field : fields) field->clear();
+    info.chassisType = 0;
+
+    bool littleEndianUuid = majorVersion > 2 || (majorVersion == 2 && minorVersion >= 6);
+    bool seen[SystemEnclosure + 1] = {};
+    size_t modules = 0;
+    size_t structures = 0; // well-formed ones, end of table included
+    const unsigned char* end = table + size;
+    const unsigned char* p = table;
+    while ((size_t)(end - p) >= StructureHeaderSize) {
+        Structure s;
+        s.data = p;
+        s.length = p[1];
+        if (s.length < StructureHeaderSize || s.length > (size_t)(end - p)) break;
+
+        // The string set ends at the first double NUL after the formatted area
+        const unsigned char* q = p + s.length;
+        while (q + 1 < end && (q[0] != 0 || q[1] != 0)) q++;
+        if (q + 1 >= end) break;
+        s.strings = (const char*)p + s.length;
+        s.stringsEnd = (const char*)q;
+        structures++;
+
+        uint8_t type = p[0];
+        if (type == EndOfTable) break;
+        if (type <= SystemEnclosure) {
+            if (seen[type]) {
+                p = q + 2; // later copies are ignored
+                continue;
+            }
+            seen[type] = true;
+        }
+        switch (type) {
+        case BiosInformation:
+            structureString(s, BiosVendorOffset, info.biosVendor);
+            structureString(s, BiosVersionOffset, info.biosVersion);
+            structureString(s, BiosReleaseDateOffset, info.biosReleaseDate);
+            break;
+        case SystemInformation:
+            structureString(s, SystemManufacturerOffset, info.systemManufacturer);
+            structureString(s, SystemProductOffset, info.systemProduct);
+            structureString(s, SystemSerialOffset, info.systemSerial);
+            if (s.has(SystemUuidOffset, 16)) formatUuid(p + SystemUuidOffset, littleEndianUuid, info.systemUuid);
+            break;
+        case BaseboardInformation:
+            structureString(s, BoardManufacturerOffset, info.boardManufacturer);
+            structureString(s, BoardProductOffset, info.boardProduct);
+            structureString(s, BoardSerialOffset, info.boardSerial);
+            break;
+        case SystemEnclosure:
+            structureString(s, ChassisManufacturerOffset, info.chassisManufacturer);
+            info.chassisType = s.byteAt(ChassisTypeOffset) & 0x7F;
+            structureString(s, ChassisSerialOffset, info.chassisSerial);
+            structureString(s, ChassisAssetTagOffset, info.chassisAssetTag);
+            break;
+        case MemoryDevice:
+            decodeMemoryDevice(s, info, modules);
+            break;
+        }
+        p = q + 2;
+    }
+    info.memoryModules.resize(modules);
+    return structures != 0;
+}
+
+bool parseRawSmbiosData(const unsigned char* data, size_t size, SmbiosInfo& info) {
+    if (size < RawSmbiosHeaderSize) return false;
+    size_t length = getU32((const char*)data + 4);
+    if (length > size - RawSmbiosHeaderSize) length = size - RawSmbiosHeaderSize; // trust what was read
+    return parseSmbiosTable(data + RawSmbiosHeaderSize, length, data[1], data[2], info);
+}
+
+bool parseSmbiosEntryPoint(const unsigned char* data, size_t size, uint8_t& majorVersion, uint8_t& minorVersion) {
+    if (size >= 0x18 && memcmp(data, "_SM3_", 5) == 0) {
+        majorVersion = data[0x07];
+        minorVersion = data[0x08];
+        return true;
+    }
+    if (size >= 0x1F && memcmp(data, "_SM_", 4) == 0) {
+        majorVersion = data[0x06];
+        minorVersion = data[0x07];
+        return true;
+    }
+    if (size >= 0x0F && memcmp(data, "_DMI_", 5) == 0) {
+        majorVersion = data[0x0E] >> 4; // BCD revision, 2.0 era tables
+        minorVersion = data[0x0E] & 0x0F;
+        return true;
+    }
+    return false;
+}
+
+void assignFirmwareSerials(const SmbiosInfo& info, unsigned components, std::string& motherboard,
+    std::string& bios) {
+
+    if (components & WatchBios) {
+        if (info.systemSerial.empty()) bios.assign("Not Available");
+        else bios.assign(info.systemSerial);
+    }
+    if (components & WatchMotherboard) {
+        if (info.boardSerial.empty()) motherboard.assign("Not Available");
+        else motherboard.assign(info.boardSerial);
+    }
+}
+
+bool SmbiosReader::read(SmbiosInfo& info) {
+    if (fetch(buffer) && parseRawSmbiosData(buffer.data(), buffer.size(), info)) return true;
+    info = SmbiosInfo();
+    return false;
+}
+
+bool FixtureSmbiosReader::loadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    table.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool FixtureSmbiosReader::fetch(std::vector<unsigned char>& raw) {
+    if (table.size() < RawSmbiosHeaderSize) return false;
+    raw.assign(table.begin(), table.end());
+    return true;
+}
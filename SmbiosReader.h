@@ -0,0 +1,115 @@
+#pragma once
+#ifndef SMBIOS_READER_H
+#define SMBIOS_READER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// One populated memory slot (SMBIOS type 17)
+struct SmbiosMemoryModule {
+    std::string locator;      // "DIMM_A1", "ChannelA-DIMM0"
+    std::string bankLocator;
+    std::string manufacturer;
+    std::string serial;
+    std::string partNumber;
+    uint32_t sizeMb;          // 0 if the firmware doesn't say
+    uint32_t speedMts;        // 0 if unknown
+
+    SmbiosMemoryModule() : sizeMb(0), speedMts(0) {}
+};
+
+// The structures BanSniffer reads out of the SMBIOS table. Strings are
+// trimmed; a string the firmware leaves out is empty. Only the first
+// structure of types 0-3 counts, as it does for WMI and sysfs.
+struct SmbiosInfo {
+    uint8_t majorVersion;
+    uint8_t minorVersion;
+
+    std::string biosVendor;          // type 0
+    std::string biosVersion;
+    std::string biosReleaseDate;
+    std::string systemManufacturer;  // type 1
+    std::string systemProduct;
+    std::string systemSerial;        // what Win32_BIOS.SerialNumber and product_serial report
+    std::string systemUuid;          // canonical 8-4-4-4-12 upper case, empty if unset
+    std::string boardManufacturer;   // type 2
+    std::string boardProduct;
+    std::string boardSerial;         // Win32_BaseBoard.SerialNumber, board_serial
+    std::string chassisManufacturer; // type 3
+    std::string chassisSerial;
+    std::string chassisAssetTag;
+    uint8_t chassisType;             // SMBIOS chassis type, lock bit masked off
+    std::vector<SmbiosMemoryModule> memoryModules; // type 17, installed only, table order
+
+    SmbiosInfo() : majorVersion(0), minorVersion(0), chassisType(0) {}
+};
+
+// Portable decoding, shared by the real and fake readers. Tables travel in
+// the RawSMBIOSData layout GetSystemFirmwareTable('RSMB') returns: an
+// 8-byte header (calling method, major, minor, DMI revision, table length)
+// followed by the structures. The Linux reader builds the same header from
+// the entry point, so a dump from either platform is a valid fixture.
+static const size_t RawSmbiosHeaderSize = 8;
+
+// Walks every structure once. Lengths and string sets that run past the
+// table end the walk there; whatever was decoded before is kept. Strings
+// are written over those already in info, so re-parsing the same table
+// doesn't allocate. False if data doesn't hold a header, or not even the
+// first structure is well-formed (garbage, or a table cut off inside it).
+bool parseRawSmbiosData(const unsigned char* data, size_t size, SmbiosInfo& info);
+bool parseSmbiosTable(const unsigned char* table, size_t size, uint8_t majorVersion, uint8_t minorVersion,
+    SmbiosInfo& info);
+
+// Version out of a 32-bit ("_SM_"), 64-bit ("_SM3_") or legacy ("_DMI_")
+// entry point structure
+bool parseSmbiosEntryPoint(const unsigned char* data, size_t size, uint8_t& majorVersion, uint8_t& minorVersion);
+
+// Fetches the raw table: GetSystemFirmwareTable on Windows
+// (WinSmbiosReader), /sys/firmware/dmi/tables on Linux
+// (SysfsSmbiosReader), a captured dump in tests (FixtureSmbiosReader).
+// One read serves every structure type. Not thread-safe.
+class SmbiosReader {
+public:
+    virtual ~SmbiosReader() {}
+
+    // Replaces raw with the table in the RawSMBIOSData layout, keeping its
+    // capacity. False if the firmware exposes no table or it can't be read.
+    virtual bool fetch(std::vector<unsigned char>& raw) = 0;
+
+    // fetch() into a buffer kept across calls, then parse. On failure info
+    // keeps nothing from an earlier read.
+    bool read(SmbiosInfo& info);
+
+private:
+    std::vector<unsigned char> buffer; // grow-only
+};
+
+// SystemSerials' firmware fields out of a decoded table, for the
+// WatchMotherboard/WatchBios bits in components: the BIOS serial is the
+// system serial (type 1), the board serial type 2's, exactly what
+// Win32_BIOS and Win32_BaseBoard report. A board without a serial is "Not
+// Available", never the system serial, so every platform and code path
+// produces the same baseline.
+void assignFirmwareSerials(const SmbiosInfo& info, unsigned components, std::string& motherboard,
+    std::string& bios);
+
+// This platform's reader; implemented next to each one
+std::unique_ptr<SmbiosReader> createSmbiosReader();
+
+// Serves a captured table, e.g. one written by "BanSniffer smbios --dump"
+class FixtureSmbiosReader : public SmbiosReader {
+public:
+    FixtureSmbiosReader() {}
+    explicit FixtureSmbiosReader(const std::string& raw) : table(raw) {}
+
+    bool loadFile(const std::string& path);
+    bool fetch(std::vector<unsigned char>& raw) override;
+
+private:
+    std::string table;
+};
+
+#endif // SMBIOS_READER_H
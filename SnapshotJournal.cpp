@@ -0,0 +1,266 @@
+// snapshotjournal.cpp
+
+#include "SnapshotJournal.h"
+#include "SerialWatcher.h"
+#include "BinaryIO.h"
+#include "MappedFile.h"
+#include <filesystem>
+#include <cstring>
+
+static const char Magic[4] = { 'B', 'J', 'N', 'L' };
+static const uint16_t Version = 1;
+static const size_t HeaderSize = 8;
+static const char CheckpointKind = 'C';
+static const char DeltaKind = 'D';
+
+static uint32_t checksum(const char* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+SnapshotJournal::SnapshotJournal()
+    : fileSize(0), records(0), sinceCheckpoint(0), checkpointInterval(DefaultCheckpointInterval) {
+}
+
+SnapshotJournal::~SnapshotJournal() {
+    close();
+}
+
+void SnapshotJournal::encodeBody(std::string& body, const SystemSerials& serials, unsigned components) {
+    putBytes(body, serials.timestamp);
+    putVarint(body, components);
+    if (components & WatchCpu) putBytes(body, serials.cpuId);
+    if (components & WatchMotherboard) putBytes(body, serials.motherboardSerial);
+    if (components & WatchBios) putBytes(body, serials.biosSerial);
+    if (components & WatchDisks) {
+        putVarint(body, serials.diskSerials.size());
+        for (const auto& disk : serials.diskSerials) putBytes(body, disk);
+    }
+    if (components & WatchAdapters) {
+        putVarint(body, serials.networkAdapters.size());
+        for (const auto& adapter : serials.networkAdapters) {
+            putBytes(body, adapter.first);
+            putBytes(body, adapter.second);
+        }
+    }
+}
+
+// Applies one body on top of state; false if it is malformed
+static bool decodeBody(const char* data, size_t size, SystemSerials& state, unsigned& components) {
+    size_t pos = 0;
+    std::string_view value;
+    uint64_t mask, count;
+    if (!getBytes(data, size, pos, value)) return false;
+    state.timestamp.assign(value);
+    if (!getVarint(data, size, pos, mask) || (mask & ~(uint64_t)WatchAll)) return false;
+    components = (unsigned)mask;
+
+    if (components & WatchCpu) {
+        if (!getBytes(data, size, pos, value)) return false;
+        state.cpuId.assign(value);
+    }
+    if (components & WatchMotherboard) {
+        if (!getBytes(data, size, pos, value)) return false;
+        state.motherboardSerial.assign(value);
+    }
+    if (components & WatchBios) {
+        if (!getBytes(data, size, pos, value)) return false;
+        state.biosSerial.assign(value);
+    }
+    if (components & WatchDisks) {
+        if (!getVarint(data, size, pos, count) || count > size - pos) return false;
+        state.diskSerials.resize((size_t)count);
+        for (auto& disk : state.diskSerials) {
+            if (!getBytes(data, size, pos, value)) return false;
+            disk.assign(value);
+        }
+    }
+    if (components & WatchAdapters) {
+        if (!getVarint(data, size, pos, count) || count > size - pos) return false;
+        state.networkAdapters.resize((size_t)count);
+        for (auto& adapter : state.networkAdapters) {
+            if (!getBytes(data, size, pos, value)) return false;
+            adapter.first.assign(value);
+            if (!getBytes(data, size, pos, value)) return false;
+            adapter.second.assign(value);
+        }
+    }
+    return pos == size;
+}
+
+// Size of the intact record at pos (known kind, body in bounds, checksum
+// matches), or 0
+static size_t recordAt(const char* data, size_t size, size_t pos, char& kind, const char*& body, size_t& length) {
+    if (pos >= size) return 0;
+    kind = data[pos];
+    if (kind != CheckpointKind && kind != DeltaKind) return 0;
+    size_t p = pos + 1;
+    uint64_t declared;
+    if (!getVarint(data, size, p, declared) || declared + 4 > size - p) return 0;
+    body = data + p;
+    length = (size_t)declared;
+    if (getU32(body + length) != checksum(body, length)) return 0;
+    return p + length + 4 - pos;
+}
+
+// First offset at or after from where an intact record of the given kind
+// (either kind if 0) starts, or size
+static size_t findRecord(const char* data, size_t size, size_t from, char wanted) {
+    char kind = 0;
+    const char* body = nullptr;
+    size_t length = 0;
+    for (size_t pos = from; pos < size; pos++) {
+        if (wanted && data[pos] != wanted) continue;
+        if (recordAt(data, size, pos, kind, body, length)) return pos;
+    }
+    return size;
+}
+
+uint64_t SnapshotJournal::scan(const char* data, size_t size, const std::function<void(const JournalEntry&)>& visit) {
+    JournalEntry entry;
+    SystemSerials previous;
+    size_t pos = HeaderSize;
+    size_t end = HeaderSize; // just past the last intact record
+    bool haveCheckpoint = false; // since the start or the last damage
+    bool visited = false;
+    while (pos < size) {
+        char kind = 0;
+        const char* body = nullptr;
+        size_t length = 0;
+        size_t recordSize = recordAt(data, size, pos, kind, body, length);
+
+        // A delta needs something to apply to
+        bool checkpoint = kind == CheckpointKind;
+        bool usable = recordSize && (checkpoint || haveCheckpoint);
+        if (usable && checkpoint && visited) previous = entry.serials;
+        if (usable) usable = decodeBody(body, length, entry.serials, entry.changed);
+        if (usable && checkpoint) usable = entry.changed == WatchAll;
+
+        if (!usable) {
+            // Damage inside the file: the deltas up to the next checkpoint
+            // can't be applied, everything from that checkpoint on can. With
+            // no checkpoint left the walk ends here.
+            pos = findRecord(data, size, pos + 1, CheckpointKind);
+            haveCheckpoint = false;
+            continue;
+        }
+
+        // A checkpoint carries everything; report what actually differed
+        // from the state before it (before the damage, after a resync)
+        entry.checkpoint = checkpoint;
+        if (checkpoint && visited)
+            entry.changed = SerialWatcher::changedComponents(previous, entry.serials, WatchAll);
+
+        haveCheckpoint = visited = true;
+        entry.offset = pos;
+        pos += recordSize;
+        end = pos;
+        visit(entry);
+    }
+    return end;
+}
+
+static bool isJournal(const char* data, size_t size) {
+    return size >= HeaderSize && memcmp(data, Magic, 4) == 0 && getU16(data + 4) == Version;
+}
+
+bool SnapshotJournal::replay(const std::string& path, const std::function<void(const JournalEntry&)>& visit) {
+    MappedFile file;
+    if (!file.open(path) || !isJournal(file.data(), file.size())) return false;
+    scan(file.data(), file.size(), visit);
+    return true;
+}
+
+bool SnapshotJournal::open(const std::string& path) {
+    close();
+
+    std::error_code ec;
+    uint64_t existing = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    if (ec) return false;
+
+    if (existing > 0) {
+        uint64_t end;
+        bool intactAfterEnd;
+        {
+            MappedFile file;
+            if (!file.open(path)) return false;
+            if (!isJournal(file.data(), file.size())) return false; // never overwrite something else
+            end = scan(file.data(), file.size(), [this](const JournalEntry& entry) {
+                last = entry.serials;
+                records++;
+                sinceCheckpoint = entry.checkpoint ? 0 : sinceCheckpoint + 1;
+            });
+            intactAfterEnd = findRecord(file.data(), file.size(), (size_t)end, 0) < file.size();
+        }
+
+        // Drop a torn tail (crash mid-append) so the next append starts on a
+        // record boundary. Anything past the last usable record that still
+        // holds an intact record is damage, not a torn append; truncating
+        // would delete it, so the journal is left alone and not opened.
+        if (end < existing) {
+            if (intactAfterEnd) return false;
+            std::filesystem::resize_file(path, end, ec);
+            if (ec) return false;
+        }
+        fileSize = end;
+        out.open(path, std::ios::binary | std::ios::app);
+        return out.is_open();
+    }
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    char header[HeaderSize] = {};
+    memcpy(header, Magic, 4);
+    putU16(header + 4, Version);
+    out.write(header, HeaderSize);
+    out.flush();
+    fileSize = HeaderSize;
+    return out.good();
+}
+
+void SnapshotJournal::close() {
+    if (out.is_open()) out.close();
+    last = SystemSerials();
+    fileSize = 0;
+    records = 0;
+    sinceCheckpoint = 0;
+}
+
+SnapshotJournal::AppendResult SnapshotJournal::append(const SystemSerials& serials) {
+    if (!out.is_open() || serials.incomplete) return AppendResult::Failed;
+
+    unsigned changed = records ? SerialWatcher::changedComponents(last, serials, WatchAll) : WatchAll;
+    if (!changed) return AppendResult::Unchanged;
+
+    bool checkpoint = records == 0 || sinceCheckpoint >= checkpointInterval;
+    body.clear();
+    encodeBody(body, serials, checkpoint ? (unsigned)WatchAll : changed);
+
+    record.clear();
+    record.push_back(checkpoint ? CheckpointKind : DeltaKind);
+    putVarint(record, body.size());
+    record += body;
+    char sum[4];
+    putU32(sum, checksum(body.data(), body.size()));
+    record.append(sum, 4);
+
+    // One write per record; flushed to the OS, not synced to disk
+    out.write(record.data(), (std::streamsize)record.size());
+    out.flush();
+    if (!out.good()) return AppendResult::Failed;
+
+    fileSize += record.size();
+    records++;
+    sinceCheckpoint = checkpoint ? 0 : sinceCheckpoint + 1;
+    last.timestamp = serials.timestamp;
+    if (changed & WatchCpu) last.cpuId = serials.cpuId;
+    if (changed & WatchMotherboard) last.motherboardSerial = serials.motherboardSerial;
+    if (changed & WatchBios) last.biosSerial = serials.biosSerial;
+    if (changed & WatchDisks) last.diskSerials = serials.diskSerials;
+    if (changed & WatchAdapters) last.networkAdapters = serials.networkAdapters;
+    return AppendResult::Written;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef SNAPSHOT_JOURNAL_H
+#define SNAPSHOT_JOURNAL_H
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+#include "system_serials.hpp"
+
+// Append-only history of one host's serials. Each collection that differs
+// from the last one recorded adds a record holding only the components that
+// changed, so the file grows with the number of changes rather than polls.
+//
+// Layout, integers little-endian, varints LEB128:
+//   header   magic "BJNL", u16 version, u16 reserved
+//   record   u8 kind ('C' checkpoint, 'D' delta), varint body length, body,
+//            u32 FNV-1a of the body
+//   body     timestamp, varint WatchComponent mask, then for each set bit in
+//            order: cpuId | motherboardSerial | biosSerial (varint length +
+//            bytes), disks (varint count, strings), adapters (varint count,
+//            name/MAC pairs). A checkpoint carries every component.
+//
+// A checkpoint is written every setCheckpointInterval() deltas so a reader
+// never has to replay far to rebuild a full snapshot. A torn record at the
+// end (crash mid-append) is dropped on open. A damaged record inside the
+// file loses only the deltas up to the next checkpoint: replay resumes
+// there. If nothing usable follows the damage but intact records do, open()
+// refuses the file rather than truncate them.
+struct JournalEntry {
+    SystemSerials serials;  // full state after applying the record
+    unsigned changed;       // WatchComponent bits the record carried
+    bool checkpoint;
+    uint64_t offset;        // of the record in the file
+};
+
+class SnapshotJournal {
+public:
+    enum class AppendResult { Written, Unchanged, Failed };
+
+    static const unsigned DefaultCheckpointInterval = 64;
+
+    SnapshotJournal();
+    ~SnapshotJournal();
+
+    SnapshotJournal(const SnapshotJournal&) = delete;
+    SnapshotJournal& operator=(const SnapshotJournal&) = delete;
+
+    // Creates the file if needed, otherwise replays it to recover the
+    // latest state the next delta is taken against. False for a file that
+    // isn't a journal or is damaged in a way truncating can't fix.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return out.is_open(); }
+
+    // Nothing is written when only the timestamp differs. Incomplete
+    // serials (see SystemSerials::incomplete) are refused as Failed.
+    AppendResult append(const SystemSerials& serials);
+
+    void setCheckpointInterval(unsigned deltas) { checkpointInterval = deltas ? deltas : 1; }
+
+    // State after the last record; empty until something was appended
+    const SystemSerials& latest() const { return last; }
+    size_t recordCount() const { return records; }
+    uint64_t sizeBytes() const { return fileSize; }
+
+    // Calls visit for every usable record in order, skipping damaged
+    // stretches up to the next checkpoint; false if the file is missing or
+    // isn't a journal
+    static bool replay(const std::string& path, const std::function<void(const JournalEntry&)>& visit);
+
+private:
+    std::ofstream out;
+    SystemSerials last;
+    std::string body;         // reused for every append
+    std::string record;
+    uint64_t fileSize;
+    size_t records;
+    unsigned sinceCheckpoint;
+    unsigned checkpointInterval;
+
+    static void encodeBody(std::string& body, const SystemSerials& serials, unsigned components);
+    static uint64_t scan(const char* data, size_t size, const std::function<void(const JournalEntry&)>& visit);
+};
+
+#endif // SNAPSHOT_JOURNAL_H
@@ -0,0 +1,112 @@
+// stringpool.cpp
+
+#include "StringPool.h"
+#include "SerialFingerprint.h"
+#include <cstring>
+
+static const size_t MinSlots = 1024;
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize), cursor(nullptr), remaining(0), reserved(0) {
+}
+
+char* Arena::allocate(size_t size) {
+    if (size > blockSize / 4) {
+        blocks.emplace_back(new char[size]);
+        reserved += size;
+        return blocks.back().get();
+    }
+    if (size > remaining) {
+        blocks.emplace_back(new char[blockSize]);
+        reserved += blockSize;
+        cursor = blocks.back().get();
+        remaining = blockSize;
+    }
+    char* p = cursor;
+    cursor += size;
+    remaining -= size;
+    return p;
+}
+
+std::string_view Arena::copy(std::string_view text) {
+    if (text.empty()) return std::string_view();
+    char* p = allocate(text.size());
+    memcpy(p, text.data(), text.size());
+    return std::string_view(p, text.size());
+}
+
+void Arena::clear() {
+    blocks.clear();
+    cursor = nullptr;
+    remaining = 0;
+    reserved = 0;
+}
+
+StringPool::StringPool() {
+    clear();
+}
+
+uint32_t StringPool::hashText(std::string_view text) {
+    return (uint32_t)hash128(text).lo;
+}
+
+bool StringPool::find(std::string_view text, Id& id) const {
+    if (text.empty()) {
+        id = Empty;
+        return true;
+    }
+    uint32_t hash = hashText(text);
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; slots[i] != Empty; i = (i + 1) & mask) {
+        Id candidate = slots[i];
+        if (hashes[candidate] == hash && strings[candidate] == text) {
+            id = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+StringPool::Id StringPool::intern(std::string_view text) {
+    if (text.empty()) return Empty;
+
+    uint32_t hash = hashText(text);
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    for (; slots[i] != Empty; i = (i + 1) & mask) {
+        Id candidate = slots[i];
+        if (hashes[candidate] == hash && strings[candidate] == text) return candidate;
+    }
+
+    Id id = (Id)strings.size();
+    strings.push_back(arena.copy(text));
+    hashes.push_back(hash);
+    slots[i] = id;
+    // Same 0.7 load factor as BaselineStore's index
+    if (strings.size() * 10 > slots.size() * 7) grow();
+    return id;
+}
+
+void StringPool::grow() {
+    std::vector<Id> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, Empty);
+    size_t mask = slots.size() - 1;
+    for (Id id : old) {
+        if (id == Empty) continue;
+        size_t i = hashes[id] & mask;
+        while (slots[i] != Empty) i = (i + 1) & mask;
+        slots[i] = id;
+    }
+}
+
+size_t StringPool::memoryUsage() const {
+    return arena.capacity() + strings.capacity() * sizeof(std::string_view) +
+        hashes.capacity() * sizeof(uint32_t) + slots.capacity() * sizeof(Id);
+}
+
+void StringPool::clear() {
+    arena.clear();
+    strings.assign(1, std::string_view());
+    hashes.assign(1, 0);
+    slots.assign(MinSlots, Empty);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Bump allocator: memory comes from large blocks and is only released all
+// at once. Allocations bigger than a quarter block get a block of their own
+// so they don't waste the current one.
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    char* allocate(size_t size);
+    std::string_view copy(std::string_view text);
+
+    // Bytes reserved from the heap, including unused block tails
+    size_t capacity() const { return reserved; }
+
+    void clear();
+
+private:
+    size_t blockSize;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor;
+    size_t remaining;
+    size_t reserved;
+};
+
+// Interns strings to dense 32-bit IDs. Each distinct value is stored once in
+// the arena; ID 0 is always the empty string. Two values from the same pool
+// are equal exactly when their IDs are, so comparisons across a fleet are
+// integer compares. Not thread-safe.
+class StringPool {
+public:
+    typedef uint32_t Id;
+    static constexpr Id Empty = 0;
+
+    StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    Id intern(std::string_view text);
+
+    // False if text has never been interned
+    bool find(std::string_view text, Id& id) const;
+
+    std::string_view get(Id id) const { return id < strings.size() ? strings[id] : std::string_view(); }
+
+    // Distinct values, counting the empty string
+    size_t size() const { return strings.size(); }
+
+    size_t memoryUsage() const;
+
+    void clear();
+
+private:
+    Arena arena;
+    std::vector<std::string_view> strings;
+    std::vector<uint32_t> hashes; // per ID, so growing never rehashes text
+    std::vector<Id> slots;        // open addressing, Empty = free
+
+    static uint32_t hashText(std::string_view text);
+    void grow();
+};
+
+#endif // STRING_POOL_H
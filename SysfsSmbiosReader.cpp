@@ -0,0 +1,55 @@
+// sysfssmbiosreader.cpp
+
+#ifdef __linux__
+
+#include "SysfsSmbiosReader.h"
+#include "BinaryIO.h"
+#include "Trace.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+// Tables are a few KB; the buffer doubles from here if one isn't
+static const size_t InitialTableSize = 8 * 1024;
+
+bool SysfsSmbiosReader::fetch(std::vector<unsigned char>& raw) {
+    TraceSpan span("Sysfs SMBIOS");
+    unsigned char entryPoint[64];
+    int fd = open("/sys/firmware/dmi/tables/smbios_entry_point", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t entryLength = ::read(fd, entryPoint, sizeof(entryPoint));
+    ::close(fd);
+    uint8_t majorVersion = 0, minorVersion = 0;
+    if (entryLength <= 0 || !parseSmbiosEntryPoint(entryPoint, (size_t)entryLength, majorVersion, minorVersion))
+        return false;
+
+    fd = open("/sys/firmware/dmi/tables/DMI", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    if (raw.capacity() < RawSmbiosHeaderSize + InitialTableSize) raw.reserve(RawSmbiosHeaderSize + InitialTableSize);
+    raw.resize(raw.capacity());
+    size_t length = RawSmbiosHeaderSize;
+    ssize_t n;
+    for (;;) {
+        if (length == raw.size()) raw.resize(raw.size() * 2);
+        n = ::read(fd, raw.data() + length, raw.size() - length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        length += (size_t)n;
+    }
+    ::close(fd);
+    if (n < 0) return false;
+
+    raw.resize(length);
+    raw[0] = 0; // Used20CallingMethod
+    raw[1] = majorVersion;
+    raw[2] = minorVersion;
+    raw[3] = 0; // DmiRevision
+    putU32((char*)raw.data() + 4, (uint32_t)(length - RawSmbiosHeaderSize));
+    return true;
+}
+
+std::unique_ptr<SmbiosReader> createSmbiosReader() {
+    return std::unique_ptr<SmbiosReader>(new SysfsSmbiosReader());
+}
+
+#endif // __linux__
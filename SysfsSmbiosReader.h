@@ -0,0 +1,20 @@
+#pragma once
+#ifndef SYSFS_SMBIOS_READER_H
+#define SYSFS_SMBIOS_READER_H
+
+#ifdef __linux__
+
+#include "SmbiosReader.h"
+
+// /sys/firmware/dmi/tables: the version from smbios_entry_point, the
+// structures from DMI, both root-only like the /sys/class/dmi/id serials
+// they replace. The RawSMBIOSData header is filled in front of the table,
+// so fetch() hands out the same layout as the Windows reader.
+class SysfsSmbiosReader : public SmbiosReader {
+public:
+    bool fetch(std::vector<unsigned char>& raw) override;
+};
+
+#endif // __linux__
+
+#endif // SYSFS_SMBIOS_READER_H
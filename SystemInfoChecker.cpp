@@ -1,8 +1,11 @@
 // systeminfochecker.cpp
 
 #include "SystemInfoChecker.h"
+#include "SerialSnapshot.h"
+#include "SerialDiff.h"
+#include "SerialFormat.h"
+#include "Trace.h"
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
@@ -14,14 +17,28 @@
 
 #pragma comment(lib, "psapi.lib")
 
-SystemInfoChecker::SystemInfoChecker() : pLoc(NULL), pSvc(NULL), wmiInitialized(false) {
-    wmiInitialized = initializeWMI();
+// Set by the pool's thread hooks so each worker only uninitializes what it joined
+static thread_local bool workerJoinedCom = false;
+
+SystemInfoChecker::SystemInfoChecker()
+    : pSvc(NULL), wmiInitialized(false), wmiAttempted(false), comMultithreaded(true),
+    refreshTimeoutMs(DefaultRefreshTimeoutMs) {
 }
 
 SystemInfoChecker::~SystemInfoChecker() {
     cleanupWMI();
 }
 
+// COM and the WMI connection are set up on first use, on the thread that
+// owns the checker, so callers that only want serials never pay for them
+bool SystemInfoChecker::ensureWMI() {
+    if (!wmiAttempted) {
+        wmiAttempted = true;
+        wmiInitialized = initializeWMI();
+    }
+    return wmiInitialized;
+}
+
 bool SystemInfoChecker::initializeWMI() {
     HRESULT hres;
 
@@ -30,6 +47,7 @@ bool SystemInfoChecker::initializeWMI() {
     if (FAILED(hres) && hres != RPC_E_CHANGED_MODE) {
         return false;
     }
+    comMultithreaded = (hres != RPC_E_CHANGED_MODE);
 
     // Set security levels
     hres = CoInitializeSecurity(
@@ -50,51 +68,16 @@ bool SystemInfoChecker::initializeWMI() {
     }
 
     // Create WMI locator
-    hres = CoCreateInstance(
-        CLSID_WbemLocator,
-        0,
-        CLSCTX_INPROC_SERVER,
-        IID_IWbemLocator,
-        (LPVOID*)&pLoc);
-
-    if (FAILED(hres)) {
+    if (!wmi.initialize()) {
         CoUninitialize();
         return false;
     }
 
-    // Connect to WMI
-    hres = pLoc->ConnectServer(
-        _bstr_t(L"ROOT\\CIMV2"),
-        NULL,
-        NULL,
-        0,
-        NULL,
-        0,
-        0,
-        &pSvc
-    );
-
-    if (FAILED(hres)) {
-        pLoc->Release();
-        CoUninitialize();
-        return false;
-    }
-
-    // Set proxy blanket
-    hres = CoSetProxyBlanket(
-        pSvc,
-        RPC_C_AUTHN_WINNT,
-        RPC_C_AUTHZ_NONE,
-        NULL,
-        RPC_C_AUTHN_LEVEL_CALL,
-        RPC_C_IMP_LEVEL_IMPERSONATE,
-        NULL,
-        EOAC_NONE
-    );
-
-    if (FAILED(hres)) {
-        pSvc->Release();
-        pLoc->Release();
+    // Connect to WMI, the session manager sets the proxy blanket and keeps
+    // the connection for every later query
+    pSvc = wmi.getServices(L"ROOT\\CIMV2");
+    if (!pSvc) {
+        wmi.shutdown();
         CoUninitialize();
         return false;
     }
@@ -103,173 +86,13 @@ bool SystemInfoChecker::initializeWMI() {
 }
 
 void SystemInfoChecker::cleanupWMI() {
-    if (pSvc) pSvc->Release();
-    if (pLoc) pLoc->Release();
+    pSvc = NULL;
+    wmi.shutdown();
     if (wmiInitialized) CoUninitialize();
 }
 
-std::string SystemInfoChecker::getWMIProperty(const std::string& wmiClass, const std::string& property) {
-    if (!wmiInitialized) return "WMI Not Initialized";
-
-    std::string result = "Not Available";
-    IEnumWbemClassObject* pEnumerator = NULL;
-
-    std::string query = "SELECT " + property + " FROM " + wmiClass;
-    BSTR bstrQuery = SysAllocString(std::wstring(query.begin(), query.end()).c_str());
-
-    HRESULT hres = pSvc->ExecQuery(
-        bstr_t("WQL"),
-        bstrQuery,
-        WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
-        NULL,
-        &pEnumerator);
-
-    if (SUCCEEDED(hres)) {
-        IWbemClassObject* pclsObj = NULL;
-        ULONG uReturn = 0;
-
-        if (pEnumerator->Next(WBEM_INFINITE, 1, &pclsObj, &uReturn) == S_OK) {
-            VARIANT vtProp;
-            std::wstring wprop(property.begin(), property.end());
-            hres = pclsObj->Get(wprop.c_str(), 0, &vtProp, 0, 0);
-
-            if (SUCCEEDED(hres)) {
-                if (vtProp.vt == VT_BSTR) {
-                    result = _com_util::ConvertBSTRToString(vtProp.bstrVal);
-                }
-                else if (vtProp.vt == VT_I4) {
-                    result = std::to_string(vtProp.intVal);
-                }
-                else if (vtProp.vt == VT_UI4) {
-                    result = std::to_string(vtProp.uintVal);
-                }
-            }
-            VariantClear(&vtProp);
-            pclsObj->Release();
-        }
-        pEnumerator->Release();
-    }
-
-    SysFreeString(bstrQuery);
-    return result;
-}
-
-std::vector<std::map<std::string, std::string>> SystemInfoChecker::getWMIMultipleProperties(
-    const std::string& wmiClass, const std::vector<std::string>& properties) {
-
-    std::vector<std::map<std::string, std::string>> results;
-    if (!wmiInitialized) return results;
-
-    IEnumWbemClassObject* pEnumerator = NULL;
-    std::string query = "SELECT * FROM " + wmiClass;
-    BSTR bstrQuery = SysAllocString(std::wstring(query.begin(), query.end()).c_str());
-
-    HRESULT hres = pSvc->ExecQuery(
-        bstr_t("WQL"),
-        bstrQuery,
-        WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
-        NULL,
-        &pEnumerator);
-
-    if (SUCCEEDED(hres)) {
-        IWbemClassObject* pclsObj = NULL;
-        ULONG uReturn = 0;
-
-        while (pEnumerator) {
-            HRESULT hr = pEnumerator->Next(WBEM_INFINITE, 1, &pclsObj, &uReturn);
-            if (0 == uReturn) break;
-
-            std::map<std::string, std::string> item;
-
-            for (const auto& prop : properties) {
-                VARIANT vtProp;
-                std::wstring wprop(prop.begin(), prop.end());
-                hr = pclsObj->Get(wprop.c_str(), 0, &vtProp, 0, 0);
-
-                if (SUCCEEDED(hr)) {
-                    if (vtProp.vt == VT_BSTR) {
-                        item[prop] = _com_util::ConvertBSTRToString(vtProp.bstrVal);
-                    }
-                    else if (vtProp.vt == VT_I4) {
-                        item[prop] = std::to_string(vtProp.intVal);
-                    }
-                    else if (vtProp.vt == VT_UI4) {
-                        item[prop] = std::to_string(vtProp.uintVal);
-                    }
-                    else {
-                        item[prop] = "N/A";
-                    }
-                }
-                VariantClear(&vtProp);
-            }
-
-            results.push_back(item);
-            pclsObj->Release();
-        }
-        pEnumerator->Release();
-    }
-
-    SysFreeString(bstrQuery);
-    return results;
-}
-
-SystemSerials SystemInfoChecker::getSystemSerials() {
-    SystemSerials serials;
-
-    // Get CPU ID
-    serials.cpuId = getWMIProperty("Win32_Processor", "ProcessorId");
-
-    // Get Motherboard Serial
-    serials.motherboardSerial = getWMIProperty("Win32_BaseBoard", "SerialNumber");
-
-    // Get BIOS Serial
-    serials.biosSerial = getWMIProperty("Win32_BIOS", "SerialNumber");
-
-    // Get Disk Serials
-    auto disks = getWMIMultipleProperties("Win32_DiskDrive", { "SerialNumber", "Model" });
-    for (const auto& disk : disks) {
-        if (disk.find("SerialNumber") != disk.end()) {
-            std::string serial = disk.at("SerialNumber");
-            if (serial != "N/A" && !serial.empty()) {
-                serials.diskSerials.push_back(serial);
-            }
-        }
-    }
-
-    // Get Network Adapter MACs
-    ULONG bufferSize = 0;
-    GetAdaptersInfo(NULL, &bufferSize);
-
-    if (bufferSize > 0) {
-        PIP_ADAPTER_INFO pAdapterInfo = (IP_ADAPTER_INFO*)malloc(bufferSize);
-        if (GetAdaptersInfo(pAdapterInfo, &bufferSize) == NO_ERROR) {
-            PIP_ADAPTER_INFO pAdapter = pAdapterInfo;
-            while (pAdapter) {
-                std::stringstream mac;
-                for (int i = 0; i < pAdapter->AddressLength; i++) {
-                    if (i > 0) mac << "-";
-                    mac << std::hex << std::uppercase << std::setw(2)
-                        << std::setfill('0') << (int)pAdapter->Address[i];
-                }
-                serials.networkAdapters.push_back(
-                    std::make_pair(pAdapter->Description, mac.str())
-                );
-                pAdapter = pAdapter->Next;
-            }
-        }
-        free(pAdapterInfo);
-    }
-
-    // Set timestamp
-    serials.timestamp = getCurrentTimestamp();
-
-    return serials;
-}
-
-SecurityStatus SystemInfoChecker::getSecurityStatus() {
-    SecurityStatus status;
-
-    // Check Windows Defender service
+void SystemInfoChecker::collectDefenderService(SecurityStatus& status) {
+    TraceSpan span("Service Query", "WinDefend");
     SC_HANDLE hSCManager = OpenSCManager(NULL, NULL, SC_MANAGER_CONNECT);
     if (hSCManager) {
         SC_HANDLE hService = OpenService(hSCManager, TEXT("WinDefend"), SERVICE_QUERY_STATUS);
@@ -302,10 +125,13 @@ SecurityStatus SystemInfoChecker::getSecurityStatus() {
         }
         CloseServiceHandle(hSCManager);
     }
+}
 
+void SystemInfoChecker::collectRegistryMitigations(SecurityStatus& status) {
     // Check real-time protection
     HKEY hKey;
     status.realtimeProtectionEnabled = true; // Default to enabled
+    TraceSpan realtimeSpan("Registry Read", "Real-Time Protection\\DisableRealtimeMonitoring");
     if (RegOpenKeyEx(HKEY_LOCAL_MACHINE,
         TEXT("SOFTWARE\\Microsoft\\Windows Defender\\Real-Time Protection"),
         0, KEY_READ, &hKey) == ERROR_SUCCESS) {
@@ -324,12 +150,14 @@ SecurityStatus SystemInfoChecker::getSecurityStatus() {
     // Check DEP
     BOOL depEnabled = FALSE;
     DWORD depFlags = 0;
+    status.depEnabled = false;
     if (GetProcessDEPPolicy(GetCurrentProcess(), &depFlags, &depEnabled)) {
         status.depEnabled = depEnabled;
     }
 
     // Check ASLR
     status.aslrStatus = "Unknown";
+    TraceSpan aslrSpan("Registry Read", "Memory Management\\MoveImages");
     if (RegOpenKeyEx(HKEY_LOCAL_MACHINE,
         TEXT("SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Memory Management"),
         0, KEY_READ, &hKey) == ERROR_SUCCESS) {
@@ -351,64 +179,146 @@ SecurityStatus SystemInfoChecker::getSecurityStatus() {
 
     // Check Control Flow Guard
     PROCESS_MITIGATION_CONTROL_FLOW_GUARD_POLICY cfgPolicy = { 0 };
+    status.controlFlowGuardEnabled = false;
     if (GetProcessMitigationPolicy(GetCurrentProcess(),
         ProcessControlFlowGuardPolicy,
         &cfgPolicy, sizeof(cfgPolicy))) {
         status.controlFlowGuardEnabled = cfgPolicy.EnableControlFlowGuard;
     }
+}
 
-    // Get antivirus products
-    IWbemLocator* pSecLoc = NULL;
-    IWbemServices* pSecSvc = NULL;
-
-    HRESULT hres = CoCreateInstance(
-        CLSID_WbemLocator,
-        0,
-        CLSCTX_INPROC_SERVER,
-        IID_IWbemLocator,
-        (LPVOID*)&pSecLoc);
-
-    if (SUCCEEDED(hres)) {
-        hres = pSecLoc->ConnectServer(
-            _bstr_t(L"ROOT\\SecurityCenter2"),
-            NULL, NULL, 0, NULL, 0, 0, &pSecSvc);
-
-        if (SUCCEEDED(hres)) {
-            IEnumWbemClassObject* pEnumerator = NULL;
-            hres = pSecSvc->ExecQuery(
-                bstr_t("WQL"),
-                bstr_t("SELECT * FROM AntivirusProduct"),
-                WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
-                NULL,
-                &pEnumerator);
-
-            if (SUCCEEDED(hres)) {
-                IWbemClassObject* pclsObj = NULL;
-                ULONG uReturn = 0;
-
-                while (pEnumerator) {
-                    HRESULT hr = pEnumerator->Next(WBEM_INFINITE, 1, &pclsObj, &uReturn);
-                    if (0 == uReturn) break;
-
-                    VARIANT vtProp;
-                    hr = pclsObj->Get(L"displayName", 0, &vtProp, 0, 0);
-                    if (SUCCEEDED(hr) && vtProp.vt == VT_BSTR) {
-                        status.antivirusProducts.push_back(
-                            _com_util::ConvertBSTRToString(vtProp.bstrVal));
-                    }
-                    VariantClear(&vtProp);
-                    pclsObj->Release();
-                }
-                pEnumerator->Release();
-            }
-            pSecSvc->Release();
-        }
-        pSecLoc->Release();
+void SystemInfoChecker::collectAntivirusProducts(SecurityStatus& status) {
+    if (!wmiInitialized) return;
+
+    // Reuses the cached SecurityCenter2 connection after the first refresh
+    IWbemServices* pSecSvc = wmi.getServices(L"ROOT\\SecurityCenter2");
+    if (!pSecSvc) return;
+
+    auto products = WmiQueryBatch::run(pSecSvc, "AntivirusProduct", { "displayName" }, deadline);
+    for (const auto& product : products) {
+        auto it = product.find("displayName");
+        if (it != product.end() && it->second != "N/A")
+            status.antivirusProducts.push_back(it->second);
     }
+}
+
+CollectorPool SystemInfoChecker::makePool() {
+    // WMI proxies created on an STA thread can't be called from pool workers,
+    // so fall back to running the collectors inline in that case.
+    CollectorPool pool(comMultithreaded ? 0 : 1);
+    pool.setThreadHooks(
+        []() { workerJoinedCom = SUCCEEDED(CoInitializeEx(0, COINIT_MULTITHREADED)); },
+        []() { if (workerJoinedCom) CoUninitialize(); workerJoinedCom = false; });
+    return pool;
+}
+
+void SystemInfoChecker::startRefresh() {
+    deadline = Deadline::after(refreshTimeoutMs);
+}
+
+SystemInfoChecker::PendingComponents SystemInfoChecker::addSerialCollectors(CollectorPool& pool,
+    SystemSerials& serials, unsigned components) {
+
+    // One unit per source so each row lands as soon as its source answers
+    // and gets its own timing. Each clears its bits once they completed
+    // within the deadline; a skipped or timed-out unit leaves them set.
+    auto pending = std::make_shared<std::atomic<unsigned>>(components & WatchAll);
+    static const struct {
+        const char* name;
+        unsigned part;
+    } sources[] = {
+        { "CPU", WatchCpu },
+        { "SMBIOS", WatchMotherboard | WatchBios }, // one firmware table read for both
+        { "Disks", WatchDisks },                    // every disk in flight at once
+        { "Adapters", WatchAdapters },
+    };
+    std::vector<CollectorPool::CollectorId> parts;
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        unsigned part = sources[i].part & components;
+        if (!part) continue;
+        SystemSerials& scratch = partSerials[i];
+        parts.push_back(pool.add(sources[i].name, [this, part, &scratch, &serials, pending]() {
+            collector.collect(part, scratch, deadline);
+            copyComponents(scratch, part, serials);
+            pending->fetch_and(~(part & ~scratch.incomplete));
+        }));
+    }
+
+    // Timestamp marks when the last part finished, not when collection started
+    pool.add("Serials Timestamp", [&serials]() { serials.timestamp = getCurrentTimestamp(); }, parts);
+    return pending;
+}
+
+// The parts run concurrently, each into its own scratch copy: collect()
+// also rewrites incomplete, the timestamp and normalizes the whole struct,
+// so only the fields the part owns are handed over
+void SystemInfoChecker::copyComponents(const SystemSerials& from, unsigned components, SystemSerials& to) {
+    if (components & WatchCpu) to.cpuId = from.cpuId;
+    if (components & WatchMotherboard) to.motherboardSerial = from.motherboardSerial;
+    if (components & WatchBios) to.biosSerial = from.biosSerial;
+    if (components & WatchDisks) to.diskSerials = from.diskSerials;
+    if (components & WatchAdapters) to.networkAdapters = from.networkAdapters;
+}
+
+void SystemInfoChecker::finishSerials(const PendingComponents& pending, unsigned components,
+    SystemSerials& serials) {
 
+    serials.incomplete = (serials.incomplete & ~components) | pending->load();
+    if (serials.timestamp.empty()) serials.timestamp = getCurrentTimestamp(); // its unit was skipped
+}
+
+void SystemInfoChecker::addSecurityCollectors(CollectorPool& pool, SecurityStatus& status) {
+    pool.add("Defender Service", [this, &status]() { collectDefenderService(status); });
+    pool.add("Registry Mitigations", [this, &status]() { collectRegistryMitigations(status); });
+    pool.add("AV Products", [this, &status]() { collectAntivirusProducts(status); });
+}
+
+// Serials need neither WMI nor the pool; the collector is what the Linux
+// build and watch mode run too
+SystemSerials SystemInfoChecker::getSystemSerials() {
+    SystemSerials serials;
+    startRefresh();
+    collector.collect(WatchAll, serials, deadline);
+    return serials;
+}
+
+// Runs inline and, once a first refresh has sized everything, makes no heap
+// allocations (collect_bench checks the same collector)
+void SystemInfoChecker::refreshSerials(unsigned components, SystemSerials& serials) {
+    startRefresh();
+    collector.collect(components, serials, deadline);
+}
+
+SecurityStatus SystemInfoChecker::getSecurityStatus() {
+    SecurityStatus status;
+    ensureWMI();
+    startRefresh();
+    CollectorPool pool = makePool();
+    addSecurityCollectors(pool, status);
+    pool.run(deadline);
     return status;
 }
 
+void SystemInfoChecker::collectAll(SystemInfo& info, SystemSerials& serials, SecurityStatus& status,
+    std::vector<CollectorTiming>* timings, std::function<void(const CollectorTiming&)> onCollected) {
+
+    ensureWMI(); // before makePool, which needs the apartment
+    startRefresh();
+    CollectorPool pool = makePool();
+    pool.add("System Info", [this, &info]() { info = getSystemInfo(); });
+    auto pending = addSerialCollectors(pool, serials);
+    addSecurityCollectors(pool, status);
+    if (onCollected) {
+        pool.setCompletionHandler([&onCollected](CollectorPool::CollectorId, const CollectorTiming& timing) {
+            onCollected(timing);
+        });
+    }
+
+    auto result = pool.run(deadline);
+    finishSerials(pending, WatchAll, serials);
+    if (timings) *timings = result;
+}
+
 SystemInfo SystemInfoChecker::getSystemInfo() {
     SystemInfo info;
 
@@ -479,177 +389,23 @@ SystemInfo SystemInfoChecker::getSystemInfo() {
 }
 
 bool SystemInfoChecker::saveSerials(const SystemSerials& serials, const std::string& filename) {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) return false;
-
-    // Write timestamp
-    size_t len = serials.timestamp.length();
-    file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-    file.write(serials.timestamp.c_str(), len);
-
-    // Write CPU ID
-    len = serials.cpuId.length();
-    file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-    file.write(serials.cpuId.c_str(), len);
-
-    // Write Motherboard Serial
-    len = serials.motherboardSerial.length();
-    file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-    file.write(serials.motherboardSerial.c_str(), len);
-
-    // Write BIOS Serial
-    len = serials.biosSerial.length();
-    file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-    file.write(serials.biosSerial.c_str(), len);
-
-    // Write Disk Serials
-    size_t count = serials.diskSerials.size();
-    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
-    for (const auto& disk : serials.diskSerials) {
-        len = disk.length();
-        file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-        file.write(disk.c_str(), len);
-    }
-
-    // Write Network Adapters
-    count = serials.networkAdapters.size();
-    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
-    for (const auto& adapter : serials.networkAdapters) {
-        len = adapter.first.length();
-        file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-        file.write(adapter.first.c_str(), len);
-
-        len = adapter.second.length();
-        file.write(reinterpret_cast<const char*>(&len), sizeof(len));
-        file.write(adapter.second.c_str(), len);
-    }
-
-    file.close();
-    return true;
+    return SerialSnapshot::writeFile(serials, filename);
 }
 
 bool SystemInfoChecker::loadSerials(SystemSerials& serials, const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) return false;
-
-    try {
-        size_t len;
-        char buffer[4096];
-
-        // Read timestamp
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        file.read(buffer, len);
-        serials.timestamp = std::string(buffer, len);
-
-        // Read CPU ID
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        file.read(buffer, len);
-        serials.cpuId = std::string(buffer, len);
-
-        // Read Motherboard Serial
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        file.read(buffer, len);
-        serials.motherboardSerial = std::string(buffer, len);
-
-        // Read BIOS Serial
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        file.read(buffer, len);
-        serials.biosSerial = std::string(buffer, len);
-
-        // Read Disk Serials
-        size_t count;
-        file.read(reinterpret_cast<char*>(&count), sizeof(count));
-        serials.diskSerials.clear();
-        for (size_t i = 0; i < count; i++) {
-            file.read(reinterpret_cast<char*>(&len), sizeof(len));
-            file.read(buffer, len);
-            serials.diskSerials.push_back(std::string(buffer, len));
-        }
-
-        // Read Network Adapters
-        file.read(reinterpret_cast<char*>(&count), sizeof(count));
-        serials.networkAdapters.clear();
-        for (size_t i = 0; i < count; i++) {
-            file.read(reinterpret_cast<char*>(&len), sizeof(len));
-            file.read(buffer, len);
-            std::string name(buffer, len);
-
-            file.read(reinterpret_cast<char*>(&len), sizeof(len));
-            file.read(buffer, len);
-            std::string mac(buffer, len);
-
-            serials.networkAdapters.push_back(std::make_pair(name, mac));
-        }
-
-        file.close();
-        return true;
-    }
-    catch (...) {
-        file.close();
-        return false;
-    }
+    // Snapshot format, or the old size_t-prefixed layout this class used to write
+    return loadSerialsFile(filename, serials);
 }
 
 std::map<std::string, bool> SystemInfoChecker::compareSerials(
     const SystemSerials& current, const SystemSerials& saved) {
 
-    std::map<std::string, bool> changes;
-
-    // Compare CPU ID
-    changes["CPU ID"] = (current.cpuId != saved.cpuId);
-
-    // Compare Motherboard Serial
-    changes["Motherboard Serial"] = (current.motherboardSerial != saved.motherboardSerial);
-
-    // Compare BIOS Serial
-    changes["BIOS Serial"] = (current.biosSerial != saved.biosSerial);
-
-    // Compare Disk Serials (any change counts as changed)
-    bool diskChanged = (current.diskSerials.size() != saved.diskSerials.size());
-    if (!diskChanged) {
-        for (size_t i = 0; i < current.diskSerials.size(); i++) {
-            bool found = false;
-            for (const auto& savedDisk : saved.diskSerials) {
-                if (current.diskSerials[i] == savedDisk) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                diskChanged = true;
-                break;
-            }
-        }
-    }
-    changes["Disk Serials"] = diskChanged;
-
-    // Compare Network Adapters
-    bool netChanged = (current.networkAdapters.size() != saved.networkAdapters.size());
-    if (!netChanged) {
-        for (const auto& currentAdapter : current.networkAdapters) {
-            bool found = false;
-            for (const auto& savedAdapter : saved.networkAdapters) {
-                if (currentAdapter.second == savedAdapter.second) { // Compare by MAC
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                netChanged = true;
-                break;
-            }
-        }
-    }
-    changes["Network Adapters"] = netChanged;
-
-    return changes;
+    // Category flags derived from the per-item diff (disks as a set, adapters by MAC)
+    return diffSerials(current, saved).summary();
 }
 
 std::string SystemInfoChecker::getCurrentTimestamp() {
-    time_t now = time(0);
-    struct tm tstruct;
-    char buf[80];
-    localtime_s(&tstruct, &now);
-    strftime(buf, sizeof(buf), "%Y-%m-%d %X", &tstruct);
-    return buf;
+    std::string timestamp;
+    formatTimestamp(time(0), timestamp);
+    return timestamp;
 }
\ No newline at end of file
@@ -7,10 +7,16 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <functional>
+#include <atomic>
 #include <comdef.h>
 #include <Wbemidl.h>
 #include <sstream>
 #include "system_serials.hpp"  // <-- Include for SystemSerials
+#include "CollectorPool.h"
+#include "WmiSession.h"
+#include "WmiQueryBatch.h"
+#include "SmbiosReader.h"
 
 #pragma comment(lib, "wbemuuid.lib")
 #pragma comment(lib, "iphlpapi.lib")
@@ -48,29 +54,77 @@ struct SystemInfo {
 
 class SystemInfoChecker {
 private:
-    IWbemLocator* pLoc;
-    IWbemServices* pSvc;
+    WmiSessionManager wmi;
+    IWbemServices* pSvc; // ROOT\CIMV2, owned by wmi
     bool wmiInitialized;
+    bool wmiAttempted; // initializeWMI() has run, successfully or not
+    bool comMultithreaded; // false if the caller's thread was already STA
+    unsigned refreshTimeoutMs;
+    Deadline deadline; // of the refresh in progress, read by every collector
+    SerialCollector collector; // every serial; the same code getSystemSerials() runs
+    SystemSerials partSerials[4]; // collectAll's per-unit scratch: CPU, SMBIOS, Disks, Adapters
 
+    bool ensureWMI();
     bool initializeWMI();
     void cleanupWMI();
-    std::string getWMIProperty(const std::string& wmiClass, const std::string& property);
-    std::vector<std::map<std::string, std::string>> getWMIMultipleProperties(
-        const std::string& wmiClass, const std::vector<std::string>& properties);
+
+    // Independent collector units, each fills its own fields only
+    void collectDefenderService(SecurityStatus& status);
+    void collectRegistryMitigations(SecurityStatus& status);
+    void collectAntivirusProducts(SecurityStatus& status);
+
+    // Bits still set after the pool ran are components that missed the deadline
+    typedef std::shared_ptr<std::atomic<unsigned>> PendingComponents;
+
+    CollectorPool makePool();
+    void startRefresh();
+    PendingComponents addSerialCollectors(CollectorPool& pool, SystemSerials& serials, unsigned components = WatchAll);
+    void addSecurityCollectors(CollectorPool& pool, SecurityStatus& status);
+    static void copyComponents(const SystemSerials& from, unsigned components, SystemSerials& to);
+    static void finishSerials(const PendingComponents& pending, unsigned components, SystemSerials& serials);
 
 public:
+    static const unsigned DefaultRefreshTimeoutMs = 30000;
+
     SystemInfoChecker();
     ~SystemInfoChecker();
 
+    // Upper bound for one refresh; 0 waits as long as the sources take.
+    // Whatever misses it is returned partial and flagged (see
+    // SystemSerials::incomplete and CollectorTiming::timedOut/skipped).
+    void setRefreshTimeout(unsigned milliseconds) { refreshTimeoutMs = milliseconds; }
+    unsigned refreshTimeout() const { return refreshTimeoutMs; }
+
+    // The whole decoded table (BIOS, system, chassis, memory modules) as of
+    // the last refresh that read board or BIOS serials; safe to read once
+    // the "SMBIOS" unit has finished
+    const SmbiosInfo& smbiosInfo() const { return collector.smbiosInfo(); }
+
     SystemSerials getSystemSerials();
     SecurityStatus getSecurityStatus();
+
+    // Re-collects only the WatchComponent bits in components, leaving the
+    // other fields of serials alone (used by watch mode). Bits of components
+    // that missed the deadline are set in serials.incomplete, the rest cleared.
+    // Runs inline and makes no heap allocations once an earlier refresh has
+    // sized serials.
+    void refreshSerials(unsigned components, SystemSerials& serials);
     SystemInfo getSystemInfo();
 
+    // Runs every collector on one bounded pool; timings are optional.
+    // onCollected is called on this thread as each unit finishes (by unit
+    // name, e.g. "CPU", "Disks", "AV Products"); only the fields that unit
+    // fills are safe to read at that point.
+    void collectAll(SystemInfo& info, SystemSerials& serials, SecurityStatus& status,
+        std::vector<CollectorTiming>* timings = nullptr,
+        std::function<void(const CollectorTiming&)> onCollected = nullptr);
+
     bool saveSerials(const SystemSerials& serials, const std::string& filename = "serials.dat");
     bool loadSerials(SystemSerials& serials, const std::string& filename = "serials.dat");
     std::map<std::string, bool> compareSerials(const SystemSerials& current, const SystemSerials& saved);
 
     static std::string getCurrentTimestamp();
+    // False until collectAll or getSecurityStatus has run and connected
     bool isWMIInitialized() const { return wmiInitialized; }
 };
 
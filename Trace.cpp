@@ -0,0 +1,146 @@
+// trace.cpp
+
+#include "Trace.h"
+#include "NdjsonWriter.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+
+    struct Span {
+        const char* name;
+        uint64_t startUs;
+        uint64_t durationUs;
+        char detail[56];
+    };
+
+    // Fixed-size chunk of spans. Only the owning thread writes; count is
+    // published with release so readers see complete entries.
+    struct Block {
+        static const size_t Capacity = 1024;
+        Span spans[Capacity];
+        std::atomic<size_t> count;
+        std::atomic<Block*> next;
+
+        Block() : count(0), next(nullptr) {}
+    };
+
+    struct ThreadBuffer {
+        uint32_t tid;
+        Block* head;
+        Block* tail; // owner thread only
+        ThreadBuffer* nextBuffer;
+
+        explicit ThreadBuffer(uint32_t tid) : tid(tid), head(new Block()), tail(head), nextBuffer(nullptr) {}
+    };
+
+    std::atomic<bool> enabled(false);
+    std::atomic<ThreadBuffer*> buffers(nullptr); // every thread that ever traced, newest first
+    std::atomic<uint32_t> nextTid(1);
+    const auto epoch = std::chrono::steady_clock::now();
+
+    // Buffers are never freed: pool threads come and go, but their spans
+    // have to survive until the trace is written
+    ThreadBuffer* threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            buffer = new ThreadBuffer(nextTid.fetch_add(1, std::memory_order_relaxed));
+            ThreadBuffer* head = buffers.load(std::memory_order_relaxed);
+            do {
+                buffer->nextBuffer = head;
+            } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+        }
+        return buffer;
+    }
+}
+
+void Trace::enable(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+bool Trace::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Trace::nowMicros() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, std::string_view detail, uint64_t startUs, uint64_t durationUs) {
+    ThreadBuffer* buffer = threadBuffer();
+    Block* block = buffer->tail;
+    size_t n = block->count.load(std::memory_order_relaxed);
+    if (n == Block::Capacity) {
+        Block* fresh = new Block();
+        block->next.store(fresh, std::memory_order_release);
+        buffer->tail = block = fresh;
+        n = 0;
+    }
+
+    Span& span = block->spans[n];
+    span.name = name;
+    span.startUs = startUs;
+    span.durationUs = durationUs;
+    size_t len = detail.size() < sizeof(span.detail) - 1 ? detail.size() : sizeof(span.detail) - 1;
+    memcpy(span.detail, detail.data(), len);
+    span.detail[len] = '\0';
+
+    block->count.store(n + 1, std::memory_order_release);
+}
+
+size_t Trace::spanCount() {
+    size_t total = 0;
+    for (ThreadBuffer* b = buffers.load(std::memory_order_acquire); b; b = b->nextBuffer) {
+        for (Block* block = b->head; block; block = block->next.load(std::memory_order_acquire))
+            total += block->count.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+bool Trace::writeChromeJson(const std::string& path) {
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (fopen_s(&file, path.c_str(), "wb") != 0) file = nullptr;
+#else
+    file = fopen(path.c_str(), "wb");
+#endif
+    if (!file) return false;
+
+    bool ok;
+    {
+        NdjsonWriter out(file, 256 * 1024);
+        out.beginRecord();
+        out.field("displayTimeUnit", "ms");
+        out.key("traceEvents");
+        out.beginArray();
+        for (ThreadBuffer* b = buffers.load(std::memory_order_acquire); b; b = b->nextBuffer) {
+            for (Block* block = b->head; block; block = block->next.load(std::memory_order_acquire)) {
+                size_t count = block->count.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; i++) {
+                    const Span& span = block->spans[i];
+                    out.beginObject();
+                    out.field("name", span.name);
+                    out.field("ph", "X");
+                    out.field("ts", (long long)span.startUs);
+                    out.field("dur", (long long)span.durationUs);
+                    out.field("pid", 1LL);
+                    out.field("tid", (long long)b->tid);
+                    if (span.detail[0]) {
+                        out.key("args");
+                        out.beginObject();
+                        out.field("detail", span.detail);
+                        out.endObject();
+                    }
+                    out.endObject();
+                }
+            }
+        }
+        out.endArray();
+        out.endRecord();
+        ok = out.flush();
+    }
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Lightweight span tracing for diagnosing slow hosts in the field.
+//
+// Each thread appends finished spans to its own buffer (single writer, no
+// locks); the exporter walks every buffer and writes Chrome trace JSON,
+// which loads in chrome://tracing or https://ui.perfetto.dev. While tracing
+// is disabled a span costs one relaxed atomic load.
+namespace Trace {
+
+    void enable(bool on = true);
+    bool isEnabled();
+
+    // Microseconds since the process's trace epoch
+    uint64_t nowMicros();
+
+    // Records a finished span on the calling thread. name must outlive the
+    // trace (string literals); detail is copied and truncated.
+    void record(const char* name, std::string_view detail, uint64_t startUs, uint64_t durationUs);
+
+    // Writes every span recorded so far. Safe to call while other threads
+    // are still tracing; spans still in flight are simply not included.
+    bool writeChromeJson(const std::string& path);
+
+    size_t spanCount();
+}
+
+// Records the enclosing scope as one span: TraceSpan span("WMI ExecQuery", wmiClass);
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::string_view detail = std::string_view())
+        : name(name), detail(detail), start(Trace::isEnabled() ? Trace::nowMicros() : NotTracing) {}
+
+    ~TraceSpan() {
+        if (start != NotTracing) Trace::record(name, detail, start, Trace::nowMicros() - start);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    static const uint64_t NotTracing = ~0ull;
+
+    const char* name;
+    std::string_view detail; // must stay valid for the scope
+    uint64_t start;
+};
+
+#endif // TRACE_H
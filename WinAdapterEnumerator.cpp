@@ -0,0 +1,66 @@
+// winadapterenumerator.cpp
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <iphlpapi.h>
+#include "WinAdapterEnumerator.h"
+#include "SerialFormat.h"
+#include "Trace.h"
+
+#pragma comment(lib, "iphlpapi.lib")
+
+// Microsoft's suggested starting size; covers most hosts in one call
+static const size_t InitialBufferSize = 15 * 1024;
+static const int MaxAttempts = 3;
+
+static void narrow(const wchar_t* text, std::string& out) {
+    int len = text ? WideCharToMultiByte(CP_UTF8, 0, text, -1, NULL, 0, NULL, NULL) : 0;
+    if (len <= 1) {
+        out.clear();
+        return;
+    }
+    out.resize((size_t)len - 1);
+    WideCharToMultiByte(CP_UTF8, 0, text, -1, &out[0], len, NULL, NULL); // the NUL lands on out[size()]
+}
+
+static bool isZero(const BYTE* bytes, ULONG length) {
+    for (ULONG i = 0; i < length; i++) {
+        if (bytes[i]) return false;
+    }
+    return true;
+}
+
+bool WinAdapterEnumerator::enumerate(std::vector<AdapterInfo>& adapters) {
+    TraceSpan span("GetAdaptersAddresses");
+    const ULONG flags = GAA_FLAG_SKIP_UNICAST | GAA_FLAG_SKIP_ANYCAST | GAA_FLAG_SKIP_MULTICAST | GAA_FLAG_SKIP_DNS_SERVER;
+    if (buffer.empty()) buffer.resize(InitialBufferSize / sizeof(ULONGLONG));
+
+    ULONG result = ERROR_BUFFER_OVERFLOW;
+    for (int attempt = 0; attempt < MaxAttempts && result == ERROR_BUFFER_OVERFLOW; attempt++) {
+        ULONG size = (ULONG)(buffer.size() * sizeof(ULONGLONG));
+        result = GetAdaptersAddresses(AF_UNSPEC, flags, NULL, (PIP_ADAPTER_ADDRESSES)buffer.data(), &size);
+        if (result == ERROR_BUFFER_OVERFLOW) buffer.resize(size / sizeof(ULONGLONG) + 1);
+    }
+    if (result != NO_ERROR) {
+        adapters.clear();
+        return result == ERROR_NO_DATA; // no adapters at all
+    }
+
+    size_t count = 0;
+    for (auto a = (PIP_ADAPTER_ADDRESSES)buffer.data(); a; a = a->Next) {
+        if (a->PhysicalAddressLength != 6 || isZero(a->PhysicalAddress, 6)) continue;
+        if (count == adapters.size()) adapters.emplace_back();
+        AdapterInfo& adapter = adapters[count++];
+        adapter.luid = a->Luid.Value;
+        adapter.index = a->IfIndex;
+        narrow(a->FriendlyName, adapter.name);
+        if (adapter.name.empty()) adapter.name = "Unknown";
+        narrow(a->Description, adapter.description);
+        formatMac(a->PhysicalAddress, 6, adapter.mac);
+    }
+    finishAdapters(adapters, count);
+    return true;
+}
+
+#endif // _WIN32
@@ -0,0 +1,25 @@
+#pragma once
+#ifndef WIN_ADAPTER_ENUMERATOR_H
+#define WIN_ADAPTER_ENUMERATOR_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <vector>
+#include "AdapterEnumerator.h"
+
+// GetAdaptersAddresses into a buffer kept across refreshes, asking it to
+// skip the unicast, anycast, multicast and DNS server lists nothing here
+// reads. One call per refresh once the buffer has grown to fit the host;
+// a size change between calls is retried at the size the API reported.
+class WinAdapterEnumerator : public AdapterEnumerator {
+public:
+    bool enumerate(std::vector<AdapterInfo>& adapters) override;
+
+private:
+    std::vector<ULONGLONG> buffer; // 8-byte aligned, as IP_ADAPTER_ADDRESSES needs
+};
+
+#endif // _WIN32
+
+#endif // WIN_ADAPTER_ENUMERATOR_H
@@ -0,0 +1,150 @@
+// winchangesource.cpp
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2ipdef.h>
+#include <iphlpapi.h>
+#include <cfgmgr32.h>
+#include "WinChangeSource.h"
+#include "WmiSession.h"
+
+#pragma comment(lib, "cfgmgr32.lib")
+#pragma comment(lib, "iphlpapi.lib")
+
+// GUID_DEVINTERFACE_DISK, spelled out to avoid pulling in initguid.h
+static const GUID DiskInterfaceGuid = { 0x53f56307, 0xb6bf, 0x11d0, { 0x94, 0xf2, 0x00, 0xa0, 0xc9, 0x1e, 0xfb, 0x8b } };
+
+struct WinChangeCallbacks {
+    static DWORD CALLBACK onDeviceChange(HCMNOTIFICATION, PVOID context, CM_NOTIFY_ACTION action,
+        PCM_NOTIFY_EVENT_DATA, DWORD) {
+        if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL || action == CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL)
+            static_cast<WinChangeSource*>(context)->post(WatchDisks);
+        return ERROR_SUCCESS;
+    }
+
+    static void WINAPI onInterfaceChange(PVOID context, PMIB_IPINTERFACE_ROW, MIB_NOTIFICATION_TYPE type) {
+        if (type != MibInitialNotification)
+            static_cast<WinChangeSource*>(context)->post(WatchAdapters);
+    }
+};
+
+WinChangeSource::WinChangeSource() : diskNotification(NULL), ipNotification(NULL), stopEvent(NULL), stopping(false) {
+}
+
+WinChangeSource::~WinChangeSource() {
+    stop();
+}
+
+bool WinChangeSource::start() {
+    stop();
+    stopping = false;
+    stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!stopEvent) return false;
+
+    CM_NOTIFY_FILTER filter = {};
+    filter.cbSize = sizeof(filter);
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+    filter.u.DeviceInterface.ClassGuid = DiskInterfaceGuid;
+    HCMNOTIFICATION hNotify = NULL;
+    if (CM_Register_Notification(&filter, this, WinChangeCallbacks::onDeviceChange, &hNotify) == CR_SUCCESS)
+        diskNotification = hNotify;
+
+    if (NotifyIpInterfaceChange(AF_UNSPEC, WinChangeCallbacks::onInterfaceChange, this, FALSE, &ipNotification) != NO_ERROR)
+        ipNotification = NULL;
+
+    registryThread = std::thread(&WinChangeSource::watchRegistry, this);
+    wmiThread = std::thread(&WinChangeSource::watchWmi, this);
+    return true;
+}
+
+void WinChangeSource::stop() {
+    stopping = true;
+    if (stopEvent) SetEvent(stopEvent);
+    if (registryThread.joinable()) registryThread.join();
+    if (wmiThread.joinable()) wmiThread.join();
+
+    if (diskNotification) CM_Unregister_Notification((HCMNOTIFICATION)diskNotification);
+    if (ipNotification) CancelMibChangeNotify2(ipNotification);
+    if (stopEvent) CloseHandle(stopEvent);
+    diskNotification = NULL;
+    ipNotification = NULL;
+    stopEvent = NULL;
+}
+
+void WinChangeSource::watchRegistry() {
+    HKEY hKey;
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\BIOS", 0, KEY_NOTIFY, &hKey) != ERROR_SUCCESS)
+        return;
+
+    HANDLE regEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (regEvent) {
+        HANDLE handles[2] = { regEvent, stopEvent };
+        while (!stopping) {
+            if (RegNotifyChangeKeyValue(hKey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+                regEvent, TRUE) != ERROR_SUCCESS)
+                break;
+            if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+                break; // stop requested
+            post(WatchBios | WatchMotherboard);
+        }
+        CloseHandle(regEvent);
+    }
+    RegCloseKey(hKey);
+}
+
+void WinChangeSource::watchWmi() {
+    HRESULT hres = CoInitializeEx(0, COINIT_MULTITHREADED);
+    if (FAILED(hres)) return;
+
+    {
+        WmiSessionManager wmi;
+        IWbemServices* pSvc = wmi.initialize() ? wmi.getServices(L"ROOT\\CIMV2") : NULL;
+
+        // Only fire when the serial itself changes, not on every load/clock update
+        struct EventQuery {
+            const wchar_t* query;
+            unsigned component;
+            IEnumWbemClassObject* pEnumerator;
+        } queries[] = {
+            { L"SELECT * FROM __InstanceModificationEvent WITHIN 5 WHERE TargetInstance ISA 'Win32_Processor' "
+              L"AND TargetInstance.ProcessorId <> PreviousInstance.ProcessorId", WatchCpu, NULL },
+            { L"SELECT * FROM __InstanceModificationEvent WITHIN 5 WHERE TargetInstance ISA 'Win32_BaseBoard' "
+              L"AND TargetInstance.SerialNumber <> PreviousInstance.SerialNumber", WatchMotherboard, NULL },
+            { L"SELECT * FROM __InstanceModificationEvent WITHIN 5 WHERE TargetInstance ISA 'Win32_BIOS' "
+              L"AND TargetInstance.SerialNumber <> PreviousInstance.SerialNumber", WatchBios, NULL },
+        };
+
+        bool any = false;
+        for (auto& q : queries) {
+            if (!pSvc) break;
+            BSTR bstrQuery = SysAllocString(q.query);
+            if (FAILED(pSvc->ExecNotificationQuery(bstr_t("WQL"), bstrQuery,
+                WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &q.pEnumerator)))
+                q.pEnumerator = NULL;
+            SysFreeString(bstrQuery);
+            any = any || q.pEnumerator;
+        }
+
+        // Short timeouts so stop() is noticed promptly
+        while (any && !stopping) {
+            for (auto& q : queries) {
+                if (!q.pEnumerator) continue;
+                IWbemClassObject* pEvent = NULL;
+                ULONG uReturn = 0;
+                q.pEnumerator->Next(200, 1, &pEvent, &uReturn);
+                if (uReturn) {
+                    post(q.component);
+                    pEvent->Release();
+                }
+            }
+        }
+
+        for (auto& q : queries) {
+            if (q.pEnumerator) q.pEnumerator->Release();
+        }
+    }
+    CoUninitialize();
+}
+
+#endif // _WIN32
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef WIN_CHANGE_SOURCE_H
+#define WIN_CHANGE_SOURCE_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <thread>
+#include <atomic>
+#include "ChangeSource.h"
+
+// Watch-mode notifications from the OS:
+//   disks     CM_Register_Notification on the disk device interface
+//   adapters  NotifyIpInterfaceChange
+//   BIOS      RegNotifyChangeKeyValue on HARDWARE\DESCRIPTION\System\BIOS
+//             (the key getBiosSerial/getMotherboardSerial read)
+//   WMI       __InstanceModificationEvent on the processor, baseboard and
+//             BIOS serial properties
+class WinChangeSource : public QueuedChangeSource {
+public:
+    WinChangeSource();
+    ~WinChangeSource();
+
+    bool start() override;
+    void stop() override;
+
+private:
+    void* diskNotification; // HCMNOTIFICATION
+    HANDLE ipNotification;
+    HANDLE stopEvent;
+    std::atomic<bool> stopping;
+    std::thread registryThread;
+    std::thread wmiThread;
+
+    void watchRegistry();
+    void watchWmi();
+
+    friend struct WinChangeCallbacks;
+};
+
+#endif // _WIN32
+
+#endif // WIN_CHANGE_SOURCE_H
@@ -0,0 +1,184 @@
+// windiskenumerator.cpp
+
+#ifdef _WIN32
+
+#include "WinDiskEnumerator.h"
+#include "Trace.h"
+#include <winioctl.h>
+#include <cfgmgr32.h>
+#include <cstring>
+#include <cwchar>
+
+#pragma comment(lib, "cfgmgr32.lib")
+
+// GUID_DEVINTERFACE_DISK, spelled out to avoid pulling in initguid.h
+static const GUID DiskInterfaceGuid = { 0x53f56307, 0xb6bf, 0x11d0, { 0x94, 0xf2, 0x00, 0xa0, 0xc9, 0x1e, 0xfb, 0x8b } };
+
+// A driver reporting more than this is broken; parse what it gave instead
+static const size_t MaxDescriptorSize = 64 * 1024;
+
+struct WinDiskEnumerator::Device {
+    OVERLAPPED overlapped;
+    HANDLE handle;
+    const wchar_t* path;               // into interfaceList
+    std::vector<unsigned char> buffer; // grow-only
+    DWORD returned;
+    bool pending;
+    bool answered;
+
+    Device() : handle(INVALID_HANDLE_VALUE), path(NULL), returned(0), pending(false), answered(false) {
+        memset(&overlapped, 0, sizeof(overlapped));
+    }
+};
+
+static void narrow(const wchar_t* text, std::string& out) {
+    int len = WideCharToMultiByte(CP_UTF8, 0, text, -1, NULL, 0, NULL, NULL);
+    if (len <= 1) {
+        out.clear();
+        return;
+    }
+    out.resize((size_t)len - 1);
+    WideCharToMultiByte(CP_UTF8, 0, text, -1, &out[0], len, NULL, NULL); // the NUL lands on out[size()]
+}
+
+WinDiskEnumerator::WinDiskEnumerator() : port(NULL) {
+}
+
+WinDiskEnumerator::~WinDiskEnumerator() {
+    if (port) CloseHandle(port);
+}
+
+bool WinDiskEnumerator::listInterfaces() {
+    TraceSpan span("Disk Interfaces");
+    paths.clear();
+    CONFIGRET result;
+    do {
+        ULONG length = 0;
+        if (CM_Get_Device_Interface_List_SizeW(&length, (LPGUID)&DiskInterfaceGuid, NULL,
+            CM_GET_DEVICE_INTERFACE_LIST_PRESENT) != CR_SUCCESS)
+            return false;
+        if (interfaceList.size() < length) interfaceList.resize(length);
+        result = CM_Get_Device_Interface_ListW((LPGUID)&DiskInterfaceGuid, NULL, interfaceList.data(),
+            (ULONG)interfaceList.size(), CM_GET_DEVICE_INTERFACE_LIST_PRESENT);
+    } while (result == CR_BUFFER_SMALL); // a disk arrived between the two calls
+    if (result != CR_SUCCESS || interfaceList.empty()) return false;
+
+    // NUL-separated, ends with an empty string
+    for (const wchar_t* p = interfaceList.data(); *p; p += wcslen(p) + 1) paths.push_back(p);
+    return true;
+}
+
+bool WinDiskEnumerator::issue(Device& device) {
+    // METHOD_BUFFERED: the query is copied at issue, only the output buffer
+    // has to outlive the request
+    STORAGE_PROPERTY_QUERY query = {};
+    query.PropertyId = StorageDeviceProperty;
+    query.QueryType = PropertyStandardQuery;
+    memset(&device.overlapped, 0, sizeof(device.overlapped));
+    if (!DeviceIoControl(device.handle, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), device.buffer.data(),
+        (DWORD)device.buffer.size(), NULL, &device.overlapped) && GetLastError() != ERROR_IO_PENDING)
+        return false;
+    // Completes through the port even when it finished synchronously
+    device.pending = true;
+    return true;
+}
+
+bool WinDiskEnumerator::enumerate(std::vector<DiskInfo>& disks, const Deadline& deadline, bool& timedOut) {
+    TraceSpan span("Disk Enumerate");
+    if (!port) port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 0);
+    if (!port || !listInterfaces()) {
+        disks.clear();
+        return false;
+    }
+    while (devices.size() < paths.size()) devices.emplace_back(new Device());
+    for (size_t i = 0; i < paths.size(); i++) {
+        Device& device = *devices[i];
+        device.path = paths[i];
+        device.handle = INVALID_HANDLE_VALUE;
+        device.returned = 0;
+        device.pending = false;
+        device.answered = false;
+    }
+
+    // Every query goes out before any is waited on
+    size_t outstanding = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (deadline.expired()) {
+            timedOut = true;
+            break;
+        }
+        Device& device = *devices[i];
+        {
+            // CreateFile itself can't be bounded; the deadline is checked around it
+            TraceSpan open("Disk CreateFile");
+            device.handle = CreateFileW(device.path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                FILE_FLAG_OVERLAPPED, NULL);
+        }
+        if (device.handle == INVALID_HANDLE_VALUE) continue;
+        if (!CreateIoCompletionPort(device.handle, port, (ULONG_PTR)i, 0)) continue;
+        if (device.buffer.size() < StorageDescriptorInitialBuffer) device.buffer.resize(StorageDescriptorInitialBuffer);
+        if (issue(device)) outstanding++;
+    }
+
+    // Completions in whatever order the disks answer. A descriptor that
+    // didn't fit is asked again at the size it reported.
+    auto complete = [&](BOOL ok, DWORD bytes, Device& device, bool retry) {
+        device.pending = false;
+        outstanding--;
+        if (!ok) return;
+        size_t required = storageDescriptorSize(device.buffer.data(), bytes);
+        if (retry && required > device.buffer.size() && required <= MaxDescriptorSize) {
+            device.buffer.resize(required);
+            if (issue(device)) outstanding++;
+            return;
+        }
+        device.returned = bytes;
+        device.answered = true;
+    };
+    {
+        TraceSpan wait("Disk IOCTLs");
+        while (outstanding > 0) {
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            LPOVERLAPPED ov = NULL;
+            DWORD waitMs = deadline.isSet() ? (DWORD)deadline.remainingMs() : INFINITE;
+            BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &ov, waitMs);
+            if (!ov) {
+                timedOut = true;
+                break;
+            }
+            complete(ok, bytes, *devices[key], true);
+        }
+    }
+
+    if (outstanding > 0) {
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (devices[i]->pending) CancelIoEx(devices[i]->handle, &devices[i]->overlapped);
+        }
+        // The buffers are the drivers' until each cancel lands
+        while (outstanding > 0) {
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            LPOVERLAPPED ov = NULL;
+            BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &ov, INFINITE);
+            if (!ov) break;
+            complete(ok, bytes, *devices[key], false);
+        }
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        Device& device = *devices[i];
+        if (device.handle != INVALID_HANDLE_VALUE) CloseHandle(device.handle);
+        device.handle = INVALID_HANDLE_VALUE;
+
+        if (!device.answered) continue;
+        if (count == disks.size()) disks.emplace_back();
+        if (!parseStorageDescriptor(device.buffer.data(), device.returned, disks[count])) continue;
+        narrow(device.path, disks[count++].path);
+    }
+    disks.resize(count);
+    return true;
+}
+
+#endif // _WIN32
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef WIN_DISK_ENUMERATOR_H
+#define WIN_DISK_ENUMERATOR_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <memory>
+#include <vector>
+#include "DiskEnumerator.h"
+
+// Disks from the disk device interface list (CM_Get_Device_Interface_List),
+// so there is no PhysicalDriveN range to guess. Every device is opened
+// overlapped and bound to one completion port, all the
+// IOCTL_STORAGE_QUERY_PROPERTY requests are issued before waiting on any,
+// and a descriptor larger than its buffer is re-queried at the size it
+// reported. A refresh takes as long as the slowest disk; devices still
+// pending at the deadline are cancelled.
+//
+// The interface list, descriptor buffers and the DiskInfo strings are
+// kept across calls, so a refresh of the same disks doesn't allocate. Not
+// thread-safe; give each collector its own instance.
+class WinDiskEnumerator : public DiskEnumerator {
+public:
+    WinDiskEnumerator();
+    ~WinDiskEnumerator();
+
+    WinDiskEnumerator(const WinDiskEnumerator&) = delete;
+    WinDiskEnumerator& operator=(const WinDiskEnumerator&) = delete;
+
+    bool enumerate(std::vector<DiskInfo>& disks, const Deadline& deadline, bool& timedOut) override;
+
+private:
+    struct Device;
+
+    HANDLE port;
+    std::vector<wchar_t> interfaceList;
+    std::vector<const wchar_t*> paths;            // into interfaceList
+    std::vector<std::unique_ptr<Device>> devices; // stable addresses for the OVERLAPPEDs
+
+    bool listInterfaces();
+    bool issue(Device& device);
+};
+
+#endif // _WIN32
+
+#endif // WIN_DISK_ENUMERATOR_H
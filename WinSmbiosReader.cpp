@@ -0,0 +1,34 @@
+// winsmbiosreader.cpp
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include "WinSmbiosReader.h"
+#include "Trace.h"
+
+// 'RSMB', spelled out to avoid a multi-character literal
+static const DWORD RawSmbiosProvider = ((DWORD)'R' << 24) | ((DWORD)'S' << 16) | ((DWORD)'M' << 8) | (DWORD)'B';
+static const int MaxAttempts = 3;
+
+bool WinSmbiosReader::fetch(std::vector<unsigned char>& raw) {
+    TraceSpan span("GetSystemFirmwareTable", "RSMB");
+    raw.resize(raw.capacity());
+    for (int attempt = 0; attempt < MaxAttempts; attempt++) {
+        // Returns the bytes written, or the size needed if that's more than the buffer
+        UINT size = GetSystemFirmwareTable(RawSmbiosProvider, 0, raw.empty() ? NULL : raw.data(), (DWORD)raw.size());
+        if (size == 0) break;
+        if (size <= raw.size()) {
+            raw.resize(size);
+            return true;
+        }
+        raw.resize(size);
+    }
+    raw.clear();
+    return false;
+}
+
+std::unique_ptr<SmbiosReader> createSmbiosReader() {
+    return std::unique_ptr<SmbiosReader>(new WinSmbiosReader());
+}
+
+#endif // _WIN32
@@ -0,0 +1,19 @@
+#pragma once
+#ifndef WIN_SMBIOS_READER_H
+#define WIN_SMBIOS_READER_H
+
+#ifdef _WIN32
+
+#include "SmbiosReader.h"
+
+// GetSystemFirmwareTable('RSMB'): the whole table in one call, no WMI
+// service and no elevation needed. The buffer is sized from the first call
+// and kept; a table that grew in between is fetched again at the new size.
+class WinSmbiosReader : public SmbiosReader {
+public:
+    bool fetch(std::vector<unsigned char>& raw) override;
+};
+
+#endif // _WIN32
+
+#endif // WIN_SMBIOS_READER_H
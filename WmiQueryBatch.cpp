@@ -0,0 +1,129 @@
+// wmiquerybatch.cpp
+
+#include "WmiQueryBatch.h"
+#include "Trace.h"
+
+static std::string variantToString(const VARIANT& vtProp) {
+    if (vtProp.vt == VT_BSTR) {
+        char* text = _com_util::ConvertBSTRToString(vtProp.bstrVal);
+        std::string result = text ? text : "";
+        delete[] text;
+        return result;
+    }
+    else if (vtProp.vt == VT_I4) {
+        return std::to_string(vtProp.intVal);
+    }
+    else if (vtProp.vt == VT_UI4) {
+        return std::to_string(vtProp.uintVal);
+    }
+    return "N/A";
+}
+
+WmiQueryBatch::WmiQueryBatch(IWbemServices* pSvc) : pSvc(pSvc) {
+}
+
+WmiQueryBatch::~WmiQueryBatch() {
+    for (auto& q : queries) {
+        if (q.pEnumerator) q.pEnumerator->Release();
+    }
+}
+
+WmiQueryBatch::QueryId WmiQueryBatch::add(const std::string& wmiClass,
+    const std::vector<std::string>& properties) {
+
+    Query q;
+    q.wmiClass = wmiClass;
+    q.properties = properties;
+    for (const auto& prop : properties)
+        q.wideProperties.push_back(std::wstring(prop.begin(), prop.end()));
+    q.pEnumerator = NULL;
+    q.issueResult = E_FAIL;
+    queries.push_back(q);
+    return queries.size() - 1;
+}
+
+void WmiQueryBatch::issueAll() {
+    if (!pSvc) return;
+
+    for (auto& q : queries) {
+        if (q.pEnumerator) continue;
+
+        // Only ask for the columns we read, WMI skips the rest of the class
+        std::string query = "SELECT ";
+        for (size_t i = 0; i < q.properties.size(); i++) {
+            if (i > 0) query += ", ";
+            query += q.properties[i];
+        }
+        query += " FROM " + q.wmiClass;
+        BSTR bstrQuery = SysAllocString(std::wstring(query.begin(), query.end()).c_str());
+        TraceSpan span("WMI ExecQuery", q.wmiClass);
+
+        q.issueResult = pSvc->ExecQuery(
+            bstr_t("WQL"),
+            bstrQuery,
+            WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
+            NULL,
+            &q.pEnumerator);
+
+        if (FAILED(q.issueResult)) q.pEnumerator = NULL;
+        SysFreeString(bstrQuery);
+    }
+}
+
+std::vector<WmiRow> WmiQueryBatch::drain(QueryId id, const Deadline& deadline, bool* timedOut) {
+    std::vector<WmiRow> results;
+    if (timedOut) *timedOut = false;
+    if (id >= queries.size()) return results;
+
+    Query& q = queries[id];
+    if (!q.pEnumerator) return results;
+
+    TraceSpan span("WMI Next", q.wmiClass);
+    IWbemClassObject* block[BlockSize] = { NULL };
+    for (;;) {
+        if (deadline.expired()) {
+            if (timedOut) *timedOut = true;
+            break;
+        }
+
+        // Never WBEM_INFINITE: waits come in slices of at most 250 ms so the
+        // deadline is rechecked between them. Without a deadline (--timeout 0)
+        // the slices simply repeat until the provider finishes.
+        ULONG uReturn = 0;
+        long wait = (long)deadline.remainingMs(250);
+        HRESULT hr = q.pEnumerator->Next(wait, BlockSize, block, &uReturn);
+
+        for (ULONG n = 0; n < uReturn; n++) {
+            WmiRow item;
+            for (size_t p = 0; p < q.properties.size(); p++) {
+                VARIANT vtProp;
+                VariantInit(&vtProp);
+                if (SUCCEEDED(block[n]->Get(q.wideProperties[p].c_str(), 0, &vtProp, 0, 0))) {
+                    item[q.properties[p]] = variantToString(vtProp);
+                }
+                VariantClear(&vtProp);
+            }
+            results.push_back(item);
+            block[n]->Release();
+            block[n] = NULL;
+        }
+
+        // WBEM_S_TIMEDOUT: the slice ran out, rows may still be coming.
+        // WBEM_S_FALSE means fewer than BlockSize rows were left.
+        if (hr == WBEM_S_TIMEDOUT) continue;
+        if (hr != WBEM_S_NO_ERROR || uReturn == 0) break;
+    }
+
+    q.pEnumerator->Release();
+    q.pEnumerator = NULL;
+    return results;
+}
+
+std::vector<WmiRow> WmiQueryBatch::run(IWbemServices* pSvc, const std::string& wmiClass,
+    const std::vector<std::string>& properties, const Deadline& deadline, bool* timedOut) {
+
+    WmiQueryBatch batch(pSvc);
+    QueryId id = batch.add(wmiClass, properties);
+    batch.issueAll();
+    return batch.drain(id, deadline, timedOut);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef WMI_QUERY_BATCH_H
+#define WMI_QUERY_BATCH_H
+
+#include <windows.h>
+#include <comdef.h>
+#include <Wbemidl.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "Deadline.h"
+
+typedef std::map<std::string, std::string> WmiRow;
+
+// Issues several WQL queries semisynchronously up front, then drains each
+// enumerator in blocks so a refresh costs one round-trip per block rather
+// than one per row. Queries run concurrently inside WMI while earlier ones
+// are still being drained.
+class WmiQueryBatch {
+public:
+    typedef size_t QueryId;
+
+    static const ULONG BlockSize = 64;
+
+    explicit WmiQueryBatch(IWbemServices* pSvc);
+    ~WmiQueryBatch();
+
+    WmiQueryBatch(const WmiQueryBatch&) = delete;
+    WmiQueryBatch& operator=(const WmiQueryBatch&) = delete;
+
+    QueryId add(const std::string& wmiClass, const std::vector<std::string>& properties);
+
+    // ExecQuery every added query with WBEM_FLAG_RETURN_IMMEDIATELY, which
+    // returns as soon as WMI has accepted the query
+    void issueAll();
+
+    // Pulls every row of one query. Safe to call for different ids from
+    // different MTA threads at once. Next() waits in short slices of the
+    // deadline's remaining time; if it runs out the rows read so far are
+    // returned, the enumerator is dropped and *timedOut is set.
+    std::vector<WmiRow> drain(QueryId id, const Deadline& deadline = Deadline(), bool* timedOut = nullptr);
+
+    // Single-query convenience: issue one query and drain it (AV products)
+    static std::vector<WmiRow> run(IWbemServices* pSvc, const std::string& wmiClass,
+        const std::vector<std::string>& properties, const Deadline& deadline = Deadline(),
+        bool* timedOut = nullptr);
+
+private:
+    struct Query {
+        std::string wmiClass;
+        std::vector<std::string> properties;
+        std::vector<std::wstring> wideProperties;
+        IEnumWbemClassObject* pEnumerator;
+        HRESULT issueResult;
+    };
+
+    IWbemServices* pSvc;
+    std::vector<Query> queries;
+};
+
+#endif // WMI_QUERY_BATCH_H
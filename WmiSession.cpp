@@ -0,0 +1,108 @@
+// wmisession.cpp
+
+#include "WmiSession.h"
+#include "Trace.h"
+
+WmiSessionManager::WmiSessionManager() : pLoc(NULL), connectCount(0) {
+}
+
+WmiSessionManager::~WmiSessionManager() {
+    shutdown();
+}
+
+bool WmiSessionManager::initialize() {
+    if (pLoc) return true;
+
+    HRESULT hres = CoCreateInstance(
+        CLSID_WbemLocator,
+        0,
+        CLSCTX_INPROC_SERVER,
+        IID_IWbemLocator,
+        (LPVOID*)&pLoc);
+
+    if (FAILED(hres)) {
+        pLoc = NULL;
+        return false;
+    }
+    return true;
+}
+
+void WmiSessionManager::shutdown() {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    for (auto& entry : sessions) {
+        std::lock_guard<std::mutex> sessionLock(entry.second->connectMutex);
+        if (entry.second->pSvc) entry.second->pSvc->Release();
+        entry.second->pSvc = NULL;
+    }
+    sessions.clear();
+    if (pLoc) pLoc->Release();
+    pLoc = NULL;
+}
+
+HRESULT WmiSessionManager::connect(const std::wstring& wmiNamespace, IWbemServices** ppSvc) {
+    std::string traceName;
+    for (wchar_t c : wmiNamespace) traceName += (char)c; // namespaces are ASCII
+    TraceSpan span("WMI ConnectServer", traceName);
+    BSTR bstrNamespace = SysAllocString(wmiNamespace.c_str());
+    // USE_MAX_WAIT bounds the connect to two minutes instead of forever
+    HRESULT hres = pLoc->ConnectServer(
+        bstrNamespace,
+        NULL,
+        NULL,
+        0,
+        WBEM_FLAG_CONNECT_USE_MAX_WAIT,
+        0,
+        0,
+        ppSvc
+    );
+    SysFreeString(bstrNamespace);
+
+    if (FAILED(hres)) {
+        *ppSvc = NULL;
+        return hres;
+    }
+
+    // Set proxy blanket once per connection, the proxy keeps it for every call
+    hres = CoSetProxyBlanket(
+        *ppSvc,
+        RPC_C_AUTHN_WINNT,
+        RPC_C_AUTHZ_NONE,
+        NULL,
+        RPC_C_AUTHN_LEVEL_CALL,
+        RPC_C_IMP_LEVEL_IMPERSONATE,
+        NULL,
+        EOAC_NONE
+    );
+
+    if (FAILED(hres)) {
+        (*ppSvc)->Release();
+        *ppSvc = NULL;
+        return hres;
+    }
+
+    connectCount++;
+    return S_OK;
+}
+
+IWbemServices* WmiSessionManager::getServices(const std::wstring& wmiNamespace) {
+    std::shared_ptr<Session> session;
+    {
+        // Only the map lookup is serialized across namespaces
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (!pLoc) return NULL;
+        auto& slot = sessions[wmiNamespace];
+        if (!slot) slot = std::make_shared<Session>();
+        session = slot;
+    }
+
+    // A slow namespace only blocks callers waiting on that same namespace.
+    // Failed connects aren't cached, the next refresh retries.
+    std::lock_guard<std::mutex> lock(session->connectMutex);
+    if (!session->pSvc) {
+        IWbemServices* pSvc = NULL;
+        if (SUCCEEDED(connect(wmiNamespace, &pSvc))) {
+            session->pSvc = pSvc;
+        }
+    }
+    return session->pSvc;
+}
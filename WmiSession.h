@@ -0,0 +1,50 @@
+#pragma once
+#ifndef WMI_SESSION_H
+#define WMI_SESSION_H
+
+#include <windows.h>
+#include <comdef.h>
+#include <Wbemidl.h>
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#pragma comment(lib, "wbemuuid.lib")
+
+// Keeps one connected, proxy-blanketed IWbemServices per WMI namespace.
+// Connections are made on first use and reused until shutdown(), so repeat
+// refreshes never pay for ConnectServer again. Safe to call from any thread
+// that has joined the process MTA (COINIT_MULTITHREADED).
+class WmiSessionManager {
+private:
+    struct Session {
+        std::mutex connectMutex;
+        IWbemServices* pSvc = NULL;
+    };
+
+    IWbemLocator* pLoc;
+    std::mutex sessionsMutex;
+    std::map<std::wstring, std::shared_ptr<Session>> sessions;
+    std::atomic<long> connectCount;
+
+    HRESULT connect(const std::wstring& wmiNamespace, IWbemServices** ppSvc);
+
+public:
+    WmiSessionManager();
+    ~WmiSessionManager();
+
+    WmiSessionManager(const WmiSessionManager&) = delete;
+    WmiSessionManager& operator=(const WmiSessionManager&) = delete;
+
+    bool initialize();
+    void shutdown();
+
+    // Borrowed pointer, valid until shutdown(). NULL if the namespace can't be reached.
+    IWbemServices* getServices(const std::wstring& wmiNamespace);
+
+    long connections() const { return connectCount; }
+};
+
+#endif // WMI_SESSION_H
@@ -0,0 +1,86 @@
+// workstealingpool.cpp
+
+#include "WorkStealingPool.h"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+// Which pool and worker the current thread is running tasks for
+static thread_local const WorkStealingPool* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+WorkStealingPool::WorkStealingPool(size_t threads) : pending(0), nextWorker(0), stolen(0), failed(0) {
+    if (threads == 0) threads = (std::max)((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    for (size_t i = 0; i < threads; i++) workers.emplace_back(new Worker());
+}
+
+WorkStealingPool::~WorkStealingPool() {
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t target = currentPool == this ? currentWorker : nextWorker++ % workers.size();
+    pending++;
+    Worker& worker = *workers[target];
+    std::lock_guard<std::mutex> lock(worker.lock);
+    worker.tasks.push_back(std::move(task));
+}
+
+bool WorkStealingPool::take(size_t self, Task& task) {
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Start at a different victim per worker so thieves don't all pile
+    // onto worker 0
+    size_t count = workers.size();
+    for (size_t i = 1; i < count; i++) {
+        Worker& victim = *workers[(self + i) % count];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t self) {
+    currentPool = this;
+    currentWorker = self;
+    unsigned idle = 0;
+    Task task;
+    while (pending > 0) {
+        if (!take(self, task)) {
+            // Someone still holds work that may fan out; back off while waiting
+            if (++idle < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        idle = 0;
+        try {
+            task(self);
+        }
+        catch (...) {
+            failed++;
+        }
+        task = nullptr;
+        pending--; // after the task, so anything it submitted is already counted
+    }
+    currentPool = nullptr;
+}
+
+void WorkStealingPool::run() {
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size() - 1);
+    for (size_t i = 1; i < workers.size(); i++) threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    workerLoop(0);
+    for (auto& t : threads) t.join();
+}
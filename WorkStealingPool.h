@@ -0,0 +1,60 @@
+#pragma once
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// Runs a tree of tasks across every core. Each worker owns a deque: it pushes
+// and pops its own work at the back (newest first, so a directory walk goes
+// depth-first and stays cache-warm) and, when empty, steals the oldest task
+// from the front of someone else's. Owners and thieves work at opposite ends,
+// so the per-deque lock is almost never contended, and a worker stuck on one
+// large item doesn't hold up the small ones queued behind it.
+class WorkStealingPool {
+public:
+    // Receives the index of the worker running it, for per-worker state
+    typedef std::function<void(size_t worker)> Task;
+
+    // threads == 0 uses hardware concurrency
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // From inside a task, goes to the running worker's own deque; otherwise
+    // spread round-robin
+    void submit(Task task);
+
+    // Blocks until every task, including those submitted by tasks, has run.
+    // The calling thread works as worker 0.
+    void run();
+
+    size_t threadCount() const { return workers.size(); }
+    uint64_t steals() const { return stolen; }
+    uint64_t failures() const { return failed; } // tasks that threw
+
+private:
+    struct alignas(64) Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> pending; // submitted and not yet finished
+    std::atomic<size_t> nextWorker;
+    std::atomic<uint64_t> stolen;
+    std::atomic<uint64_t> failed;
+
+    bool take(size_t self, Task& task);
+    void workerLoop(size_t self);
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,95 @@
+// bulk_bench.cpp
+//
+// Scaling check for bulk compare: writes a tree of snapshot/baseline pairs
+// (mostly workstations, a few hypervisor hosts with hundreds of disks and
+// adapters, a slice of them changed) and runs bulkCompare at increasing
+// thread counts. Portable, no Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -pthread -I. -o bulk_bench bench/bulk_bench.cpp
+//       BulkCompare.cpp WorkStealingPool.cpp NdjsonWriter.cpp SerialSnapshot.cpp
+//       SerialDiff.cpp MappedFile.cpp SerialFormat.cpp SerialFingerprint.cpp
+//       SerialNormalize.cpp
+//   ./bulk_bench [files] [max threads]
+//
+// Defaults: 20000 files, hardware concurrency.
+
+#include "../BulkCompare.h"
+#include "../SerialSnapshot.h"
+#include "../SerialFormat.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static SystemSerials makeSerials(unsigned machine, size_t disks, size_t adapters, bool changed) {
+    SystemSerials s;
+    char buf[128];
+    s.timestamp = "2024-05-01 12:00:00";
+    snprintf(buf, sizeof(buf), "BFEBFBFF%08X", 0x000906EAu + machine);
+    s.cpuId = buf;
+    snprintf(buf, sizeof(buf), "MB-%012u-ASUS-PRIME", machine);
+    s.motherboardSerial = buf;
+    snprintf(buf, sizeof(buf), "SYSTEM SERIAL %08u", machine);
+    s.biosSerial = buf;
+    for (size_t i = 0; i < disks; i++) {
+        snprintf(buf, sizeof(buf), "S4EVNF0M%06u%04zu", machine, i + (changed && i == 0 ? 5000 : 0));
+        s.diskSerials.push_back(buf);
+    }
+    for (size_t i = 0; i < adapters; i++) {
+        unsigned char bytes[6] = { 0x00, 0x15, 0x5D, (unsigned char)(machine >> 8), (unsigned char)machine, (unsigned char)i };
+        snprintf(buf, sizeof(buf), "Ethernet %zu", i);
+        s.networkAdapters.push_back(std::make_pair(std::string(buf), formatMac(bytes, 6)));
+    }
+    return s;
+}
+
+int main(int argc, char** argv) {
+    unsigned files = argc > 1 ? (unsigned)atoi(argv[1]) : 20000;
+    unsigned maxThreads = argc > 2 ? (unsigned)atoi(argv[2]) : std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+
+    std::error_code ec;
+    fs::path root = fs::temp_directory_path(ec) / "bulk_bench_tree";
+    fs::remove_all(root, ec);
+
+    // 1 in 100 is a hypervisor host, 1 in 20 changed since its baseline
+    const unsigned perDirectory = 500;
+    for (unsigned i = 0; i < files; i++) {
+        std::string dir = "site" + std::to_string(i / perDirectory);
+        if (i % perDirectory == 0) {
+            fs::create_directories(root / "current" / dir, ec);
+            fs::create_directories(root / "baseline" / dir, ec);
+        }
+        bool large = i % 100 == 0;
+        size_t disks = large ? 400 : 2;
+        size_t adapters = large ? 300 : 3;
+        std::string name = "host-" + std::to_string(i) + ".dat";
+        SerialSnapshot::writeFile(makeSerials(i, disks, adapters, i % 20 == 0), (root / "current" / dir / name).string());
+        SerialSnapshot::writeFile(makeSerials(i, disks, adapters, false), (root / "baseline" / dir / name).string());
+    }
+
+    printf("%u snapshot pairs\n", files);
+    double baseline = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        BulkCompareOptions options;
+        options.currentDir = (root / "current").string();
+        options.baselineDir = (root / "baseline").string();
+        options.threads = threads;
+        options.out = nullptr;
+        BulkCompareStats stats = bulkCompare(options);
+
+        double rate = stats.files / stats.seconds;
+        if (threads == 1) baseline = rate;
+        printf("  %2u threads: %8.0f files/s  x%.2f  (%llu changed, %llu errors, %llu steals)\n", threads, rate,
+            baseline > 0 ? rate / baseline : 0.0, (unsigned long long)stats.changed,
+            (unsigned long long)stats.errors, (unsigned long long)stats.steals);
+        if (threads < maxThreads && threads * 2 > maxThreads) threads = maxThreads / 2; // end on maxThreads
+    }
+
+    fs::remove_all(root, ec);
+    return 0;
+}
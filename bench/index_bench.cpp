@@ -0,0 +1,115 @@
+// index_bench.cpp
+//
+// SerialIndex at fleet scale: builds the index for a synthetic fleet with
+// realistic collisions ("Default string" firmware, a few CPU models, cloned
+// disks, a spoofed MAC), then times queries and incremental updates.
+// Portable, no Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -I. -o index_bench bench/index_bench.cpp
+//       SerialIndex.cpp StringPool.cpp SerialSnapshot.cpp SerialDiff.cpp
+//       MappedFile.cpp SerialFormat.cpp SerialFingerprint.cpp SerialNormalize.cpp
+//   ./index_bench [machines]
+//
+// Default: 1000000 machines.
+
+#include "../SerialIndex.h"
+#include "../SerialFormat.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static void makeMachine(unsigned machine, unsigned generation, SystemSerials& s) {
+    static const char* cpus[] = { "BFEBFBFF000B0649", "BFEBFBFF000906EA", "178BFBFF00A20F12", "BFEBFBFF000A0671",
+        "BFEBFBFF000806EC", "178BFBFF00870F10", "BFEBFBFF000906ED", "BFEBFBFF000B0671" };
+    char buf[64];
+    s.timestamp = "2024-05-01 12:00:00";
+    s.cpuId = cpus[machine % 8];
+    snprintf(buf, sizeof(buf), "MB%010u", machine);
+    s.motherboardSerial = machine % 20 == 0 ? "Default string" : buf;
+    s.biosSerial = machine % 3 == 0 ? "Default string" : "To be filled by O.E.M.";
+    s.diskSerials.resize(2);
+    snprintf(buf, sizeof(buf), "S4EVNF0M%08u0", machine % 1000 == 1 ? 1 : machine); // cloned image
+    s.diskSerials[0] = buf;
+    snprintf(buf, sizeof(buf), "S4EVNF0M%08u1G%u", machine, generation);
+    s.diskSerials[1] = buf;
+    s.networkAdapters.resize(3);
+    for (unsigned a = 0; a < 3; a++) {
+        unsigned m = (a == 0 && machine % 20000 == 7) ? 7 : machine; // spoofed MAC
+        unsigned char bytes[6] = { 0xD8, 0x44, (unsigned char)(m >> 16), (unsigned char)(m >> 8), (unsigned char)m, (unsigned char)a };
+        s.networkAdapters[a].first = "Ethernet";
+        s.networkAdapters[a].second = formatMac(bytes, 6);
+    }
+}
+
+template <typename F>
+static double timeNs(size_t iterations, F f) {
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < iterations; i++) f(i);
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)iterations;
+}
+
+int main(int argc, char** argv) {
+    unsigned machines = argc > 1 ? (unsigned)atoi(argv[1]) : 1000000;
+    if (machines < 1000) machines = 1000;
+
+    SerialIndex index;
+    SystemSerials s;
+    std::vector<std::string> names(machines);
+    for (unsigned m = 0; m < machines; m++) names[m] = "host-" + std::to_string(m);
+
+    double buildNs = timeNs(machines, [&](size_t m) {
+        makeMachine((unsigned)m, 0, s);
+        index.update(names[m], s);
+    });
+    printf("%u machines: build %.0f ns/machine (incl. generating serials), %.1f MB, %.0f bytes/machine\n",
+        machines, buildNs, index.memoryUsage() / (1024.0 * 1024.0), (double)index.memoryUsage() / machines);
+
+    size_t shared = 0;
+    index.forEachShared(2, [&](SerialComponent, std::string_view, size_t) { shared++; });
+    printf("  %zu values shared by 2+ machines\n\n", shared);
+
+    std::vector<SerialIndex::MachineId> out;
+    std::vector<std::string> uniqueDisks(1000);
+    for (size_t i = 0; i < uniqueDisks.size(); i++) {
+        makeMachine((unsigned)(i * 997 % machines), 0, s);
+        uniqueDisks[i] = s.diskSerials[1];
+    }
+    makeMachine(7, 0, s);
+    std::string spoofedMac = s.networkAdapters[0].second;
+    makeMachine(1, 0, s);
+    std::string clonedDisk = s.diskSerials[0];
+
+    size_t sink = 0;
+    printf("%-44s %10s %10s\n", "query", "ns/query", "machines");
+    auto query = [&](const char* name, SerialComponent component, const std::string& value, size_t iterations) {
+        double ns = timeNs(iterations, [&](size_t) { sink += index.machinesWith(component, value, out); });
+        printf("%-44s %10.0f %10zu\n", name, ns, out.size());
+    };
+    double uniqueNs = timeNs(100000, [&](size_t i) {
+        sink += index.machinesWith(SerialComponent::Disk, uniqueDisks[i % uniqueDisks.size()], out);
+    });
+    printf("%-44s %10.0f %10zu\n", "machinesWith unique disk", uniqueNs, out.size());
+    query("machinesWith cloned disk image", SerialComponent::Disk, clonedDisk, 100000);
+    query("machinesWith spoofed MAC", SerialComponent::NetworkAdapter, spoofedMac, 100000);
+    query("machinesWith BIOS \"Default string\"", SerialComponent::BiosSerial, "Default string", 20);
+    double countNs = timeNs(100000, [&](size_t) { sink += index.countWith(SerialComponent::BiosSerial, "Default string"); });
+    printf("%-44s %10.0f %10zu\n", "countWith BIOS \"Default string\"", countNs,
+        index.countWith(SerialComponent::BiosSerial, "Default string"));
+
+    // Incremental: a disk swap on 10% of the fleet
+    size_t updates = machines / 10;
+    double updateNs = timeNs(updates, [&](size_t i) {
+        unsigned m = (unsigned)(i * 10);
+        makeMachine(m, 1, s);
+        index.update(names[m], s);
+    });
+    printf("\nincremental update (one disk changed): %.0f ns/machine (incl. generating serials)\n", updateNs);
+    printf("after updates: %.1f MB\n", index.memoryUsage() / (1024.0 * 1024.0));
+    return sink == 0xFFFFFFFF ? 1 : 0;
+}
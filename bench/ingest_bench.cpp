@@ -0,0 +1,188 @@
+// ingest_bench.cpp
+//
+// Load generator for the ingestion server. Starts an IngestServer in-process
+// and drives it from client threads over real sockets, each pipelining a
+// window of pushes and waiting for the acks. Portable, no Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -pthread -I. -o ingest_bench bench/ingest_bench.cpp
+//       IngestServer.cpp IngestProtocol.cpp BaselineStore.cpp SerialSnapshot.cpp
+//       SerialDiff.cpp MappedFile.cpp SerialFormat.cpp SerialFingerprint.cpp
+//       SerialNormalize.cpp NdjsonWriter.cpp SerialIndex.cpp StringPool.cpp
+//   ./ingest_bench [clients] [pushes per client] [changed %] [window] [address]
+//
+// Defaults: 8 clients, 50000 pushes each, 10% changed, window 256,
+// unix:/tmp/ingest_bench.sock (use 127.0.0.1:<port> for TCP).
+
+#include "../IngestServer.h"
+#include "../SerialSnapshot.h"
+#include "../SerialFormat.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// A typical workstation: a couple of disks and adapters
+static SystemSerials makeSerials(unsigned machine, unsigned generation) {
+    SystemSerials s;
+    char buf[128];
+    snprintf(buf, sizeof(buf), "2024-05-01 12:%02u:%02u", generation / 60 % 60, generation % 60);
+    s.timestamp = buf;
+    snprintf(buf, sizeof(buf), "BFEBFBFF%08X", 0x000906EAu + machine);
+    s.cpuId = buf;
+    snprintf(buf, sizeof(buf), "MB-%012u-ASUS-PRIME", machine);
+    s.motherboardSerial = buf;
+    snprintf(buf, sizeof(buf), "SYSTEM SERIAL %08u", machine);
+    s.biosSerial = buf;
+    for (unsigned i = 0; i < 2; i++) {
+        // Odd generations swap the second disk
+        snprintf(buf, sizeof(buf), "S4EVNF0M%06u%04u", machine, i == 1 ? i + (generation & 1) * 100 : i);
+        s.diskSerials.push_back(buf);
+    }
+    for (unsigned i = 0; i < 3; i++) {
+        unsigned char bytes[6] = { 0x00, 0x15, 0x5D, (unsigned char)(machine >> 8), (unsigned char)machine, (unsigned char)i };
+        snprintf(buf, sizeof(buf), "Ethernet %u", i);
+        s.networkAdapters.push_back(std::make_pair(std::string(buf), formatMac(bytes, 6)));
+    }
+    return s;
+}
+
+struct ClientResult {
+    size_t acked;
+    size_t statusCounts[5];
+    std::vector<double> windowMs; // time from sending a window to its last ack
+    bool failed;
+};
+
+static void runClient(const std::string& address, unsigned client, size_t pushes, unsigned changedPercent,
+    size_t window, ClientResult& result) {
+
+    const unsigned machines = 1000;
+    result = ClientResult{};
+
+    // Two encodings per machine, so sending never pays for encoding
+    std::vector<std::string> ids, same, different;
+    for (unsigned m = 0; m < machines; m++) {
+        unsigned machine = client * machines + m;
+        ids.push_back("host-" + std::to_string(machine));
+        same.push_back(SerialSnapshot::encode(makeSerials(machine, 0)));
+        different.push_back(SerialSnapshot::encode(makeSerials(machine, 1)));
+    }
+
+    std::string error;
+    IngestSocket::Handle socket = IngestSocket::connectTo(address, error);
+    if (socket == IngestSocket::Invalid) {
+        fprintf(stderr, "client %u: %s\n", client, error.c_str());
+        result.failed = true;
+        return;
+    }
+
+    std::vector<bool> current(machines, false); // which encoding the server holds
+    unsigned rng = 2463534242u + client;
+    std::string frames;
+    std::vector<char> acks(window);
+    for (size_t sent = 0; sent < pushes;) {
+        size_t count = (std::min)(window, pushes - sent);
+        frames.clear();
+        bool framed = true;
+        for (size_t i = 0; i < count && framed; i++) {
+            unsigned m = (unsigned)((sent + i) % machines);
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            if (rng % 100 < changedPercent) current[m] = !current[m];
+            framed = IngestProtocol::appendFrame(frames, ids[m], current[m] ? different[m] : same[m]);
+        }
+        if (!framed) {
+            result.failed = true;
+            break;
+        }
+
+        Clock::time_point start = Clock::now();
+        if (!IngestSocket::sendAll(socket, frames.data(), frames.size())) {
+            result.failed = true;
+            break;
+        }
+        size_t got = 0;
+        while (got < count) {
+            long n = IngestSocket::receive(socket, acks.data() + got, count - got);
+            if (n <= 0) break;
+            got += (size_t)n;
+        }
+        result.windowMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        for (size_t i = 0; i < got; i++) result.statusCounts[(unsigned char)acks[i] % 5]++;
+        result.acked += got;
+        if (got < count) {
+            result.failed = true;
+            break;
+        }
+        sent += count;
+    }
+    IngestSocket::close(socket);
+}
+
+int main(int argc, char** argv) {
+    unsigned clients = argc > 1 ? (unsigned)atoi(argv[1]) : 8;
+    size_t pushes = argc > 2 ? (size_t)atoll(argv[2]) : 50000;
+    unsigned changedPercent = argc > 3 ? (unsigned)atoi(argv[3]) : 10;
+    size_t window = argc > 4 ? (size_t)atoll(argv[4]) : 256;
+    std::string address = argc > 5 ? argv[5] : "unix:/tmp/ingest_bench.sock";
+    if (clients == 0 || window == 0) return 1;
+
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec) / "ingest_bench_store";
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+
+    IngestOptions options;
+    options.listen = address;
+    options.storePath = (dir / "fleet").string();
+    options.diffOut = nullptr; // diffs are computed, not printed
+
+    IngestServer server;
+    std::string error;
+    if (!server.start(options, error)) {
+        fprintf(stderr, "server: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (unsigned c = 0; c < clients; c++)
+        threads.emplace_back(runClient, address, c, pushes, changedPercent, window, std::ref(results[c]));
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    server.stop();
+    IngestStats stats = server.stats();
+
+    size_t acked = 0;
+    size_t counts[5] = {};
+    std::vector<double> windows;
+    bool failed = false;
+    for (const auto& r : results) {
+        acked += r.acked;
+        for (int i = 0; i < 5; i++) counts[i] += r.statusCounts[i];
+        windows.insert(windows.end(), r.windowMs.begin(), r.windowMs.end());
+        failed |= r.failed;
+    }
+    std::sort(windows.begin(), windows.end());
+    auto percentile = [&](double p) { return windows.empty() ? 0.0 : windows[(size_t)(p * (windows.size() - 1))]; };
+
+    printf("%u clients x %zu pushes, window %zu, %u%% changed, %s\n", clients, pushes, window, changedPercent, address.c_str());
+    printf("  %zu acked in %.2f s: %.0f snapshots/s\n", acked, seconds, acked / seconds);
+    printf("  new %zu, changed %zu, unchanged %zu, rejected %zu, failed %zu\n",
+        counts[IngestNew], counts[IngestChanged], counts[IngestUnchanged], counts[IngestRejected], counts[IngestFailed]);
+    printf("  %llu group commits, %.1f snapshots each\n", (unsigned long long)stats.batches,
+        stats.batches ? (double)stats.received / stats.batches : 0.0);
+    printf("  window ack latency p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", percentile(0.5), percentile(0.99), percentile(1.0));
+
+    std::filesystem::remove_all(dir, ec);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+// journal_check.cpp
+//
+// Drives SnapshotJournal through a scratch file and checks the on-disk
+// behaviour the history relies on: appends that only change the timestamp
+// write nothing, deltas carry only what changed, a checkpoint lands every
+// interval, replay rebuilds every state, a torn tail (crash mid-append) is
+// dropped on reopen, damage inside the file costs only the deltas up to the
+// next checkpoint, and damage with intact records but no checkpoint after
+// it makes open() refuse instead of truncating. Also times appends.
+// Portable, no Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -I. -o journal_check bench/journal_check.cpp
+//       SnapshotJournal.cpp SerialWatcher.cpp MappedFile.cpp
+//   ./journal_check [appends]
+//
+// Prints one line per case and exits 1 if any check failed.
+
+#include "../SnapshotJournal.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static std::string journalPath() {
+    return (std::filesystem::temp_directory_path() / "journal_check.journal").string();
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), (std::streamsize)data.size());
+}
+
+static SystemSerials machine(int step) {
+    SystemSerials s;
+    s.timestamp = "2026-10-17 12:00:" + std::to_string(step);
+    s.cpuId = "BFEBFBFF000906EA";
+    s.motherboardSerial = "MB-0001";
+    s.biosSerial = "SYS-0001";
+    s.diskSerials = { "S4EVNF0M100001", "WD-WCC7K" + std::to_string(step) };
+    s.networkAdapters = { { "Ethernet", "D8-44-89-9D-D0-08" } };
+    return s;
+}
+
+static bool sameSerials(const SystemSerials& a, const SystemSerials& b) {
+    return a.cpuId == b.cpuId && a.motherboardSerial == b.motherboardSerial && a.biosSerial == b.biosSerial &&
+        a.diskSerials == b.diskSerials && a.networkAdapters == b.networkAdapters && a.timestamp == b.timestamp;
+}
+
+static std::vector<JournalEntry> replayAll(const std::string& path) {
+    std::vector<JournalEntry> entries;
+    check(SnapshotJournal::replay(path, [&entries](const JournalEntry& e) { entries.push_back(e); }), "replay");
+    return entries;
+}
+
+// Writes states 0..count-1 with a small checkpoint interval
+static void writeHistory(const std::string& path, int count, unsigned interval) {
+    std::filesystem::remove(path);
+    SnapshotJournal journal;
+    journal.setCheckpointInterval(interval);
+    check(journal.open(path), "create");
+    for (int i = 0; i < count; i++)
+        check(journal.append(machine(i)) == SnapshotJournal::AppendResult::Written, "append written");
+}
+
+// Only real changes are written, deltas only hold what changed, replay
+// rebuilds every state in order
+static void appendAndReplay() {
+    printf("append and replay\n");
+    std::string path = journalPath();
+    std::filesystem::remove(path);
+    SnapshotJournal journal;
+    journal.setCheckpointInterval(4);
+    check(journal.open(path), "create");
+
+    SystemSerials s = machine(0);
+    check(journal.append(s) == SnapshotJournal::AppendResult::Written, "first append");
+    uint64_t afterFirst = journal.sizeBytes();
+
+    // Polls that see the same hardware cost nothing
+    for (int i = 0; i < 1000; i++) {
+        s.timestamp = "2026-10-17 13:00:" + std::to_string(i);
+        if (journal.append(s) != SnapshotJournal::AppendResult::Unchanged) {
+            check(false, "timestamp-only append is Unchanged");
+            break;
+        }
+    }
+    check(journal.sizeBytes() == afterFirst && readFile(path).size() == afterFirst, "unchanged polls don't grow");
+
+    SystemSerials partial = machine(1);
+    partial.incomplete = WatchDisks;
+    check(journal.append(partial) == SnapshotJournal::AppendResult::Failed, "incomplete refused");
+
+    // A delta carries the disks only, much smaller than the checkpoint
+    SystemSerials changed = machine(1);
+    check(journal.append(changed) == SnapshotJournal::AppendResult::Written, "delta written");
+    uint64_t deltaSize = journal.sizeBytes() - afterFirst;
+    check(deltaSize < afterFirst - 8, "delta smaller than checkpoint");
+    for (int i = 2; i < 10; i++) journal.append(machine(i));
+    journal.close();
+
+    std::vector<JournalEntry> entries = replayAll(path);
+    check(entries.size() == 10, "ten records");
+    for (size_t i = 0; i < entries.size() && i < 10; i++) {
+        check(sameSerials(entries[i].serials, machine((int)i)), "replayed state");
+        // Interval 4: checkpoint, 4 deltas, checkpoint, ...
+        check(entries[i].checkpoint == (i % 5 == 0), "checkpoint cadence");
+        if (i > 0) check(entries[i].changed == WatchDisks, "only disks changed");
+    }
+
+    // Reopening picks up where it left off
+    check(journal.open(path), "reopen");
+    check(journal.recordCount() == 10 && sameSerials(journal.latest(), machine(9)), "latest after reopen");
+    check(journal.append(machine(9)) == SnapshotJournal::AppendResult::Unchanged, "unchanged after reopen");
+}
+
+// A crash mid-append leaves part of a record: reopen drops exactly that
+static void tornTail() {
+    printf("torn tail\n");
+    std::string path = journalPath();
+    writeHistory(path, 7, 4);
+    std::string intact = readFile(path);
+    std::vector<JournalEntry> entries = replayAll(path);
+    check(entries.size() == 7, "seven records");
+    if (entries.size() != 7) return;
+
+    for (size_t cut : { (size_t)1, (size_t)5 }) {
+        size_t lastStart = (size_t)entries.back().offset;
+        writeFile(path, intact.substr(0, lastStart + cut));
+        SnapshotJournal journal;
+        check(journal.open(path), "open with torn tail");
+        check(journal.recordCount() == 6 && sameSerials(journal.latest(), machine(5)), "state before the torn record");
+        check(readFile(path).size() == lastStart, "torn bytes truncated");
+        check(journal.append(machine(6)) == SnapshotJournal::AppendResult::Written, "append after recovery");
+        journal.close();
+        std::vector<JournalEntry> again = replayAll(path);
+        check(again.size() == 7 && sameSerials(again.back().serials, machine(6)), "replay after recovery");
+    }
+}
+
+// A damaged record inside the file: the deltas up to the next checkpoint
+// are lost, everything after it survives and nothing is truncated
+static void damageBeforeCheckpoint() {
+    printf("damage before a checkpoint\n");
+    std::string path = journalPath();
+    writeHistory(path, 12, 4); // checkpoints at records 0, 5, 10
+    std::vector<JournalEntry> entries = replayAll(path);
+    if (entries.size() != 12) return check(false, "twelve records");
+
+    std::string data = readFile(path);
+    data[(size_t)entries[2].offset + 3] ^= 0x40; // inside record 2's body
+    writeFile(path, data);
+
+    std::vector<JournalEntry> survived = replayAll(path);
+    check(survived.size() == 2 + 7, "records 0-1 and 5-11 replayed");
+    if (survived.size() == 9) {
+        check(survived[2].checkpoint && survived[2].offset == entries[5].offset, "resumed at the checkpoint");
+        check(sameSerials(survived.back().serials, machine(11)), "final state intact");
+    }
+
+    SnapshotJournal journal;
+    check(journal.open(path), "open after resync");
+    check(readFile(path).size() == data.size(), "nothing truncated");
+    check(sameSerials(journal.latest(), machine(11)), "latest after resync");
+}
+
+// Damage with intact deltas but no checkpoint after it: truncating would
+// delete them, so open refuses and leaves the file as it was
+static void damageWithoutCheckpoint() {
+    printf("damage without a later checkpoint\n");
+    std::string path = journalPath();
+    writeHistory(path, 9, 4); // checkpoints at records 0 and 5
+    std::vector<JournalEntry> entries = replayAll(path);
+    if (entries.size() != 9) return check(false, "nine records");
+
+    std::string data = readFile(path);
+    data[(size_t)entries[6].offset + 3] ^= 0x40;
+    writeFile(path, data);
+
+    SnapshotJournal journal;
+    check(!journal.open(path), "open refuses");
+    check(readFile(path) == data, "file untouched");
+    check(replayAll(path).size() == 6, "replay still reads up to the damage");
+}
+
+// Appends with a change each time, through the OS but not synced
+static void appendTiming(int appends) {
+    printf("append timing\n");
+    std::string path = journalPath();
+    std::filesystem::remove(path);
+    SnapshotJournal journal;
+    check(journal.open(path), "create");
+    std::vector<SystemSerials> states;
+    for (int i = 0; i < appends; i++) states.push_back(machine(i));
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& s : states) journal.append(s);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double perAppendUs = seconds * 1e6 / appends;
+    printf("  %d appends, %.2f us each, %.1f bytes each\n", appends, perAppendUs,
+        (double)(journal.sizeBytes() - 8) / appends);
+    check(journal.recordCount() == (size_t)appends, "every append written");
+    check(perAppendUs < 1000.0, "append well under a millisecond");
+    journal.close();
+    std::filesystem::remove(path);
+}
+
+int main(int argc, char** argv) {
+    int appends = argc > 1 ? atoi(argv[1]) : 100000;
+    if (appends <= 0) appends = 100000;
+
+    appendAndReplay();
+    tornTail();
+    damageBeforeCheckpoint();
+    damageWithoutCheckpoint();
+    appendTiming(appends);
+    std::filesystem::remove(journalPath());
+
+    if (failures) {
+        printf("\n%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\nall checks passed\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+// render_check.cpp
+//
+// Checks the escape sequences ConsoleRenderer::renderDiff produces between
+// two frames: a full repaint, a one-row change touching only that row, a
+// shrink clearing the rows the old frame left behind, a grow drawing only
+// the new rows, color runs, and a frame taller than the window diffed
+// inside the rows the window shows. Also checks the plain text fallback
+// (renderPlain) used when the console has no VT support. Portable, no
+// Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -I. -o render_check bench/render_check.cpp
+//       ConsoleRenderer.cpp
+//   ./render_check
+//
+// Prints one line per case and exits 1 if any check failed.
+
+#include "../ConsoleRenderer.h"
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// Shows escapes readably when a check fails
+static std::string visible(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\x1b') out += "\\e";
+        else if (c == '\r') out += "\\r";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+static void expect(const std::string& got, const std::string& want, const char* what) {
+    check(got == want, what);
+    if (got != want) printf("    got  %s\n    want %s\n", visible(got).c_str(), visible(want).c_str());
+}
+
+static ScreenFrame frameOf(std::initializer_list<const char*> lines) {
+    ScreenFrame frame;
+    bool first = true;
+    for (const char* line : lines) {
+        if (!first) frame.write("\n");
+        frame.write(line);
+        first = false;
+    }
+    return frame;
+}
+
+// A line in default colors: SGR, text, reset, clear to end of line
+static std::string drawn(const char* text) {
+    return std::string("\x1b[0m") + text + "\x1b[0m\x1b[K";
+}
+
+static void fullRepaint() {
+    printf("full repaint\n");
+    ScreenFrame empty;
+    std::string out = ConsoleRenderer::renderDiff(empty, frameOf({ "one", "two" }), true);
+    expect(out, "\x1b[H\x1b[2J" + drawn("one") + "\r\n" + drawn("two"), "clear, then every line");
+}
+
+static void oneRowChange() {
+    printf("one row changed\n");
+    ScreenFrame before = frameOf({ "alpha", "beta", "gamma" });
+    ScreenFrame after = frameOf({ "alpha", "BETA", "gamma" });
+    std::string out = ConsoleRenderer::renderDiff(before, after, false);
+    // Row 2 rewritten, then the cursor parked after the last line's text
+    expect(out, "\x1b[2;1H" + drawn("BETA") + "\x1b[3;1H\x1b[5C", "only the changed row");
+
+    expect(ConsoleRenderer::renderDiff(after, after, false), "\x1b[3;1H\x1b[5C", "identical frame moves the cursor only");
+}
+
+static void shrink() {
+    printf("shrink\n");
+    ScreenFrame before = frameOf({ "alpha", "beta", "gamma", "delta" });
+    ScreenFrame after = frameOf({ "alpha", "beta" });
+    std::string out = ConsoleRenderer::renderDiff(before, after, false);
+    expect(out, "\x1b[3;1H\x1b[2K\x1b[4;1H\x1b[2K\x1b[2;1H\x1b[4C", "old rows erased");
+}
+
+static void grow() {
+    printf("grow\n");
+    ScreenFrame before = frameOf({ "alpha" });
+    ScreenFrame after = frameOf({ "alpha", "beta", "" });
+    std::string out = ConsoleRenderer::renderDiff(before, after, false);
+    expect(out, "\x1b[2;1H" + drawn("beta") + "\x1b[3;1H\x1b[0m\x1b[K\x1b[3;1H",
+        "new rows drawn, cursor on the empty last line");
+}
+
+static void colorRuns() {
+    printf("color runs\n");
+    ScreenFrame before = frameOf({ "" });
+    ScreenFrame after;
+    after.setAttribute(12); // bright red
+    after.write("ERR");
+    after.setAttribute(7);
+    after.write(" ok");
+    after.setAttribute(0x1E); // bright yellow on dark blue
+    after.write("!");
+    std::string out = ConsoleRenderer::renderDiff(before, after, false);
+    expect(out, "\x1b[1;1H\x1b[0;91mERR\x1b[0m ok\x1b[0;93;44m!\x1b[0m\x1b[K\x1b[1;1H\x1b[7C", "one SGR per run");
+}
+
+// Five rows in a three-row window: rows 2-4 are on screen
+static void tallFrame() {
+    printf("frame taller than the window\n");
+    ScreenFrame before = frameOf({ "r0", "r1", "r2", "r3", "r4" });
+    ScreenFrame after = frameOf({ "R0", "r1", "r2", "R3", "r4" });
+    std::string out = ConsoleRenderer::renderDiff(before, after, false, 2);
+    expect(out, "\x1b[2;1H" + drawn("R3") + "\x1b[3;1H\x1b[2C", "visible row diffed, no clear");
+    check(out.find("\x1b[2J") == std::string::npos, "no screen clear");
+}
+
+static void plain() {
+    printf("plain fallback\n");
+    ScreenFrame empty;
+    ScreenFrame prompt = frameOf({ "Serials", "Choice: " });
+    expect(ConsoleRenderer::renderPlain(empty, prompt, true), "Serials\nChoice: ", "first frame as text");
+
+    ScreenFrame answered = frameOf({ "Serials", "Choice: 2", "Working" });
+    expect(ConsoleRenderer::renderPlain(prompt, answered, false), "2\nWorking", "only what was appended");
+
+    ScreenFrame redrawn = frameOf({ "Menu" });
+    expect(ConsoleRenderer::renderPlain(answered, redrawn, false), "\nMenu", "new screen on a fresh line");
+
+    ScreenFrame colored;
+    colored.setAttribute(12);
+    colored.write("red");
+    std::string out = ConsoleRenderer::renderPlain(empty, colored, true);
+    expect(out, "red", "no escape sequences");
+}
+
+int main() {
+    fullRepaint();
+    oneRowChange();
+    shrink();
+    grow();
+    colorRuns();
+    tallFrame();
+    plain();
+
+    if (failures) {
+        printf("\n%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\nall checks passed\n");
+    return 0;
+}
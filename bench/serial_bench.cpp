@@ -0,0 +1,343 @@
+// serial_bench.cpp
+//
+// Micro-benchmarks for the paths that handle fleet-scale volumes: baseline
+// save/load (current snapshot format and both legacy formats), comparison
+// and the collectors' hex formatting. Portable, no Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -I. -o serial_bench bench/serial_bench.cpp
+//       SerialSnapshot.cpp SerialDiff.cpp MappedFile.cpp SerialFormat.cpp
+//       SerialFingerprint.cpp SerialNormalize.cpp StringPool.cpp CompactSnapshot.cpp
+//       AllocationCounter.cpp
+//   ./serial_bench
+//
+// Optional argument: a substring to run only matching cases.
+
+#include "../SerialSnapshot.h"
+#include "../SerialDiff.h"
+#include "../SerialFormat.h"
+#include "../SerialNormalize.h"
+#include "../CompactSnapshot.h"
+#include "../AllocationCounter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// ---- synthetic data -----------------------------------------------------
+
+// Shape of a busy hypervisor host: many disks, dozens of virtual adapters
+// with long friendly names
+static SystemSerials makeSerials(unsigned seed, size_t disks = 48, size_t adapters = 40) {
+    SystemSerials s;
+    char buf[128];
+    s.timestamp = "2024-05-01 12:00:00";
+    snprintf(buf, sizeof(buf), "BFEBFBFF%08X", 0x000906EAu + seed);
+    s.cpuId = buf;
+    snprintf(buf, sizeof(buf), "MB-%012u-ASUS-PRIME", seed);
+    s.motherboardSerial = buf;
+    snprintf(buf, sizeof(buf), "System Serial Number %08u", seed);
+    s.biosSerial = buf;
+    for (size_t i = 0; i < disks; i++) {
+        snprintf(buf, sizeof(buf), "S4EVNF0M%06u%04zuW - Samsung SSD 970 EVO Plus 1TB", seed, i);
+        s.diskSerials.push_back(buf);
+    }
+    for (size_t i = 0; i < adapters; i++) {
+        char name[128], mac[32];
+        snprintf(name, sizeof(name), "Hyper-V Virtual Ethernet Adapter #%zu (vEthernet Tenant Switch %zu)", i, i % 7);
+        unsigned char bytes[6] = { 0x00, 0x15, 0x5D, (unsigned char)seed, (unsigned char)(i >> 8), (unsigned char)i };
+        snprintf(mac, sizeof(mac), "%s", formatMac(bytes, 6).c_str());
+        s.networkAdapters.push_back(std::make_pair(std::string(name), std::string(mac)));
+    }
+    return s;
+}
+
+// A fleet of ordinary workstations: a handful of CPU models and firmware
+// strings shared across machines, unique board/disk/MAC values
+static SystemSerials makeWorkstation(unsigned machine) {
+    static const char* cpus[] = { "BFEBFBFF000B0649", "BFEBFBFF000906EA", "178BFBFF00A20F12", "BFEBFBFF000A0671" };
+    SystemSerials s;
+    char buf[64];
+    s.timestamp = "2024-05-01 12:00:00";
+    s.cpuId = cpus[machine % 4];
+    snprintf(buf, sizeof(buf), "MB%010u", machine);
+    s.motherboardSerial = machine % 3 == 0 ? "Default string" : buf;
+    s.biosSerial = machine % 3 == 0 ? "Default string" : "To be filled by O.E.M.";
+    for (unsigned d = 0; d < 2; d++) {
+        snprintf(buf, sizeof(buf), "S4EVNF0M%08u%u", machine, d);
+        s.diskSerials.push_back(buf);
+    }
+    const char* names[] = { "Ethernet", "Wi-Fi", "Bluetooth Network Connection" };
+    for (unsigned a = 0; a < 3; a++) {
+        unsigned char bytes[6] = { 0xD8, 0x44, (unsigned char)(machine >> 16), (unsigned char)(machine >> 8), (unsigned char)machine, (unsigned char)a };
+        s.networkAdapters.push_back(std::make_pair(std::string(names[a]), formatMac(bytes, 6)));
+    }
+    return s;
+}
+
+// The old SystemInfoChecker::saveSerials layout (size_t length prefixes)
+static std::string encodeLegacyBinary(const SystemSerials& s) {
+    std::string out;
+    auto putSize = [&](size_t n) { out.append((const char*)&n, sizeof(n)); };
+    auto putString = [&](const std::string& v) { putSize(v.size()); out += v; };
+    putString(s.timestamp);
+    putString(s.cpuId);
+    putString(s.motherboardSerial);
+    putString(s.biosSerial);
+    putSize(s.diskSerials.size());
+    for (const auto& d : s.diskSerials) putString(d);
+    putSize(s.networkAdapters.size());
+    for (const auto& a : s.networkAdapters) {
+        putString(a.first);
+        putString(a.second);
+    }
+    return out;
+}
+
+// The old SystemCheckerApp text layout, written the way it was
+static bool saveLegacyText(const SystemSerials& s, const std::string& filename) {
+    std::ofstream f(filename);
+    if (!f) return false;
+    f << s.cpuId << "\n" << s.biosSerial << "\n" << s.motherboardSerial << "\n";
+    f << s.diskSerials.size() << "\n";
+    for (const auto& d : s.diskSerials) f << d << "\n";
+    f << s.networkAdapters.size() << "\n";
+    for (const auto& a : s.networkAdapters) f << a.first << "\n" << a.second << "\n";
+    return f.good();
+}
+
+static bool writeBytes(const std::string& filename, const std::string& bytes) {
+    std::ofstream f(filename, std::ios::binary | std::ios::trunc);
+    f.write(bytes.data(), (std::streamsize)bytes.size());
+    return f.good();
+}
+
+// The iostream formatting the collectors used before SerialFormat, kept as
+// the reference point
+static std::string legacyCpuRegisters(const int regs[4]) {
+    std::ostringstream oss;
+    oss << std::hex << regs[0] << regs[1] << regs[2] << regs[3];
+    return oss.str();
+}
+
+static std::string legacyMac(const unsigned char* bytes, size_t length) {
+    std::stringstream mac;
+    for (size_t i = 0; i < length; i++) {
+        if (i > 0) mac << "-";
+        mac << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)bytes[i];
+    }
+    return mac.str();
+}
+
+// ---- harness ------------------------------------------------------------
+
+struct Case {
+    const char* name;
+    size_t bytesPerOp; // for MB/s, 0 if not meaningful
+    std::function<void()> op;
+};
+
+static volatile size_t sink; // keeps results observable
+
+static void runCase(const Case& c) {
+    using clock = std::chrono::steady_clock;
+
+    // Calibrate a batch that takes roughly 20 us so timer overhead vanishes
+    size_t batch = 1;
+    for (;;) {
+        auto t0 = clock::now();
+        for (size_t i = 0; i < batch; i++) c.op();
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        if (ns > 20000.0 || batch >= (1u << 20)) break;
+        batch *= 2;
+    }
+
+    const size_t samples = 400;
+    std::vector<double> perOp;
+    perOp.reserve(samples);
+    unsigned long long allocsBefore = AllocationCounter::allocations();
+    auto start = clock::now();
+    for (size_t s = 0; s < samples; s++) {
+        auto t0 = clock::now();
+        for (size_t i = 0; i < batch; i++) c.op();
+        perOp.push_back(std::chrono::duration<double, std::nano>(clock::now() - t0).count() / (double)batch);
+    }
+    double totalSec = std::chrono::duration<double>(clock::now() - start).count();
+    unsigned long long allocs = AllocationCounter::allocations() - allocsBefore;
+    // perOp itself was reserved up front, so every counted allocation is the op's
+
+    std::sort(perOp.begin(), perOp.end());
+    auto pct = [&](double p) { return perOp[(size_t)(p * (double)(perOp.size() - 1))]; };
+    double ops = (double)(samples * batch);
+
+    printf("%-34s %12.0f %10.1f %10.1f %10.1f %9.2f", c.name, ops / totalSec, pct(0.50), pct(0.90), pct(0.99),
+        (double)allocs / ops);
+    if (c.bytesPerOp) printf(" %9.1f", (double)c.bytesPerOp * ops / totalSec / (1024.0 * 1024.0));
+    printf("\n");
+}
+
+// Heap cost of holding a fleet's snapshots as SystemSerials versus
+// CompactSnapshotSet: one snapshot per machine, then a daily history where
+// most values repeat
+static void reportFleetMemory(size_t machines, size_t days) {
+    std::vector<SystemSerials> source;
+    source.reserve(machines * days);
+    for (size_t day = 0; day < days; day++) {
+        for (size_t i = 0; i < machines; i++) {
+            source.push_back(makeWorkstation((unsigned)i));
+            source.back().timestamp = "2024-05-" + std::to_string(10 + day) + " 12:00:00";
+        }
+    }
+
+    unsigned long long bytes0 = AllocationCounter::bytes(), allocs0 = AllocationCounter::allocations();
+    std::vector<SystemSerials> copies(source);
+    unsigned long long plainBytes = AllocationCounter::bytes() - bytes0, plainAllocs = AllocationCounter::allocations() - allocs0;
+
+    allocs0 = AllocationCounter::allocations();
+    CompactSnapshotSet compact;
+    for (const auto& serials : source) compact.add(serials);
+    unsigned long long compactAllocs = AllocationCounter::allocations() - allocs0;
+    size_t compactBytes = compact.memoryUsage(); // live bytes, not counting freed growth
+
+    // Scan: how many snapshots share the first one's CPU
+    auto t0 = std::chrono::steady_clock::now();
+    size_t plainHits = 0;
+    for (const auto& serials : copies) plainHits += serials.cpuId == source[0].cpuId;
+    auto t1 = std::chrono::steady_clock::now();
+    size_t compactHits = 0;
+    StringPool::Id cpu = compact[0].cpuId;
+    for (size_t i = 0; i < compact.size(); i++) compactHits += compact[i].cpuId == cpu;
+    auto t2 = std::chrono::steady_clock::now();
+
+    double n = (double)source.size();
+    printf("%zu workstations x %zu days (%zu distinct values):\n", machines, days, compact.strings().size());
+    printf("  SystemSerials       %7.1f bytes/snapshot %6.2f allocs/snapshot  cpu scan %6.2f ms\n",
+        plainBytes / n, plainAllocs / n, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    printf("  CompactSnapshotSet  %7.1f bytes/snapshot %6.2f allocs/snapshot  cpu scan %6.2f ms\n",
+        compactBytes / n, compactAllocs / n, std::chrono::duration<double, std::milli>(t2 - t1).count());
+    sink = plainHits + compactHits;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    SystemSerials current = makeSerials(1);
+    SystemSerials saved = makeSerials(1);
+    saved.diskSerials[7] = "REPLACED-DISK-SERIAL";
+    saved.networkAdapters[13].second = "00-15-5D-FF-FF-FF";
+    std::swap(saved.diskSerials[3], saved.diskSerials[30]); // order must not matter
+
+    std::string snapshot = SerialSnapshot::encode(current);
+    std::string savedSnapshot = SerialSnapshot::encode(saved);
+    std::string legacyBinary = encodeLegacyBinary(current);
+    SnapshotView currentView, savedView;
+    currentView.attach(snapshot.data(), snapshot.size());
+    savedView.attach(savedSnapshot.data(), savedSnapshot.size());
+
+    // Same serials, different order: the common "nothing changed" compare
+    SystemSerials reordered = current;
+    std::reverse(reordered.diskSerials.begin(), reordered.diskSerials.end());
+    std::string reorderedSnapshot = SerialSnapshot::encode(reordered);
+    SnapshotView unchangedView;
+    unchangedView.attach(reorderedSnapshot.data(), reorderedSnapshot.size());
+
+    const std::string snapshotFile = "bench_snapshot.dat";
+    const std::string legacyBinaryFile = "bench_legacy_binary.dat";
+    const std::string legacyTextFile = "bench_legacy_text.dat";
+    SerialSnapshot::writeFile(current, snapshotFile);
+    writeBytes(legacyBinaryFile, legacyBinary);
+    saveLegacyText(current, legacyTextFile);
+    size_t textSize = 0;
+    {
+        std::ifstream f(legacyTextFile, std::ios::binary | std::ios::ate);
+        textSize = (size_t)f.tellg();
+    }
+
+    int regs[4] = { 0x16, 0x756E6547, 0x6C65746E, 0x49656E69 };
+    unsigned char macBytes[6] = { 0xD8, 0x44, 0x89, 0x9D, 0xD0, 0x08 };
+
+    // Raw values as the collectors return them; normalized into a scratch copy
+    const std::string rawDisk = "  3190_4996_6018_6hf8.";
+    const std::string rawHexDisk = "2020202057202d44435734433145333235343736";
+    const std::string rawMac = "d8:44:89:9d:d0:08";
+    std::string foldBuffer(4096, 'x');
+    std::string scratch;
+    scratch.reserve(64);
+
+    CompactSnapshotSet compact;
+    compact.add(current);
+    compact.add(saved);
+    compact.add(currentView);
+    SystemSerials expanded;
+
+    std::vector<Case> cases = {
+        { "snapshot encode", snapshot.size(), [&]() { sink = SerialSnapshot::encode(current).size(); } },
+        { "snapshot save (writeFile)", snapshot.size(), [&]() { sink = SerialSnapshot::writeFile(current, snapshotFile); } },
+        { "snapshot load (loadSerialsFile)", snapshot.size(), [&]() {
+            SystemSerials s; sink = loadSerialsFile(snapshotFile, s); } },
+        { "snapshot attach (zero-copy view)", snapshot.size(), [&]() {
+            SnapshotView v; sink = v.attach(snapshot.data(), snapshot.size()); } },
+        { "legacy binary load", legacyBinary.size(), [&]() {
+            SystemSerials s; sink = loadSerialsFile(legacyBinaryFile, s); } },
+        { "legacy text save", textSize, [&]() { sink = saveLegacyText(current, legacyTextFile); } },
+        { "legacy text load", textSize, [&]() {
+            SystemSerials s; sink = loadSerialsFile(legacyTextFile, s); } },
+        { "diffSerials (SystemSerials)", 0, [&]() { sink = diffSerials(current, saved).changes.size(); } },
+        { "diffSerials (SnapshotView)", 0, [&]() { sink = diffSerials(currentView, savedView).changes.size(); } },
+        { "compareSerials (diff summary)", 0, [&]() { sink = diffSerials(current, saved).summary().size(); } },
+        { "compareSnapshots (flags)", 0, [&]() { sink = compareSnapshots(currentView, savedView).any(); } },
+        { "compareSnapshots (unchanged)", 0, [&]() { sink = compareSnapshots(currentView, unchangedView).any(); } },
+        { "diffSerials (view, unchanged)", 0, [&]() {
+            sink = diffSerials(currentView, unchangedView).changes.size(); } },
+        { "fingerprintSerials", 0, [&]() { sink = fingerprintSerials(current).root.lo; } },
+        { "formatCpuRegisters", 0, [&]() { sink = formatCpuRegisters(regs).size(); } },
+        { "cpu registers via ostringstream", 0, [&]() { sink = legacyCpuRegisters(regs).size(); } },
+        { "formatProcessorId", 0, [&]() { sink = formatProcessorId(0xBFEBFBFF, 0x000906EA).size(); } },
+        { "formatProcessorId (reused)", 0, [&]() { formatProcessorId(0xBFEBFBFF, 0x000906EA, scratch); sink = scratch.size(); } },
+        { "formatMac", 0, [&]() { sink = formatMac(macBytes, 6).size(); } },
+        { "formatMac (reused)", 0, [&]() { formatMac(macBytes, 6, scratch); sink = scratch.size(); } },
+        { "mac via stringstream", 0, [&]() { sink = legacyMac(macBytes, 6).size(); } },
+        { "normalizeSerialInPlace (NVMe)", rawDisk.size(), [&]() {
+            scratch = rawDisk; sink = normalizeSerialInPlace(&scratch[0], scratch.size()); } },
+        { "normalizeSerialInPlace (ATA hex)", rawHexDisk.size(), [&]() {
+            scratch = rawHexDisk; sink = normalizeSerialInPlace(&scratch[0], scratch.size()); } },
+        { "normalizeMac", rawMac.size(), [&]() { sink = normalizeMac(rawMac).size(); } },
+        { "foldUpper 4 KB", foldBuffer.size(), [&]() { foldUpper(&foldBuffer[0], foldBuffer.size()); sink = foldBuffer[0]; } },
+        { "foldUpperScalar 4 KB", foldBuffer.size(), [&]() {
+            foldUpperScalar(&foldBuffer[0], foldBuffer.size()); sink = foldBuffer[0]; } },
+        { "normalizeSerials (copy + all)", 0, [&]() {
+            SystemSerials s = current; normalizeSerials(s); sink = s.diskSerials.size(); } },
+        { "normalizeSerials (reused copy)", 0, [&]() {
+            expanded = current; normalizeSerials(expanded); sink = expanded.diskSerials.size(); } },
+        { "compact changedComponents", 0, [&]() { sink = compact.changedComponents(0, 1); } },
+        { "compact changedComponents (same)", 0, [&]() { sink = compact.changedComponents(0, 2); } },
+        { "compact toSerials (reused)", 0, [&]() { compact.toSerials(0, expanded); sink = expanded.diskSerials.size(); } },
+        { "SystemSerials changed lists", 0, [&]() {
+            sink = current.diskSerials != saved.diskSerials || current.networkAdapters != saved.networkAdapters; } },
+    };
+
+    printf("%zu disks, %zu adapters; snapshot %zu bytes, legacy binary %zu, legacy text %zu\n\n",
+        current.diskSerials.size(), current.networkAdapters.size(), snapshot.size(), legacyBinary.size(), textSize);
+    if (!filter) {
+        reportFleetMemory(200000, 1);
+        reportFleetMemory(50000, 30);
+        printf("\n");
+    }
+    printf("%-34s %12s %10s %10s %10s %9s %9s\n", "case", "ops/s", "p50 ns", "p90 ns", "p99 ns", "allocs/op", "MB/s");
+    for (const auto& c : cases) {
+        if (filter && !strstr(c.name, filter)) continue;
+        runCase(c);
+    }
+
+    remove(snapshotFile.c_str());
+    remove(legacyBinaryFile.c_str());
+    remove(legacyTextFile.c_str());
+    return 0;
+}
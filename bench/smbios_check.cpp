@@ -0,0 +1,263 @@
+// smbios_check.cpp
+//
+// Decodes the SMBIOS dumps under bench/fixtures/smbios and checks every
+// field BanSniffer reads: BIOS (type 0), system and its UUID (type 1),
+// board (type 2), chassis (type 3) and memory modules (type 17), plus the
+// firmware serials assigned from them. Then feeds the parser truncated and
+// malformed copies: a table cut off after some structures keeps what came
+// before, one with no well-formed structure is rejected. Portable, no
+// Windows API.
+//
+// gigabyte-b550-2.8.smbios is an SMBIOS 2.8 table: short type 17s (size in
+// MB and in KB granularity, an empty slot), a lock bit on the chassis type,
+// padded strings, an unrelated type 4 and a second type 2 that must be
+// ignored. lenovo-thinkpad-3.3.smbios is SMBIOS 3.3: long type 17s with the
+// extended size and speed fields, an unset UUID and a board without a
+// serial. Both are in the RawSMBIOSData layout "BanSniffer smbios --dump"
+// writes.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -I. -o smbios_check bench/smbios_check.cpp SmbiosReader.cpp
+//   ./smbios_check [fixture directory]
+//
+// Prints one line per case and exits 1 if any check failed.
+
+#include "../SmbiosReader.h"
+#include "../system_serials.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static void expectString(const char* what, const std::string& got, const char* want) {
+    if (got == want) return;
+    printf("  %s: got \"%s\", want \"%s\"\n", what, got.c_str(), want);
+    check(false, what);
+}
+
+static void expectNumber(const char* what, uint32_t got, uint32_t want) {
+    if (got == want) return;
+    printf("  %s: got %u, want %u\n", what, got, want);
+    check(false, what);
+}
+
+static std::string fixtureDir = "bench/fixtures/smbios";
+
+// The raw dump, or empty (and a failed check) if it can't be read
+static std::string loadFixture(const char* name) {
+    std::string path = fixtureDir + "/" + name;
+    FILE* f = fopen(path.c_str(), "rb");
+    std::string raw;
+    if (f) {
+        char chunk[4096];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) raw.append(chunk, n);
+        fclose(f);
+    }
+    if (raw.empty()) printf("  cannot read %s\n", path.c_str());
+    check(!raw.empty(), "fixture readable");
+    return raw;
+}
+
+static bool parse(const std::string& raw, SmbiosInfo& info) {
+    return parseRawSmbiosData((const unsigned char*)raw.data(), raw.size(), info);
+}
+
+static void expectModule(const SmbiosInfo& info, size_t index, const char* locator, const char* bank,
+    const char* manufacturer, const char* serial, const char* part, uint32_t sizeMb, uint32_t speedMts) {
+    if (index >= info.memoryModules.size()) {
+        check(false, "memory module present");
+        return;
+    }
+    const SmbiosMemoryModule& m = info.memoryModules[index];
+    expectString("module locator", m.locator, locator);
+    expectString("module bank locator", m.bankLocator, bank);
+    expectString("module manufacturer", m.manufacturer, manufacturer);
+    expectString("module serial", m.serial, serial);
+    expectString("module part number", m.partNumber, part);
+    expectNumber("module size MB", m.sizeMb, sizeMb);
+    expectNumber("module speed MT/s", m.speedMts, speedMts);
+}
+
+// 2.8: everything decoded through FixtureSmbiosReader, as "smbios --table"
+// and the collectors read it
+static void smbios28() {
+    printf("smbios 2.8\n");
+    FixtureSmbiosReader reader;
+    check(reader.loadFile(fixtureDir + "/gigabyte-b550-2.8.smbios"), "loadFile");
+    SmbiosInfo info;
+    check(reader.read(info), "read");
+
+    expectNumber("major version", info.majorVersion, 2);
+    expectNumber("minor version", info.minorVersion, 8);
+    expectString("bios vendor", info.biosVendor, "American Megatrends Inc.");
+    expectString("bios version", info.biosVersion, "F20");
+    expectString("bios release date", info.biosReleaseDate, "11/05/2021");
+    expectString("system manufacturer", info.systemManufacturer, "Gigabyte Technology Co., Ltd.");
+    expectString("system product", info.systemProduct, "B550 AORUS ELITE");
+    expectString("system serial, trimmed", info.systemSerial, "SYS-8C2F44A1");
+    expectString("system uuid, little-endian fields", info.systemUuid, "00020003-0004-0005-0006-000700080009");
+    expectString("board manufacturer", info.boardManufacturer, "Gigabyte Technology Co., Ltd.");
+    expectString("board product", info.boardProduct, "B550 AORUS ELITE");
+    expectString("board serial, first type 2 only", info.boardSerial, "210463102504321");
+    expectString("chassis manufacturer", info.chassisManufacturer, "Gigabyte Technology Co., Ltd.");
+    expectNumber("chassis type, lock bit masked", info.chassisType, 3);
+    expectString("chassis serial", info.chassisSerial, "Default string");
+    expectString("chassis asset tag", info.chassisAssetTag, "Default string");
+
+    expectNumber("installed modules", (uint32_t)info.memoryModules.size(), 3);
+    expectModule(info, 0, "DIMM 0", "P0 CHANNEL A", "G-Skill", "00000000", "F4-3200C16-16GVK", 16384, 3200);
+    expectModule(info, 1, "DIMM 0", "P0 CHANNEL B", "G-Skill", "00000000", "F4-3200C16-16GVK", 16384, 3200);
+    expectModule(info, 2, "DIMM 1", "P0 CHANNEL B", "Unknown", "Unknown", "Unknown", 1, 0);
+
+    std::string board, bios;
+    assignFirmwareSerials(info, WatchAll, board, bios);
+    expectString("motherboard serial", board, "210463102504321");
+    expectString("bios serial", bios, "SYS-8C2F44A1");
+}
+
+// 3.3: extended size and speed, unset UUID, board without a serial
+static void smbios33() {
+    printf("smbios 3.3\n");
+    std::string raw = loadFixture("lenovo-thinkpad-3.3.smbios");
+    SmbiosInfo info;
+    check(parse(raw, info), "parse");
+
+    expectNumber("major version", info.majorVersion, 3);
+    expectNumber("minor version", info.minorVersion, 3);
+    expectString("bios vendor", info.biosVendor, "LENOVO");
+    expectString("bios version, inner spaces kept", info.biosVersion, "N3GET74W (1.54 )");
+    expectString("bios release date", info.biosReleaseDate, "02/21/2024");
+    expectString("system manufacturer", info.systemManufacturer, "LENOVO");
+    expectString("system product", info.systemProduct, "21CBCTO1WW");
+    expectString("system serial", info.systemSerial, "PF3ZK9QX");
+    expectString("all-ones uuid is unset", info.systemUuid, "");
+    expectString("board manufacturer", info.boardManufacturer, "LENOVO");
+    expectString("board product", info.boardProduct, "21CBCTO1WW");
+    expectString("board serial absent", info.boardSerial, "");
+    expectNumber("chassis type", info.chassisType, 10);
+    expectString("chassis serial", info.chassisSerial, "PF3ZK9QX");
+    expectString("chassis asset tag", info.chassisAssetTag, "No Asset Information");
+
+    expectNumber("installed modules", (uint32_t)info.memoryModules.size(), 2);
+    expectModule(info, 0, "Controller0-ChannelA-DIMM0", "BANK 0", "Samsung", "M4A1B2C3", "M425R4GA3BB0-CWMOD",
+        65536, 8400);
+    expectModule(info, 1, "Controller1-ChannelA-DIMM0", "BANK 0", "Samsung", "00000000", "M425R1GB4BB0-CWMOL",
+        0, 5600);
+
+    std::string board = "stale", bios = "stale";
+    assignFirmwareSerials(info, WatchMotherboard, board, bios);
+    expectString("board without serial", board, "Not Available");
+    expectString("bios untouched when not requested", bios, "stale");
+
+    // Parsing the other table into the same info replaces every field
+    std::string other = loadFixture("gigabyte-b550-2.8.smbios");
+    check(parse(other, info) && parse(raw, info), "re-parse");
+    expectString("uuid cleared by re-parse", info.systemUuid, "");
+    expectNumber("modules after re-parse", (uint32_t)info.memoryModules.size(), 2);
+}
+
+// Offset of the n-th structure (0-based) inside the raw dump, or 0
+static size_t structureOffset(const std::string& raw, size_t n) {
+    size_t p = RawSmbiosHeaderSize;
+    for (size_t i = 0; i < n; i++) {
+        if (p + 2 > raw.size()) return 0;
+        p += (unsigned char)raw[p + 1];
+        while (p + 1 < raw.size() && (raw[p] || raw[p + 1])) p++;
+        p += 2;
+    }
+    return p;
+}
+
+// Cut-off and malformed copies of the 2.8 table
+static void truncatedAndMalformed() {
+    printf("truncated and malformed\n");
+    std::string raw = loadFixture("gigabyte-b550-2.8.smbios");
+    if (raw.empty()) return;
+    SmbiosInfo info;
+
+    // Cut inside the second memory module: the walk stops there, the
+    // header's table length is ignored in favour of what was read
+    size_t secondPopulated = structureOffset(raw, 7);
+    check(secondPopulated != 0, "fixture layout");
+    std::string cut = raw.substr(0, secondPopulated + 10);
+    check(parse(cut, info), "cut table parses");
+    expectString("bios kept", info.biosVendor, "American Megatrends Inc.");
+    expectString("board kept", info.boardSerial, "210463102504321");
+    expectNumber("modules before the cut", (uint32_t)info.memoryModules.size(), 1);
+
+    // Missing end-of-table structure is not an error
+    std::string noEnd = raw.substr(0, structureOffset(raw, 10));
+    check(parse(noEnd, info), "table without type 127 parses");
+    expectNumber("all modules without type 127", (uint32_t)info.memoryModules.size(), 3);
+
+    // The last module claiming more formatted bytes than remain
+    std::string overlong = raw;
+    overlong[structureOffset(raw, 8) + 1] = (char)0xFF;
+    check(parse(overlong, info), "overlong structure ends the walk");
+    expectNumber("modules before the overlong one", (uint32_t)info.memoryModules.size(), 2);
+
+    // Nothing well-formed at all
+    std::string cutFirst = raw.substr(0, RawSmbiosHeaderSize + 10);
+    check(!parse(cutFirst, info), "cut inside the first structure is rejected");
+    std::string garbage = raw;
+    garbage[RawSmbiosHeaderSize + 1] = 2; // length below the structure header
+    check(!parse(garbage, info), "bad first length is rejected");
+    std::string headerOnly = raw.substr(0, RawSmbiosHeaderSize);
+    check(!parse(headerOnly, info), "header without a table is rejected");
+    check(!parse(raw.substr(0, 5), info), "short header is rejected");
+
+    // A failed read leaves nothing of the earlier one behind
+    FixtureSmbiosReader good(raw);
+    check(good.read(info), "good read");
+    FixtureSmbiosReader bad(garbage);
+    check(!bad.read(info), "bad read fails");
+    check(info.biosVendor.empty() && info.memoryModules.empty() && info.majorVersion == 0,
+        "failed read resets info");
+    std::string board, bios;
+    assignFirmwareSerials(info, WatchAll, board, bios);
+    check(board == "Not Available" && bios == "Not Available", "no table gives Not Available");
+}
+
+// The version out of each entry point flavour Linux exposes
+static void entryPoints() {
+    printf("entry points\n");
+    unsigned char sm3[0x18] = { '_', 'S', 'M', '3', '_' };
+    sm3[0x07] = 3;
+    sm3[0x08] = 5;
+    unsigned char sm[0x1F] = { '_', 'S', 'M', '_' };
+    sm[0x06] = 2;
+    sm[0x07] = 8;
+    unsigned char dmi[0x0F] = { '_', 'D', 'M', 'I', '_' };
+    dmi[0x0E] = 0x21;
+    uint8_t major = 0, minor = 0;
+    check(parseSmbiosEntryPoint(sm3, sizeof(sm3), major, minor) && major == 3 && minor == 5, "_SM3_");
+    check(parseSmbiosEntryPoint(sm, sizeof(sm), major, minor) && major == 2 && minor == 8, "_SM_");
+    check(parseSmbiosEntryPoint(dmi, sizeof(dmi), major, minor) && major == 2 && minor == 1, "_DMI_");
+    check(!parseSmbiosEntryPoint(sm3, 0x10, major, minor), "short _SM3_ rejected");
+    check(!parseSmbiosEntryPoint((const unsigned char*)"_XX_", 4, major, minor), "unknown anchor rejected");
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) fixtureDir = argv[1];
+
+    smbios28();
+    smbios33();
+    truncatedAndMalformed();
+    entryPoints();
+
+    if (failures) {
+        printf("\n%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\nall checks passed\n");
+    return 0;
+}
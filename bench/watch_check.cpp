@@ -0,0 +1,289 @@
+// watch_check.cpp
+//
+// Drives SerialWatcher from a ScriptedChangeSource against fake hardware and
+// checks which components it re-collects and which changes it reports:
+// bursts coalesced into one refresh (and the cap on how long a burst is
+// soaked up), notifications for unchanged values staying quiet, a
+// component that missed its deadline keeping its last values and being
+// retried on the next poll, and disk arrival through FixtureDiskEnumerator
+// serving captured-style STORAGE_DEVICE_DESCRIPTORs. Portable, no Windows API.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++17 -pthread -I. -o watch_check bench/watch_check.cpp
+//       SerialWatcher.cpp ChangeSource.cpp DiskEnumerator.cpp
+//   ./watch_check
+//
+// Prints one line per case and exits 1 if any check failed.
+
+#include "../SerialWatcher.h"
+#include "../ChangeSource.h"
+#include "../DiskEnumerator.h"
+#include "../BinaryIO.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static std::string maskName(unsigned mask) {
+    static const char* const names[] = { "cpu", "board", "bios", "disks", "adapters" };
+    std::string s;
+    for (unsigned bit = 0; bit < 5; bit++) {
+        if (!(mask & (1u << bit))) continue;
+        if (!s.empty()) s += '|';
+        s += names[bit];
+    }
+    return s.empty() ? "none" : s;
+}
+
+static std::string masksName(const std::vector<unsigned>& masks) {
+    std::string s = "[";
+    for (size_t i = 0; i < masks.size(); i++) s += (i ? ", " : "") + maskName(masks[i]);
+    return s + "]";
+}
+
+// The machine the fake collector reads. before(n) runs ahead of the n-th
+// collection (0 = the watcher's initial full one), so a case can change
+// hardware or fail a component at a chosen refresh.
+struct FakeHardware {
+    SystemSerials serials;
+    std::function<void(size_t call, FakeHardware& hw, unsigned& failMask)> before;
+    std::vector<unsigned> collected; // mask of every collection, in order
+
+    FakeHardware() {
+        serials.cpuId = "BFEBFBFF000906EA";
+        serials.motherboardSerial = "MB-0001";
+        serials.biosSerial = "SYS-0001";
+        serials.diskSerials = { "S4EVNF0M100001" };
+        serials.networkAdapters = { { "Ethernet", "D8-44-89-9D-D0-08" } };
+    }
+
+    // A SerialWatcher::Collector: copies the masked components, or for a
+    // failed one leaves a partial value and flags it incomplete
+    void collect(unsigned components, SystemSerials& out) {
+        unsigned failMask = 0;
+        if (before) before(collected.size(), *this, failMask);
+        collected.push_back(components);
+
+        unsigned missed = 0;
+        if (components & WatchCpu) out.cpuId = serials.cpuId;
+        if (components & WatchMotherboard) out.motherboardSerial = serials.motherboardSerial;
+        if (components & WatchBios) out.biosSerial = serials.biosSerial;
+        if (components & WatchDisks) {
+            out.diskSerials = serials.diskSerials;
+            if (failMask & WatchDisks) {
+                out.diskSerials.resize(out.diskSerials.size() / 2); // what answered in time
+                missed |= WatchDisks;
+            }
+        }
+        if (components & WatchAdapters) {
+            out.networkAdapters = serials.networkAdapters;
+            if (failMask & WatchAdapters) {
+                out.networkAdapters.clear();
+                missed |= WatchAdapters;
+            }
+        }
+        out.incomplete = (out.incomplete & ~components) | missed;
+    }
+};
+
+struct Outcome {
+    std::vector<unsigned> collected;
+    std::vector<unsigned> reported;
+    SystemSerials final;
+    unsigned counts[5];
+};
+
+static Outcome runScript(FakeHardware& hw, const std::vector<unsigned>& script) {
+    ScriptedChangeSource source(script);
+    SerialWatcher watcher(source, [&hw](unsigned components, SystemSerials& serials) {
+        hw.collect(components, serials);
+    });
+    watcher.setSettleTime(0);
+
+    Outcome outcome;
+    watcher.run([&outcome](unsigned changed, const SystemSerials&) { outcome.reported.push_back(changed); },
+        [&source]() { return !source.finished(); }, 0);
+    outcome.collected = hw.collected;
+    outcome.final = watcher.current();
+    for (unsigned bit = 0; bit < 5; bit++) outcome.counts[bit] = watcher.collections(bit);
+    return outcome;
+}
+
+static void expectMasks(const char* what, const std::vector<unsigned>& got, const std::vector<unsigned>& want) {
+    if (got == want) return;
+    printf("  %s: got %s, want %s\n", what, masksName(got).c_str(), masksName(want).c_str());
+    check(false, what);
+}
+
+// Two notifications in one burst are one refresh; only the disk list
+// actually differs afterwards, and a CPU notification on its own changes
+// nothing
+static void coalescedBurst() {
+    printf("coalesced burst\n");
+    FakeHardware hw;
+    hw.before = [](size_t call, FakeHardware& h, unsigned&) {
+        if (call == 1) h.serials.diskSerials.push_back("WD-WX12A3456789");
+    };
+    Outcome o = runScript(hw, { WatchDisks, WatchAdapters, 0, WatchCpu, 0 });
+
+    expectMasks("collections", o.collected, { WatchAll, WatchDisks | WatchAdapters, WatchCpu });
+    expectMasks("reported", o.reported, { WatchDisks });
+    check(o.final.diskSerials.size() == 2, "second disk present afterwards");
+    check(o.counts[0] == 2 && o.counts[3] == 2 && o.counts[4] == 2 && o.counts[1] == 1,
+        "per-component collection counts");
+}
+
+// A burst is soaked up for at most ten settle windows, the rest of it
+// starts the next refresh
+static void burstCap() {
+    printf("burst cap\n");
+    FakeHardware hw;
+    std::vector<unsigned> script = { WatchDisks };
+    script.insert(script.end(), 11, WatchAdapters);
+    script.push_back(0);
+    Outcome o = runScript(hw, script);
+
+    expectMasks("collections", o.collected, { WatchAll, WatchDisks | WatchAdapters, WatchAdapters });
+    expectMasks("reported", o.reported, {});
+}
+
+// A disk refresh that misses its deadline is not a change: the previous
+// list stays, and the next poll retries disks without a notification
+static void incompleteRetry() {
+    printf("incomplete retry\n");
+    FakeHardware hw;
+    hw.before = [](size_t call, FakeHardware& h, unsigned& failMask) {
+        if (call == 1) {
+            h.serials.diskSerials = { "S4EVNF0M100001", "WD-WX12A3456789", "ZA1B2C3D" };
+            failMask = WatchDisks;
+        }
+    };
+    size_t diskCountAfterFailure = 0;
+    ScriptedChangeSource source({ WatchDisks, 0, 0, 0 });
+    std::vector<unsigned> reported;
+    SerialWatcher watcher(source, [&hw](unsigned components, SystemSerials& serials) {
+        hw.collect(components, serials);
+    });
+    watcher.setSettleTime(0);
+    watcher.run([&](unsigned changed, const SystemSerials&) {
+        reported.push_back(changed);
+        if (reported.size() == 1) diskCountAfterFailure = watcher.current().diskSerials.size();
+    }, [&]() {
+        // Between the failed refresh and the retry the old list must still be current
+        if (hw.collected.size() == 2) check(watcher.current().diskSerials.size() == 1, "old disks kept while stale");
+        return !source.finished();
+    }, 0);
+
+    expectMasks("collections", hw.collected, { WatchAll, WatchDisks, WatchDisks });
+    expectMasks("reported", reported, { WatchDisks });
+    check(diskCountAfterFailure == 3, "retry reports the full list");
+    check(watcher.current().incomplete == 0, "nothing left incomplete");
+}
+
+// Adapters time out on the very first, full collection and are retried
+// on the first poll even though nothing was signalled
+static void initialIncomplete() {
+    printf("initial incomplete\n");
+    FakeHardware hw;
+    hw.before = [](size_t call, FakeHardware&, unsigned& failMask) {
+        if (call == 0) failMask = WatchAdapters;
+    };
+    Outcome o = runScript(hw, { 0, 0 });
+
+    expectMasks("collections", o.collected, { WatchAll, WatchAdapters });
+    expectMasks("reported", o.reported, { WatchAdapters });
+    check(o.final.networkAdapters.size() == 1, "adapters filled by the retry");
+}
+
+// A STORAGE_DEVICE_DESCRIPTOR as IOCTL_STORAGE_QUERY_PROPERTY returns it:
+// the fixed part, then the NUL-terminated strings it points at, padded
+// with raw bus properties up to totalSize
+static std::string storageDescriptor(const char* vendor, const char* product, const char* serial,
+    uint32_t busType, size_t totalSize = 0) {
+    std::string d(StorageDescriptorFixedSize, '\0');
+    auto addString = [&d](size_t field, const char* text) {
+        if (!text) return;
+        putU32(&d[field], (uint32_t)d.size());
+        d.append(text);
+        d.push_back('\0');
+    };
+    putU32(&d[0], (uint32_t)StorageDescriptorFixedSize); // Version
+    addString(12, vendor);
+    addString(16, product);
+    addString(24, serial);
+    putU32(&d[28], busType);
+    if (d.size() < totalSize) {
+        putU32(&d[32], (uint32_t)(totalSize - d.size())); // RawPropertiesLength
+        d.resize(totalSize, '\x5A');
+    }
+    putU32(&d[4], (uint32_t)d.size());
+    return d;
+}
+
+// Disks re-collected through the fixture enumerator the way the Windows
+// collector does it: a disk arriving between refreshes is reported, the
+// ATA padding is trimmed, a serial-less device is left out, and a
+// descriptor larger than the initial buffer costs exactly one re-query
+static void fixtureDiskArrival() {
+    printf("fixture disk arrival\n");
+    FixtureDiskEnumerator enumerator;
+    enumerator.add("nvme0", storageDescriptor(nullptr, "Samsung SSD 980 PRO 1TB", "S5GXNF0R123456A.", 17));
+    enumerator.add("cdrom0", storageDescriptor("HL-DT-ST", "DVDRAM GH24NSD1", nullptr, 3));
+    std::vector<DiskInfo> disks;
+
+    std::vector<unsigned> collected;
+    size_t call = 0;
+    ScriptedChangeSource source({ WatchDisks, 0, WatchDisks, 0 });
+    SerialWatcher watcher(source, [&](unsigned components, SystemSerials& serials) {
+        collected.push_back(components);
+        if (call++ == 1) {
+            enumerator.add("sata1", storageDescriptor("ATA", "WDC WD40EFRX", "     WD-WCC7K1234567",
+                11, StorageDescriptorInitialBuffer + 512));
+        }
+        if (!(components & WatchDisks)) return;
+        bool timedOut = false;
+        enumerator.enumerate(disks, Deadline(), timedOut);
+        assignDiskSerials(disks, serials.diskSerials);
+        serials.incomplete = (serials.incomplete & ~components) | (timedOut ? (unsigned)WatchDisks : 0u);
+    });
+    watcher.setSettleTime(0);
+    std::vector<unsigned> reported;
+    watcher.run([&](unsigned changed, const SystemSerials&) { reported.push_back(changed); },
+        [&]() { return !source.finished(); }, 0);
+
+    expectMasks("collections", collected, { WatchAll, WatchDisks, WatchDisks });
+    expectMasks("reported", reported, { WatchDisks });
+    const std::vector<std::string>& serials = watcher.current().diskSerials;
+    check(serials.size() == 2, "two disks with serials");
+    check(serials.size() == 2 && serials[0] == "S5GXNF0R123456A." && serials[1] == "WD-WCC7K1234567",
+        "serials in enumeration order, padding trimmed");
+    check(disks.size() == 3 && disks[2].busType == 11 && disks[2].product == "WDC WD40EFRX",
+        "descriptor fields decoded");
+    // Two descriptors on the first refresh; three plus one re-query for the
+    // large one on the second; the grown buffer is kept for the third
+    check(enumerator.queries() == 2 + 4 + 3, "one re-query for the oversized descriptor");
+}
+
+int main() {
+    coalescedBurst();
+    burstCap();
+    incompleteRetry();
+    initialIncomplete();
+    fixtureDiskArrival();
+
+    if (failures) {
+        printf("\n%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\nall checks passed\n");
+    return 0;
+}
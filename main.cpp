@@ -1,18 +1,44 @@
 #include "system_serials.hpp"      // FAST WinAPI hardware serials (new code)
 #include "SystemInfoChecker.h"     // WMI OS info, security info (old code)
 #include "ConsoleUtils.h"
+#include "SerialSnapshot.h"
+#include "SerialDiff.h"
+#include "SerialWatcher.h"
+#include "SnapshotJournal.h"
+#include "SerialNormalize.h"
+#include "WinChangeSource.h"
+#include "BatchMode.h"
+#include "Trace.h"
 #include <iostream>
 #include <conio.h>
 #include <string>
 #include <iomanip>
 #include <algorithm>
 #include <limits>
-#include <fstream>
+#include <deque>
 
 class SystemCheckerApp {
 private:
     SystemInfoChecker checker; // For WMI/OS/security info
     std::string serialsFile = "system_serials.dat";
+    std::string journalFile = "system_serials.journal"; // history of every save and watched change
+    SnapshotJournal journal;
+    std::string tracePath; // from BANSNIFFER_TRACE, empty when tracing is off
+
+    // Opened on first use; only records components that actually changed
+    void recordHistory(const SystemSerials& serials) {
+        if (!journal.isOpen() && !journal.open(journalFile)) return;
+        journal.append(serials);
+    }
+
+    // Rewrites the trace with everything recorded so far
+    void writeTrace() {
+        if (tracePath.empty()) return;
+        if (Trace::writeChromeJson(tracePath))
+            ConsoleUtils::printInfo("Trace (" + std::to_string(Trace::spanCount()) + " spans) written to " + tracePath);
+        else
+            ConsoleUtils::printError("Failed to write trace to " + tracePath);
+    }
 
     void clearInputBuffer() {
         while (_kbhit()) { _getch(); }
@@ -23,185 +49,403 @@ private:
     void displayMainMenu() {
         ConsoleUtils::clearScreen();
         ConsoleUtils::printBox("SYSTEM INFO CHECKER \n Made By The Splosh Larp \n Version 2.0", ConsoleUtils::CYAN);
-        std::cout << "\n";
+        ConsoleUtils::out() << "\n";
         ConsoleUtils::setColor(ConsoleUtils::YELLOW);
-        std::cout << "Main Menu:\n";
+        ConsoleUtils::out() << "Main Menu:\n";
         ConsoleUtils::resetColor();
-        std::cout << "  1. Show System Summary\n";
-        std::cout << "  2. Save Current Serials\n";
-        std::cout << "  0. Exit\n\n";
+        ConsoleUtils::out() << "  1. Show System Summary\n";
+        ConsoleUtils::out() << "  2. Save Current Serials\n";
+        ConsoleUtils::out() << "  3. Watch Serials (live)\n";
+        ConsoleUtils::out() << "  0. Exit\n\n";
         ConsoleUtils::setColor(ConsoleUtils::DARK_WHITE);
-        std::cout << "Select option: ";
+        ConsoleUtils::out() << "Select option: ";
         ConsoleUtils::resetColor();
+        ConsoleUtils::present();
     }
 
-    void printSerialWithStatus(const std::string& label, const std::string& value, bool hasChanged, bool hasSavedData, int labelWidth = 20, int valueWidth = 30) {
+    void printSerialWithStatus(const std::string& label, const std::string& value, ChangeKind kind, bool hasSavedData, int labelWidth = 20, int valueWidth = 30) {
         std::string displayLabel = label;
         if (displayLabel.length() > labelWidth - 1)
             displayLabel = displayLabel.substr(0, labelWidth - 4) + "...";
         ConsoleUtils::setColor(ConsoleUtils::DARK_WHITE);
-        std::cout << "  " << std::left << std::setw(labelWidth) << displayLabel << ": ";
+        ConsoleUtils::out() << "  " << std::left << std::setw(labelWidth) << displayLabel << ": ";
         std::string displayValue = value;
         if (displayValue.length() > valueWidth - 1)
             displayValue = displayValue.substr(0, valueWidth - 4) + "...";
         ConsoleUtils::setColor(ConsoleUtils::CYAN);
-        std::cout << std::left << std::setw(valueWidth) << displayValue;
-        std::cout << " | ";
+        ConsoleUtils::out() << std::left << std::setw(valueWidth) << displayValue;
+        ConsoleUtils::out() << " | ";
         if (!hasSavedData) {
-            ConsoleUtils::setColor(ConsoleUtils::YELLOW); std::cout << "NO BASELINE";
+            ConsoleUtils::setColor(ConsoleUtils::YELLOW); ConsoleUtils::out() << "NO BASELINE";
+        }
+        else if (kind == ChangeKind::Stale) {
+            ConsoleUtils::setColor(ConsoleUtils::YELLOW); ConsoleUtils::out() << "STALE";
+        }
+        else if (kind == ChangeKind::Added) {
+            ConsoleUtils::setColor(ConsoleUtils::GREEN); ConsoleUtils::out() << "ADDED";
         }
-        else if (value == "Not Available" || value.empty() || hasChanged) {
-            ConsoleUtils::setColor(ConsoleUtils::GREEN); std::cout << "CHANGED";
+        else if (kind == ChangeKind::Removed) {
+            ConsoleUtils::setColor(ConsoleUtils::GREEN); ConsoleUtils::out() << "REMOVED";
+        }
+        else if (value == "Not Available" || value.empty() || kind == ChangeKind::Modified) {
+            ConsoleUtils::setColor(ConsoleUtils::GREEN); ConsoleUtils::out() << "CHANGED";
         }
         else {
-            ConsoleUtils::setColor(ConsoleUtils::RED); std::cout << "UNCHANGED";
+            ConsoleUtils::setColor(ConsoleUtils::RED); ConsoleUtils::out() << "UNCHANGED";
+        }
+        ConsoleUtils::resetColor(); ConsoleUtils::out() << "\n";
+    }
+
+    void printSerialChange(const SerialChange& change, bool hasSavedData, int labelWidth, int valueWidth) {
+        bool removed = change.kind == ChangeKind::Removed;
+        printSerialWithStatus(change.label, removed ? change.oldValue : change.newValue, change.kind,
+            hasSavedData, labelWidth, valueWidth);
+        if (hasSavedData && change.kind == ChangeKind::Modified) {
+            ConsoleUtils::setColor(ConsoleUtils::GRAY);
+            ConsoleUtils::out() << "  " << std::left << std::setw(labelWidth) << "" << "  was " << change.oldValue << "\n";
+            ConsoleUtils::resetColor();
         }
-        ConsoleUtils::resetColor(); std::cout << "\n";
     }
 
     // ---- Serial save/load/compare using WinAPI-only serials ----
     bool saveSerials(const SystemSerials& s, const std::string& filename) {
-        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
-        if (!out) return false;
-        out << s.cpuId << "\n" << s.biosSerial << "\n" << s.motherboardSerial << "\n";
-        out << s.diskSerials.size() << "\n";
-        for (const auto& d : s.diskSerials) out << d << "\n";
-        out << s.networkAdapters.size() << "\n";
-        for (const auto& p : s.networkAdapters) out << p.first << "\n" << p.second << "\n";
-        return true;
+        return SerialSnapshot::writeFile(s, filename);
     }
     bool loadSerials(SystemSerials& s, const std::string& filename) {
-        std::ifstream in(filename, std::ios::binary);
-        if (!in) return false;
-        getline(in, s.cpuId);
-        getline(in, s.biosSerial);
-        getline(in, s.motherboardSerial);
-        size_t n = 0;
-        in >> n; in.ignore();
-        s.diskSerials.clear();
-        for (size_t i = 0; i < n; ++i) {
-            std::string d; getline(in, d); s.diskSerials.push_back(d);
-        }
-        in >> n; in.ignore();
-        s.networkAdapters.clear();
-        for (size_t i = 0; i < n; ++i) {
-            std::string k, v; getline(in, k); getline(in, v);
-            s.networkAdapters.push_back(std::make_pair(k, v)); 
-        }
-        return true;
+        // Also reads the old newline format, re-saving upgrades the file
+        return loadSerialsFile(filename, s);
     }
 
-    std::map<std::string, bool> compareSerials(const SystemSerials& a, const SystemSerials& b) {
-        std::map<std::string, bool> result;
-        result["CPU ID"] = (a.cpuId != b.cpuId);
-        result["BIOS Serial"] = (a.biosSerial != b.biosSerial);
-        result["Motherboard Serial"] = (a.motherboardSerial != b.motherboardSerial);
-        result["Disk Serials"] = (a.diskSerials != b.diskSerials);
-        result["Network Adapters"] = (a.networkAdapters != b.networkAdapters);
-        return result;
-    }
+    // What the summary can show so far. Collectors fill the live structs on
+    // worker threads; fields are copied here only once their unit finished.
+    struct SummaryProgress {
+        SystemInfo info;
+        SystemSerials serials;
+        SecurityStatus status{};
+        std::vector<SmbiosMemoryModule> memoryModules; // same table read as board/BIOS
+        bool infoReady = false;
+        bool cpuReady = false;
+        bool boardReady = false;
+        bool biosReady = false;
+        bool disksReady = false;
+        bool adaptersReady = false;
+        bool defenderReady = false;
+        bool mitigationsReady = false;
+        bool avReady = false;
+    };
 
-    void showSystemSummary() {
-        ConsoleUtils::clearScreen();
-        ConsoleUtils::printHeader("SYSTEM SUMMARY", ConsoleUtils::CYAN);
+    static unsigned unitComponent(const std::string& unit) {
+        if (unit == "CPU") return WatchCpu;
+        if (unit == "SMBIOS") return WatchMotherboard | WatchBios;
+        if (unit == "Disks") return WatchDisks;
+        if (unit == "Adapters") return WatchAdapters;
+        return 0;
+    }
 
+    // Returns false for units that don't feed a section (e.g. "Serials Timestamp")
+    static bool applyCollected(const std::string& unit, const SystemInfo& info, const SystemSerials& serials,
+        const SecurityStatus& status, SummaryProgress& progress) {
+        if (unit == "System Info") { progress.info = info; progress.infoReady = true; }
+        else if (unit == "CPU") { progress.serials.cpuId = serials.cpuId; progress.cpuReady = true; }
+        else if (unit == "SMBIOS") {
+            progress.serials.motherboardSerial = serials.motherboardSerial;
+            progress.serials.biosSerial = serials.biosSerial;
+            progress.boardReady = progress.biosReady = true;
+        }
+        else if (unit == "Disks") { progress.serials.diskSerials = serials.diskSerials; progress.disksReady = true; }
+        else if (unit == "Adapters") { progress.serials.networkAdapters = serials.networkAdapters; progress.adaptersReady = true; }
+        else if (unit == "Defender Service") {
+            progress.status.defenderServiceStatus = status.defenderServiceStatus;
+            progress.defenderReady = true;
+        }
+        else if (unit == "Registry Mitigations") {
+            progress.status.realtimeProtectionEnabled = status.realtimeProtectionEnabled;
+            progress.status.depEnabled = status.depEnabled;
+            progress.status.aslrStatus = status.aslrStatus;
+            progress.status.controlFlowGuardEnabled = status.controlFlowGuardEnabled;
+            progress.mitigationsReady = true;
+        }
+        else if (unit == "AV Products") {
+            progress.status.antivirusProducts = status.antivirusProducts;
+            progress.avReady = true;
+        }
+        else {
+            return false;
+        }
+        normalizeSerials(progress.serials); // finishSerials does the same for the final result
+        return true;
+    }
 
+    void printPending(const std::string& label, int labelWidth = 25) {
+        ConsoleUtils::setColor(ConsoleUtils::GRAY);
+        ConsoleUtils::out() << std::left << std::setw(labelWidth) << label << ": collecting...\n";
+        ConsoleUtils::resetColor();
+    }
 
+    void drawSummary(const SummaryProgress& p, const SystemSerials& savedSerials, bool hasSaved) {
         // ----- PART 1: OS / User / Memory / Uptime (WMI) -----
-        auto info = checker.getSystemInfo();
-        ConsoleUtils::printItem("Windows Version", info.windowsVersion);
-        ConsoleUtils::printItem("Computer Name", info.computerName);
-        ConsoleUtils::printItem("Current User", info.userName);
-        ConsoleUtils::printItem("Architecture", info.architecture);
-        ConsoleUtils::printItem("Total Memory", info.totalMemory);
-        ConsoleUtils::printItem("System Uptime", info.uptime);
+        if (p.infoReady) {
+            ConsoleUtils::printItem("Windows Version", p.info.windowsVersion);
+            ConsoleUtils::printItem("Computer Name", p.info.computerName);
+            ConsoleUtils::printItem("Current User", p.info.userName);
+            ConsoleUtils::printItem("Architecture", p.info.architecture);
+            ConsoleUtils::printItem("Total Memory", p.info.totalMemory);
+            ConsoleUtils::printItem("System Uptime", p.info.uptime);
+        }
+        else {
+            printPending("System Information");
+        }
 
         // ----- PART 2: Hardware Serials (WinAPI only) -----
-        auto serials = checker.getSystemSerials();
-        SystemSerials savedSerials;
-        bool hasSaved = loadSerials(savedSerials, serialsFile);
-        std::map<std::string, bool> changes;
-        if (hasSaved)
-            changes = compareSerials(serials, savedSerials);
+        // Per-item records; without a baseline every row is just listed
+        SerialDiff diff = diffSerials(p.serials, hasSaved ? savedSerials : p.serials);
 
         ConsoleUtils::printSubHeader("Hardware Serials");
-        std::cout << "\033[1;31m Please note that it may take up to a minute to display recently changed serials!\033[0m\n";
-        std::cout << "  Status: ";
-        ConsoleUtils::setColor(ConsoleUtils::GREEN); std::cout << "CHANGED"; ConsoleUtils::resetColor(); std::cout << " = Modified | ";
-        ConsoleUtils::setColor(ConsoleUtils::RED); std::cout << "UNCHANGED"; ConsoleUtils::resetColor(); std::cout << " = Same | ";
-        ConsoleUtils::setColor(ConsoleUtils::YELLOW); std::cout << "NO BASELINE"; ConsoleUtils::resetColor(); std::cout << " = First run\n\n";
+        ConsoleUtils::printColored(" Please note that it may take up to a minute to display recently changed serials!\n", ConsoleUtils::RED);
+        ConsoleUtils::out() << "  Status: ";
+        ConsoleUtils::setColor(ConsoleUtils::GREEN); ConsoleUtils::out() << "CHANGED/ADDED/REMOVED"; ConsoleUtils::resetColor(); ConsoleUtils::out() << " = Modified | ";
+        ConsoleUtils::setColor(ConsoleUtils::RED); ConsoleUtils::out() << "UNCHANGED"; ConsoleUtils::resetColor(); ConsoleUtils::out() << " = Same | ";
+        ConsoleUtils::setColor(ConsoleUtils::YELLOW); ConsoleUtils::out() << "NO BASELINE"; ConsoleUtils::resetColor(); ConsoleUtils::out() << " = First run | ";
+        ConsoleUtils::setColor(ConsoleUtils::YELLOW); ConsoleUtils::out() << "STALE"; ConsoleUtils::resetColor(); ConsoleUtils::out() << " = Timed out\n\n";
 
         int maxSerialLength = 0;
-        maxSerialLength = (std::max)(maxSerialLength, (int)serials.cpuId.length());
-        maxSerialLength = (std::max)(maxSerialLength, (int)serials.motherboardSerial.length());
-        maxSerialLength = (std::max)(maxSerialLength, (int)serials.biosSerial.length());
-        for (const auto& disk : serials.diskSerials)
+        maxSerialLength = (std::max)(maxSerialLength, (int)p.serials.cpuId.length());
+        maxSerialLength = (std::max)(maxSerialLength, (int)p.serials.motherboardSerial.length());
+        maxSerialLength = (std::max)(maxSerialLength, (int)p.serials.biosSerial.length());
+        for (const auto& disk : p.serials.diskSerials)
             maxSerialLength = (std::max)(maxSerialLength, (int)disk.length());
-        for (const auto& adapter : serials.networkAdapters)
+        for (const auto& adapter : p.serials.networkAdapters)
             maxSerialLength = (std::max)(maxSerialLength, (int)adapter.second.length());
         int valueWidth = (std::min)(40, (std::max)(30, maxSerialLength + 2));
         int labelWidth = 25;
 
-        printSerialWithStatus("CPU ID", serials.cpuId, hasSaved && changes["CPU ID"], hasSaved, labelWidth, valueWidth);
-        printSerialWithStatus("Motherboard Serial", serials.motherboardSerial, hasSaved && changes["Motherboard Serial"], hasSaved, labelWidth, valueWidth);
-        printSerialWithStatus("BIOS Serial", serials.biosSerial, hasSaved && changes["BIOS Serial"], hasSaved, labelWidth, valueWidth);
+        // Rows come out in component order; a pending component gets one placeholder
+        struct { SerialComponent component; bool ready; const char* label; } parts[] = {
+            { SerialComponent::CpuId, p.cpuReady, "CPU ID" },
+            { SerialComponent::MotherboardSerial, p.boardReady, "Motherboard Serial" },
+            { SerialComponent::BiosSerial, p.biosReady, "BIOS Serial" },
+            { SerialComponent::Disk, p.disksReady, "Disk Serials" },
+            { SerialComponent::NetworkAdapter, p.adaptersReady, "Network Adapters" },
+        };
+        for (const auto& part : parts) {
+            if (!part.ready) {
+                ConsoleUtils::out() << "  ";
+                printPending(part.label, labelWidth);
+                continue;
+            }
+            for (const auto& change : diff.changes) {
+                if (change.component == part.component)
+                    printSerialChange(change, hasSaved, labelWidth, valueWidth);
+            }
+        }
 
-        bool diskChanged = hasSaved && changes["Disk Serials"];
-        int diskIndex = 0;
-        for (const auto& disk : serials.diskSerials) {
-            std::stringstream label;
-            label << "Disk " << diskIndex++;
-            printSerialWithStatus(label.str(), disk, diskChanged, hasSaved, labelWidth, valueWidth);
+        // Informational only; modules aren't part of the saved baseline
+        if (p.boardReady && !p.memoryModules.empty()) {
+            ConsoleUtils::printSubHeader("Memory Modules");
+            for (const auto& module : p.memoryModules) {
+                std::stringstream line;
+                line << (module.serial.empty() ? "Not Available" : module.serial);
+                if (!module.partNumber.empty()) line << "  " << module.partNumber;
+                if (module.sizeMb) line << "  " << module.sizeMb << " MB";
+                ConsoleUtils::printItem(module.locator.empty() ? "Module" : module.locator, line.str());
+            }
         }
-        bool netChanged = hasSaved && changes["Network Adapters"];
-        for (const auto& adapter : serials.networkAdapters)
-            printSerialWithStatus(adapter.first, adapter.second, netChanged, hasSaved, labelWidth, valueWidth);
 
         // ----- PART 3: Security (WMI) -----
-        auto status = checker.getSecurityStatus();
+        const SecurityStatus& status = p.status;
         ConsoleUtils::printSubHeader("Security Status");
-        ConsoleUtils::printItem("Defender Service", status.defenderServiceStatus,
-            ConsoleUtils::DARK_WHITE,
-            status.defenderServiceStatus == "Running" ? ConsoleUtils::GREEN : ConsoleUtils::RED);
-        ConsoleUtils::printItem("Real-time Protection",
-            status.realtimeProtectionEnabled ? "Enabled" : "Disabled",
-            ConsoleUtils::DARK_WHITE,
-            status.realtimeProtectionEnabled ? ConsoleUtils::GREEN : ConsoleUtils::RED);
-        ConsoleUtils::printItem("DEP", status.depEnabled ? "Enabled" : "Disabled",
-            ConsoleUtils::DARK_WHITE,
-            status.depEnabled ? ConsoleUtils::GREEN : ConsoleUtils::YELLOW);
-        ConsoleUtils::printItem("ASLR", status.aslrStatus);
-        ConsoleUtils::printItem("Control Flow Guard",
-            status.controlFlowGuardEnabled ? "Enabled" : "Disabled",
-            ConsoleUtils::DARK_WHITE,
-            status.controlFlowGuardEnabled ? ConsoleUtils::GREEN : ConsoleUtils::YELLOW);
-        if (!status.antivirusProducts.empty()) {
+        if (p.defenderReady) {
+            ConsoleUtils::printItem("Defender Service", status.defenderServiceStatus,
+                ConsoleUtils::DARK_WHITE,
+                status.defenderServiceStatus == "Running" ? ConsoleUtils::GREEN : ConsoleUtils::RED);
+        }
+        else {
+            printPending("Defender Service");
+        }
+        if (p.mitigationsReady) {
+            ConsoleUtils::printItem("Real-time Protection",
+                status.realtimeProtectionEnabled ? "Enabled" : "Disabled",
+                ConsoleUtils::DARK_WHITE,
+                status.realtimeProtectionEnabled ? ConsoleUtils::GREEN : ConsoleUtils::RED);
+            ConsoleUtils::printItem("DEP", status.depEnabled ? "Enabled" : "Disabled",
+                ConsoleUtils::DARK_WHITE,
+                status.depEnabled ? ConsoleUtils::GREEN : ConsoleUtils::YELLOW);
+            ConsoleUtils::printItem("ASLR", status.aslrStatus);
+            ConsoleUtils::printItem("Control Flow Guard",
+                status.controlFlowGuardEnabled ? "Enabled" : "Disabled",
+                ConsoleUtils::DARK_WHITE,
+                status.controlFlowGuardEnabled ? ConsoleUtils::GREEN : ConsoleUtils::YELLOW);
+        }
+        else {
+            printPending("Exploit Mitigations");
+        }
+        if (!p.avReady) {
+            printPending("Antivirus Products");
+        }
+        else if (!status.antivirusProducts.empty()) {
             ConsoleUtils::printSubHeader("Antivirus Products");
             for (const auto& av : status.antivirusProducts)
                 ConsoleUtils::printItem("Antivirus", av, ConsoleUtils::DARK_WHITE, ConsoleUtils::GREEN);
         }
     }
 
+    void showSystemSummary() {
+        ConsoleUtils::clearScreen();
+        ConsoleUtils::printHeader("SYSTEM SUMMARY", ConsoleUtils::CYAN);
+
+        // The baseline is local, so the layout with placeholders goes up
+        // before any collector has returned
+        SystemSerials savedSerials;
+        bool hasSaved = loadSerials(savedSerials, serialsFile);
+        SummaryProgress progress;
+        drawSummary(progress, savedSerials, hasSaved);
+        ConsoleUtils::present();
+
+        // Every source runs in parallel; each one redraws the summary as it
+        // lands instead of everything waiting on the slowest query
+        SystemInfo info;
+        SystemSerials serials;
+        SecurityStatus status;
+        std::vector<CollectorTiming> timings;
+        checker.collectAll(info, serials, status, &timings, [&](const CollectorTiming& done) {
+            if (!applyCollected(done.name, info, serials, status, progress)) return;
+            if (done.name == "SMBIOS") progress.memoryModules = checker.smbiosInfo().memoryModules;
+            if (done.skipped || done.timedOut) progress.serials.incomplete |= unitComponent(done.name);
+            // Recompose the whole frame; only rows that changed reach the console
+            ConsoleUtils::clearScreen();
+            ConsoleUtils::printHeader("SYSTEM SUMMARY", ConsoleUtils::CYAN);
+            drawSummary(progress, savedSerials, hasSaved);
+            ConsoleUtils::present();
+        });
+
+        // The checker's view of what missed the deadline is the final word
+        if (progress.serials.incomplete != serials.incomplete) {
+            progress.serials.incomplete = serials.incomplete;
+            ConsoleUtils::clearScreen();
+            ConsoleUtils::printHeader("SYSTEM SUMMARY", ConsoleUtils::CYAN);
+            drawSummary(progress, savedSerials, hasSaved);
+        }
+        // WMI is connected on the first summary; only the AV Products row needs it
+        if (!checker.isWMIInitialized()) {
+            ConsoleUtils::printError("Failed to initialize WMI. Some features may not work.");
+            ConsoleUtils::printWarning("Try running as Administrator for full functionality.");
+        }
+
+        // ----- PART 4: How long each source took -----
+        ConsoleUtils::printSubHeader("Collector Timings");
+        for (const auto& t : timings) {
+            std::stringstream ms;
+            ms << std::fixed << std::setprecision(1) << t.milliseconds << " ms";
+            if (t.skipped) ms << " (skipped)";
+            else if (t.timedOut) ms << " (timed out)";
+            else if (!t.succeeded) ms << " (failed)";
+            ConsoleUtils::printItem(t.name, ms.str(), ConsoleUtils::DARK_WHITE,
+                t.succeeded ? ConsoleUtils::WHITE : ConsoleUtils::RED);
+        }
+        writeTrace();
+    }
+
     void saveCurrentSerials() {
         ConsoleUtils::clearScreen();
         ConsoleUtils::printHeader("SAVE SERIALS", ConsoleUtils::YELLOW);
+        ConsoleUtils::present();
         auto serials = checker.getSystemSerials();
         // Instantly save to default file, no prompt
         std::string filename = serialsFile;
-        if (saveSerials(serials, filename)) {
+        if (serials.incomplete) {
+            // A partial read would become the baseline every later run compares against
+            ConsoleUtils::printError("Some serials timed out, baseline not saved. Try again.");
+        }
+        else if (saveSerials(serials, filename)) {
+            recordHistory(serials);
             ConsoleUtils::printSuccess("Serials saved successfully to " + filename);
         }
         else {
             ConsoleUtils::printError("Failed to save serials to " + filename);
         }
+        ConsoleUtils::present();
         // Wait for 3 seconds
         Sleep(1000);
     }
 
+    // One notification's worth of changes in watch mode
+    struct WatchEvent {
+        std::string timestamp;
+        std::vector<SerialChange> changes;
+    };
+
+    void drawWatch(const std::string& baselineTime, const std::deque<WatchEvent>& events) {
+        ConsoleUtils::clearScreen();
+        ConsoleUtils::printHeader("WATCH SERIALS", ConsoleUtils::CYAN);
+        ConsoleUtils::printInfo("Waiting for hardware change notifications. Press any key to stop.");
+        ConsoleUtils::out() << "\n";
+        if (!baselineTime.empty())
+            ConsoleUtils::printSuccess("Baseline collected at " + baselineTime);
+        for (const auto& event : events) {
+            ConsoleUtils::setColor(ConsoleUtils::YELLOW);
+            ConsoleUtils::out() << "[" << event.timestamp << "]\n";
+            ConsoleUtils::resetColor();
+            for (const auto& change : event.changes)
+                printSerialChange(change, true, 25, 30);
+        }
+        ConsoleUtils::present();
+    }
+
+    void watchSerials() {
+        // Only the components a notification names are queried again
+        WinChangeSource source;
+        SerialWatcher watcher(source, [this](unsigned components, SystemSerials& serials) {
+            checker.refreshSerials(components, serials);
+        });
+
+        // The screen is redrawn from this log on every event, so keep it to
+        // what fits; the frame diff only sends the lines that moved
+        const size_t maxEventLines = 24;
+        std::deque<WatchEvent> events;
+        size_t eventLines = 0;
+        SystemSerials previous;
+        std::string baselineTime;
+        bool first = true;
+        drawWatch(baselineTime, events);
+
+        auto onChange = [&](unsigned, const SystemSerials& serials) {
+            WatchEvent event;
+            event.timestamp = serials.timestamp;
+            for (auto& change : diffSerials(serials, previous).changes) {
+                if (change.kind != ChangeKind::Unchanged) event.changes.push_back(change);
+            }
+            eventLines += 1 + event.changes.size();
+            events.push_back(std::move(event));
+            while (eventLines > maxEventLines && events.size() > 1) {
+                eventLines -= 1 + events.front().changes.size();
+                events.pop_front();
+            }
+            previous = serials;
+            recordHistory(serials); // skipped while a component is still timing out
+            drawWatch(baselineTime, events);
+        };
+        auto keepRunning = [&]() {
+            if (first) {
+                // The initial collection has finished by the first check
+                previous = watcher.current();
+                baselineTime = previous.timestamp;
+                first = false;
+                recordHistory(previous);
+                drawWatch(baselineTime, events);
+            }
+            return !_kbhit();
+        };
+
+        if (!watcher.run(onChange, keepRunning))
+            ConsoleUtils::printError("Failed to register for change notifications.");
+        clearInputBuffer();
+    }
+
     void waitForKey() {
         ConsoleUtils::setColor(ConsoleUtils::DARK_WHITE);
-        std::cout << "\nPress any key to continue...";
+        ConsoleUtils::out() << "\nPress any key to continue...";
         ConsoleUtils::resetColor();
+        ConsoleUtils::present();
         clearInputBuffer();
         _getch();
         clearInputBuffer();
@@ -210,24 +454,26 @@ private:
 public:
     void run() {
         ConsoleUtils::initialize();
-        if (!checker.isWMIInitialized()) {
-            ConsoleUtils::printError("Failed to initialize WMI. Some features may not work.");
-            ConsoleUtils::printWarning("Try running as Administrator for full functionality.");
-            std::cout << "\n";
+        // BANSNIFFER_TRACE=<file> records every query and IOCTL for diagnosing slow hosts
+        char trace[MAX_PATH];
+        DWORD traceLength = GetEnvironmentVariableA("BANSNIFFER_TRACE", trace, sizeof(trace));
+        if (traceLength > 0 && traceLength < sizeof(trace)) {
+            tracePath.assign(trace, traceLength);
+            Trace::enable();
         }
-
         char choice;
         bool running = true;
         while (running) {
             clearInputBuffer();
             displayMainMenu();
             choice = _getch();
-            std::cout << choice << "\n\n";
+            ConsoleUtils::out() << choice << "\n\n";
             switch (choice) {
             case '1': showSystemSummary(); waitForKey(); break;
             case '2': clearInputBuffer(); saveCurrentSerials(); waitForKey(); break;
-            case '0': running = false; ConsoleUtils::printInfo("Exiting..."); break;
-            default: ConsoleUtils::printError("Invalid option. Please try again."); Sleep(1000); break;
+            case '3': clearInputBuffer(); watchSerials(); waitForKey(); break;
+            case '0': running = false; ConsoleUtils::printInfo("Exiting..."); ConsoleUtils::present(); break;
+            default: ConsoleUtils::printError("Invalid option. Please try again."); ConsoleUtils::present(); Sleep(1000); break;
             }
         }
     }
@@ -249,7 +495,22 @@ void resizeConsole(short width, short height) {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Verbs on the command line mean a scheduled run: no console setup,
+    // no menu, just NDJSON on stdout and an exit code
+    if (isBatchInvocation(argc, argv)) {
+        try {
+            // Serials only: the native collector, no COM or WMI connection
+            return runBatch(argc, argv, [](unsigned timeoutMs) {
+                return getSystemSerials(Deadline::after(timeoutMs));
+            });
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Fatal error: " << e.what() << std::endl;
+            return BatchError;
+        }
+    }
+
     resizeConsole(85, 40);
     ConsoleUtils::initialize();
     try {
@@ -1,3 +1,5 @@
+#ifdef _WIN32
+
 #ifndef _WIN32_WINNT
 #define _WIN32_WINNT 0x0600
 #endif
@@ -10,126 +12,88 @@
 #include <ws2def.h>
 #include <ws2ipdef.h> 
 #include "system_serials.hpp"
+#include "SerialFormat.h"
+#include "SerialNormalize.h"
+#include "Trace.h"
+#include "WinDiskEnumerator.h"
+#include "WinAdapterEnumerator.h"
+#include "WinSmbiosReader.h"
 #include <intrin.h>
-#include <winioctl.h>
 #include <vector>
-#include <map>
 #include <string>
-#include <sstream>
-#include <iomanip>
-#include <algorithm>
+#include <ctime>
 #pragma comment(lib, "iphlpapi.lib")
 #pragma comment(lib, "ws2_32.lib")
 
-// cpu id
-static std::string getCPUID() {
-    int cpuInfo[4] = { 0 };
-    __cpuid(cpuInfo, 0);
-    std::ostringstream oss;
-    oss << std::hex << cpuInfo[0] << cpuInfo[1] << cpuInfo[2] << cpuInfo[3];
-    return oss.str();
+struct SerialCollector::State {
+    WinSmbiosReader smbiosReader;
+    SmbiosInfo smbios;
+    WinDiskEnumerator diskEnumerator;
+    std::vector<DiskInfo> disks;
+    WinAdapterEnumerator adapterEnumerator;
+    std::vector<AdapterInfo> adapters;
+};
+
+SerialCollector::SerialCollector() : state(new State()) {
 }
 
-// Helper: Get BIOS serial from registry
-static std::string getBiosSerial() {
-    HKEY hKey;
-    char value[128] = { 0 };
-    DWORD value_length = sizeof(value);
-    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\BIOS", 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        if (RegQueryValueExA(hKey, "SystemSerialNumber", nullptr, nullptr, (LPBYTE)value, &value_length) == ERROR_SUCCESS) {
-            RegCloseKey(hKey);
-            if (strlen(value) > 0)
-                return std::string(value);
-        }
-        RegCloseKey(hKey);
-    }
-    return "Not Available";
+SerialCollector::~SerialCollector() {
 }
 
-// Helper: Get Motherboard serial via SMBIOS (try registry, fallback to BIOS)
-static std::string getMotherboardSerial() {
-    HKEY hKey;
-    char value[128] = { 0 };
-    DWORD value_length = sizeof(value);
-    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\BIOS", 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        if (RegQueryValueExA(hKey, "BaseBoardSerialNumber", nullptr, nullptr, (LPBYTE)value, &value_length) == ERROR_SUCCESS) {
-            RegCloseKey(hKey);
-            if (strlen(value) > 0)
-                return std::string(value);
-        }
-        RegCloseKey(hKey);
-    }
-    // fallback to bios serial if nothing
-    return getBiosSerial();
+const SmbiosInfo& SerialCollector::smbiosInfo() const {
+    return state->smbios;
+}
+
+// cpu id, same layout as WMI Win32_Processor.ProcessorId (leaf 1 EDX:EAX)
+static void getCPUID(std::string& out) {
+    int cpuInfo[4] = { 0 };
+    __cpuid(cpuInfo, 1);
+    formatProcessorId((uint32_t)cpuInfo[3], (uint32_t)cpuInfo[0], out);
 }
 
-// Helper: Get disk serials using DeviceIoControl
-static std::vector<std::string> getDiskSerials() {
-    std::vector<std::string> out;
-    char driveName[32];
-    for (int i = 0; i < 16; ++i) {
-        sprintf_s(driveName, "\\\\.\\PhysicalDrive%d", i);
-        HANDLE hDevice = CreateFileA(driveName, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-        if (hDevice == INVALID_HANDLE_VALUE)
-            continue;
-        STORAGE_PROPERTY_QUERY query = {};
-        query.PropertyId = StorageDeviceProperty;
-        query.QueryType = PropertyStandardQuery;
-        BYTE buffer[1024] = {};
-        DWORD bytesReturned = 0;
-        if (DeviceIoControl(hDevice, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), buffer, sizeof(buffer), &bytesReturned, nullptr)) {
-            auto desc = reinterpret_cast<STORAGE_DEVICE_DESCRIPTOR*>(buffer);
-            if (desc->SerialNumberOffset && desc->SerialNumberOffset < bytesReturned) {
-                const char* serial = (const char*)buffer + desc->SerialNumberOffset;
-                out.push_back(std::string(serial));
-            }
-            else {
-                out.push_back("Not Available");
-            }
+// CPUID and the firmware table are quick and local, only the disk queries
+// can stall, and those all run at once. Stages the deadline caught keep
+// what they had and are flagged.
+void SerialCollector::collect(unsigned components, SystemSerials& serials, const Deadline& deadline) {
+    unsigned missed = 0;
+    if (components & WatchCpu) getCPUID(serials.cpuId);
+    if (components & (WatchMotherboard | WatchBios)) {
+        // One table read for both
+        state->smbiosReader.read(state->smbios);
+        assignFirmwareSerials(state->smbios, components, serials.motherboardSerial, serials.biosSerial);
+    }
+
+    if (components & WatchDisks) {
+        // Every disk device interface, queried concurrently
+        bool diskTimedOut = false;
+        state->diskEnumerator.enumerate(state->disks, deadline, diskTimedOut);
+        assignDiskSerials(state->disks, serials.diskSerials);
+        if (diskTimedOut) missed |= WatchDisks;
+    }
+    if (components & WatchAdapters) {
+        if (deadline.expired()) {
+            missed |= WatchAdapters;
         }
         else {
-            out.push_back("Not Available");
+            // Named by description, as GetAdaptersInfo reported them
+            state->adapterEnumerator.enumerate(state->adapters);
+            assignAdapters(state->adapters, serials.networkAdapters, true);
         }
-        CloseHandle(hDevice);
     }
-    // Remove empty or "Not Available" duplicates
-    out.erase(std::remove_if(out.begin(), out.end(), [](const std::string& s) { return s.empty() || s == "Not Available"; }), out.end());
-    return out;
+    serials.incomplete = (serials.incomplete & ~components) | missed;
+    normalizeSerials(serials); // trailing '.' on NVMe serials, lower case MACs
+    formatTimestamp(time(0), serials.timestamp);
 }
 
-// Helper: Get MAC addresses
-static std::map<std::string, std::string> getNetworkAdapters() {
-    std::map<std::string, std::string> result;
-    ULONG buflen = 0;
-    // First call to get buffer length needed
-    if (GetAdaptersAddresses(AF_UNSPEC, 0, 0, nullptr, &buflen) != ERROR_BUFFER_OVERFLOW)
-        return result;
-
-    auto buf = (PIP_ADAPTER_ADDRESSES)malloc(buflen);
-    if (!buf) return result;
-
-    if (GetAdaptersAddresses(AF_UNSPEC, 0, 0, buf, &buflen) == NO_ERROR) {
-        for (auto a = buf; a; a = a->Next) {
-            if (a->PhysicalAddressLength == 6) {
-                std::ostringstream oss;
-                for (ULONG i = 0; i < 6; ++i)
-                    oss << std::setfill('0') << std::setw(2) << std::hex << (int)a->PhysicalAddress[i] << (i < 5 ? "-" : "");
+SystemSerials getSystemSerials() {
+    return getSystemSerials(Deadline());
+}
 
-                std::string name = "Unknown";
-                if (a->FriendlyName) {
-                    // WideCharToMultiByte for proper Unicode conversion:
-                    int len = WideCharToMultiByte(CP_UTF8, 0, a->FriendlyName, -1, nullptr, 0, nullptr, nullptr);
-                    if (len > 1) {
-                        std::vector<char> utf8(len);
-                        WideCharToMultiByte(CP_UTF8, 0, a->FriendlyName, -1, utf8.data(), len, nullptr, nullptr);
-                        name = std::string(utf8.data());
-                    }
-                }
-                result[name] = oss.str();
-            }
-        }
-    }
-    free(buf);
-    return result;
+SystemSerials getSystemSerials(const Deadline& deadline) {
+    SerialCollector collector;
+    SystemSerials serials;
+    collector.collect(WatchAll, serials, deadline);
+    return serials;
 }
 
+#endif // _WIN32
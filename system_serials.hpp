@@ -2,6 +2,21 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include "Deadline.h"
+
+struct SmbiosInfo;
+
+// Serial components as bits, used wherever a subset is named: watch-mode
+// notifications, partial refreshes, components that missed a deadline
+enum WatchComponent : unsigned {
+    WatchCpu = 1,
+    WatchMotherboard = 2,
+    WatchBios = 4,
+    WatchDisks = 8,
+    WatchAdapters = 16,
+    WatchAll = 31
+};
 
 struct SystemSerials {
     std::string cpuId;
@@ -10,6 +25,43 @@ struct SystemSerials {
     std::vector<std::string> diskSerials;
     std::vector<std::pair<std::string, std::string>> networkAdapters; // name, MAC
     std::string timestamp;
+
+    // WatchComponent bits that hit the refresh deadline. Their fields hold
+    // whatever was collected in time and must be treated as stale.
+    unsigned incomplete = 0;
+};
+
+// Native collection, implemented per platform: system_serials.cpp (WinAPI)
+// and system_serials_linux.cpp (CPUID + SMBIOS + sysfs + netlink). The
+// collector keeps its readers, their buffers and its scratch space between
+// refreshes and overwrites the strings already in serials, so once one
+// refresh has sized everything, refreshing the same hardware makes no heap
+// allocations (AllocationCounter checks this). Not thread-safe; keep one
+// per watching thread. The one exception: calls for disjoint parts (CPU,
+// board and BIOS, disks, adapters) into different SystemSerials may
+// overlap, since each part has its own reader and scratch space.
+class SerialCollector {
+public:
+    SerialCollector();
+    ~SerialCollector();
+
+    SerialCollector(const SerialCollector&) = delete;
+    SerialCollector& operator=(const SerialCollector&) = delete;
+
+    // Refills the WatchComponent bits in components and leaves the other
+    // fields alone, as SerialWatcher's Collector expects. Bits that missed
+    // the deadline are set in serials.incomplete, the rest cleared.
+    void collect(unsigned components, SystemSerials& serials, const Deadline& deadline = Deadline());
+
+    // Everything the last board/BIOS refresh decoded from the firmware table
+    // (BIOS, system, chassis, memory modules); empty before the first one
+    const SmbiosInfo& smbiosInfo() const;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
 };
 
-SystemSerials getSystemSerials();
\ No newline at end of file
+// One-shot collection through a temporary SerialCollector
+SystemSerials getSystemSerials();
+SystemSerials getSystemSerials(const Deadline& deadline);
@@ -0,0 +1,199 @@
+// Linux backend for getSystemSerials(). Fills the same SystemSerials as the
+// WinAPI path from CPUID, SMBIOS, sysfs and netlink, so the save/compare pipeline can
+// run on Linux hosts too. Every sysfs attribute is a single open/read/close
+// into a stack buffer, directories are walked relative to an open dirfd
+// with getdents64 into the collector's own buffer (opendir would malloc
+// one per refresh).
+#ifdef __linux__
+
+#include "system_serials.hpp"
+#include "SerialFormat.h"
+#include "SerialNormalize.h"
+#include "Trace.h"
+#include "NetlinkAdapterEnumerator.h"
+#include "SysfsSmbiosReader.h"
+#include "FixedString.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Read a small sysfs attribute relative to dirFd, trimmed of whitespace.
+// Returns false if the file is missing, unreadable (some attributes are
+// root-only) or empty.
+static bool readAttribute(int dirFd, const char* path, std::string& out) {
+    int fd = openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    char buffer[256];
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    close(fd);
+    if (n <= 0) return false;
+
+    size_t begin = 0, end = (size_t)n;
+    while (begin < end && (unsigned char)buffer[begin] <= ' ') begin++;
+    while (end > begin && (unsigned char)buffer[end - 1] <= ' ') end--;
+    if (begin == end) return false;
+    out.assign(buffer + begin, end - begin);
+    return true;
+}
+
+// SCSI VPD page 0x80 is binary: 4-byte header, then the serial
+static bool readVpdSerial(int dirFd, const char* path, std::string& out) {
+    int fd = openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    unsigned char buffer[256];
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    close(fd);
+    if (n <= 4) return false;
+
+    size_t len = (std::min)((size_t)buffer[3], (size_t)n - 4);
+    size_t begin = 4, end = 4 + len;
+    while (begin < end && buffer[begin] <= ' ') begin++;
+    while (end > begin && buffer[end - 1] <= ' ') end--;
+    if (begin == end) return false;
+    out.assign((const char*)buffer + begin, end - begin);
+    return true;
+}
+
+// d_name is at most NAME_MAX; room for the longest suffix below
+static const size_t DiskPathCapacity = 288;
+static const size_t DirentBufferSize = 16 * 1024;
+
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+struct SerialCollector::State {
+    SysfsSmbiosReader smbiosReader;
+    SmbiosInfo smbios;
+    NetlinkAdapterEnumerator adapterEnumerator;
+    std::vector<AdapterInfo> adapters;
+    std::vector<char> dirents; // getdents64 buffer, sized once
+    FixedString<DiskPathCapacity> path;
+};
+
+SerialCollector::SerialCollector() : state(new State()) {
+    state->dirents.resize(DirentBufferSize);
+}
+
+SerialCollector::~SerialCollector() {
+}
+
+const SmbiosInfo& SerialCollector::smbiosInfo() const {
+    return state->smbios;
+}
+
+// cpu id, same layout as WMI Win32_Processor.ProcessorId (leaf 1 EDX:EAX)
+static void getCPUID(std::string& out) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        formatProcessorId(edx, eax, out);
+        return;
+    }
+#endif
+    out.assign("Not Available");
+}
+
+// Disk serials from /sys/block/* (NVMe exposes device/serial, virtio-blk
+// serial, SCSI/SATA device/vpd_pg80), written over the strings already in out
+static void getDiskSerials(std::vector<char>& dirents, FixedString<DiskPathCapacity>& path,
+    std::vector<std::string>& out, const Deadline& deadline, bool& timedOut) {
+
+    TraceSpan span("Sysfs Disks");
+    size_t count = 0;
+    int dirFd = open("/sys/block", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        out.clear();
+        return;
+    }
+
+    static const char* const textAttributes[] = { "/device/serial", "/serial" };
+    for (;;) {
+        long got = syscall(SYS_getdents64, dirFd, dirents.data(), dirents.size());
+        if (got <= 0) break;
+        for (long offset = 0; offset < got && !timedOut;) {
+            const LinuxDirent64* entry = (const LinuxDirent64*)(dirents.data() + offset);
+            offset += entry->d_reclen;
+            if (entry->d_name[0] == '.') continue;
+            if (deadline.expired()) {
+                timedOut = true; // a vpd_pg80 read can block on a hung SCSI target
+                break;
+            }
+            if (count == out.size()) out.emplace_back();
+            bool found = false;
+            for (const char* attribute : textAttributes) {
+                path.assign(entry->d_name).append(attribute);
+                if (!path.truncated() && readAttribute(dirFd, path.c_str(), out[count])) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                path.assign(entry->d_name).append("/device/vpd_pg80");
+                found = !path.truncated() && readVpdSerial(dirFd, path.c_str(), out[count]);
+            }
+            if (found) count++;
+        }
+        if (timedOut) break;
+    }
+    close(dirFd);
+
+    // Directory order isn't stable across boots; swaps keep every string's buffer
+    std::sort(out.begin(), out.begin() + count);
+    out.resize(count);
+}
+
+void SerialCollector::collect(unsigned components, SystemSerials& serials, const Deadline& deadline) {
+    unsigned missed = 0;
+    if (components & WatchCpu) getCPUID(serials.cpuId);
+    if (components & (WatchMotherboard | WatchBios)) {
+        // One table read for both
+        state->smbiosReader.read(state->smbios);
+        assignFirmwareSerials(state->smbios, components, serials.motherboardSerial, serials.biosSerial);
+    }
+
+    if (components & WatchDisks) {
+        bool diskTimedOut = false;
+        getDiskSerials(state->dirents, state->path, serials.diskSerials, deadline, diskTimedOut);
+        if (diskTimedOut) missed |= WatchDisks;
+    }
+    if (components & WatchAdapters) {
+        if (deadline.expired()) {
+            missed |= WatchAdapters;
+        }
+        else {
+            state->adapterEnumerator.enumerate(state->adapters);
+            assignAdapters(state->adapters, serials.networkAdapters);
+        }
+    }
+    serials.incomplete = (serials.incomplete & ~components) | missed;
+    normalizeSerials(serials);
+    formatTimestamp(time(0), serials.timestamp);
+}
+
+SystemSerials getSystemSerials() {
+    return getSystemSerials(Deadline());
+}
+
+SystemSerials getSystemSerials(const Deadline& deadline) {
+    SerialCollector collector;
+    SystemSerials serials;
+    collector.collect(WatchAll, serials, deadline);
+    return serials;
+}
+
+#endif // __linux__